@@ -0,0 +1,112 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// NOLINTBEGIN
+#include "bench_tcp_fixture.hpp"
+
+#include <benchmark/benchmark.h>
+
+/** @brief A service that records every accepted connection. */
+struct bench_fanout_service : public async_tcp_service<bench_fanout_service> {
+  using Base = async_tcp_service<bench_fanout_service>;
+
+  template <typename T>
+  explicit bench_fanout_service(socket_address<T> address) : Base(address)
+  {}
+
+  std::vector<socket_dialog> connections;
+
+  auto service(async_context &ctx, const socket_dialog &socket,
+               std::shared_ptr<read_context> rctx,
+               std::span<const std::byte> buf) -> void
+  {
+    if (!rctx)
+      return;
+
+    connections.push_back(socket);
+    submit_recv(ctx, socket, std::move(rctx));
+  }
+};
+
+/**
+ * @brief Fans one message out to every subscriber, either through one
+ * shared buffer or through a copy of the message per subscriber.
+ */
+template <bool Shared> static void BM_Fanout(benchmark::State &state)
+{
+  using namespace io::socket;
+
+  const auto subscribers = static_cast<std::size_t>(state.range(0));
+  const auto size = static_cast<std::size_t>(state.range(1));
+
+  auto ctx = async_context();
+  auto addr = bench_loopback_address();
+  auto service = bench_fanout_service(addr);
+  if (service.start(ctx))
+    return state.SkipWithError("service failed to start");
+
+  auto clients = std::vector<socket_handle>();
+  for (auto i = 0UL; i < subscribers; ++i)
+  {
+    if (io::connect(clients.emplace_back(AF_INET, SOCK_STREAM, 0), addr))
+      return state.SkipWithError("connect failed");
+  }
+  while (service.connections.size() < subscribers)
+    ctx.poller.wait_for(100);
+
+  auto payload = std::vector<std::byte>(size);
+  auto buf = std::vector<char>(size);
+  for (auto _ : state)
+  {
+    if constexpr (Shared)
+    {
+      service.broadcast(ctx, service.connections, shared_buffer(payload));
+    }
+    else
+    {
+      for (const auto &socket : service.connections)
+        service.broadcast(ctx, std::span(&socket, 1), shared_buffer(payload));
+    }
+    while (ctx.poller.wait_for(0));
+
+    for (auto &sock : clients)
+    {
+      for (auto received = 0UL; received < size;)
+      {
+        auto msg = socket_message<sockaddr_in>{
+            .buffers = std::span(buf).subspan(received)};
+        auto len = io::recvmsg(sock, msg, 0);
+        if (len <= 0)
+          return state.SkipWithError("recv failed");
+        received += len;
+      }
+    }
+  }
+
+  state.counters["messages"] =
+      benchmark::Counter(static_cast<double>(state.iterations() * subscribers),
+                         benchmark::Counter::kIsRate);
+
+  service.connections.clear();
+  clients.clear();
+  service.signal_handler(async_context::terminate);
+  while (ctx.poller.wait_for(100));
+}
+BENCHMARK_TEMPLATE(BM_Fanout, false)
+    ->ArgsProduct({{16, 256, 1024}, {64, 1024, 16384}})
+    ->ArgNames({"subscribers", "size"});
+BENCHMARK_TEMPLATE(BM_Fanout, true)
+    ->ArgsProduct({{16, 256, 1024}, {64, 1024, 16384}})
+    ->ArgNames({"subscribers", "size"});
+// NOLINTEND
@@ -0,0 +1,55 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// NOLINTBEGIN
+#include "net/service/pacer.hpp"
+
+#include <benchmark/benchmark.h>
+
+using namespace net::service;
+
+/**
+ * @brief Round-robin 1500 byte sends over many paced flows. Each flow is
+ * refilled at 1MB/s with a one packet burst, so most sends are queued and
+ * released by the context timers, which are resolved every 64 sends. The
+ * iteration count is fixed because the queue grows with the run time.
+ */
+static void BM_PacedSend(benchmark::State &state)
+{
+  constexpr auto PACKET = 1500UL;
+  const auto flows = static_cast<std::uint64_t>(state.range(0));
+
+  auto ctx = async_context();
+  auto pacing = pacer(1'000'000, PACKET);
+  auto released = std::uint64_t{0};
+
+  auto sends = std::uint64_t{0};
+  for (auto _ : state)
+  {
+    pacing.send(ctx, sends % flows, PACKET, [&] { ++released; });
+    if ((++sends & 63U) == 0)
+      ctx.timers.resolve();
+  }
+
+  state.counters["flows"] = static_cast<double>(pacing.flows());
+  state.counters["pending"] = static_cast<double>(pacing.pending());
+  state.counters["released"] = benchmark::Counter(
+      static_cast<double>(released), benchmark::Counter::kIsRate);
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+BENCHMARK(BM_PacedSend)
+    ->RangeMultiplier(10)
+    ->Range(100, 100'000)
+    ->Iterations(1 << 20);
+// NOLINTEND
@@ -0,0 +1,100 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// NOLINTBEGIN
+#include "net/service/session_table.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <arpa/inet.h>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+using namespace net::service;
+using socket_address = io::socket::socket_address<sockaddr_in6>;
+
+/** @brief Per-peer state of a typical session-oriented protocol. */
+struct bench_session {
+  std::uint64_t sequence = 0;
+  std::uint64_t bytes = 0;
+};
+
+/** @brief The baseline: an unordered_map keyed by the raw address. */
+struct bench_map_table {
+  std::unordered_map<std::string, bench_session> sessions;
+
+  auto get(const socket_address &peer) -> bench_session &
+  {
+    const auto *bytes = reinterpret_cast<const char *>(&(*peer));
+    return sessions[std::string(bytes, sizeof(sockaddr_in6))];
+  }
+};
+
+/** @brief The session table, touched at a fixed time. */
+struct bench_open_table {
+  session_table<bench_session> sessions{std::chrono::seconds(30)};
+  net::timers::timestamp now = net::timers::clock::now();
+
+  auto get(const socket_address &peer) -> bench_session &
+  {
+    return sessions.get(peer, now);
+  }
+};
+
+/** @brief Makes count distinct IPv4 peers. */
+static auto bench_peers(std::size_t count) -> std::vector<socket_address>
+{
+  auto peers = std::vector<socket_address>(count);
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    auto *ipv4 = reinterpret_cast<sockaddr_in *>(&(*peers[i]));
+    ipv4->sin_family = AF_INET;
+    ipv4->sin_addr.s_addr = htonl(static_cast<std::uint32_t>(i >> 8U));
+    ipv4->sin_port = htons(static_cast<std::uint16_t>(1024 + (i & 0xFFU)));
+  }
+  return peers;
+}
+
+/** @brief Random-order lookups of existing sessions. */
+template <typename Table> static void BM_Lookup(benchmark::State &state)
+{
+  const auto peers = bench_peers(static_cast<std::size_t>(state.range(0)));
+  auto table = Table();
+  for (const auto &peer : peers)
+    table.get(peer);
+
+  auto order = std::vector<std::size_t>(peers.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), std::mt19937_64(42));
+
+  auto i = 0UL;
+  for (auto _ : state)
+  {
+    auto &session = table.get(peers[order[i]]);
+    benchmark::DoNotOptimize(++session.sequence);
+    i = (i + 1 == order.size()) ? 0 : i + 1;
+  }
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+BENCHMARK_TEMPLATE(BM_Lookup, bench_map_table)
+    ->RangeMultiplier(16)
+    ->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_Lookup, bench_open_table)
+    ->RangeMultiplier(16)
+    ->Range(1 << 10, 1 << 22);
+// NOLINTEND
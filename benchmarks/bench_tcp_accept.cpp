@@ -0,0 +1,95 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// NOLINTBEGIN
+#include "bench_tcp_fixture.hpp"
+
+#include <benchmark/benchmark.h>
+
+/** @brief An echo service that batches accepts and uses provided buffers. */
+struct bench_ring_service : public bench_echo_base<bench_ring_service> {
+  using bench_echo_base::bench_echo_base;
+
+  static constexpr std::size_t accept_batch = 64;
+  static constexpr std::size_t provided_buffers = 256;
+};
+
+/** @brief Short-lived connections: connect, echo once, close. */
+template <typename Service> static void BM_Connections(benchmark::State &state)
+{
+  using namespace io::socket;
+
+  auto addr = bench_loopback_address();
+  auto server = basic_context_thread<Service>();
+  server.start(addr);
+
+  auto buf = std::array<char, 64>{};
+  for (auto _ : state)
+  {
+    auto sock = socket_handle(AF_INET, SOCK_STREAM, 0);
+    if (io::connect(sock, addr) || !bench_echo(sock, buf))
+    {
+      state.SkipWithError("echo failed");
+      break;
+    }
+  }
+
+  state.counters["connections"] = benchmark::Counter(
+      static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+BENCHMARK_TEMPLATE(BM_Connections, bench_echo_service)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Connections, bench_ring_service)->UseRealTime();
+
+/** @brief Long-lived connections: one echo per connection per iteration. */
+template <typename Service> static void BM_Operations(benchmark::State &state)
+{
+  using namespace io::socket;
+
+  auto addr = bench_loopback_address();
+  auto server = basic_context_thread<Service>();
+  server.start(addr);
+
+  auto clients = std::vector<socket_handle>();
+  for (auto i = 0; i < state.range(0); ++i)
+  {
+    if (io::connect(clients.emplace_back(AF_INET, SOCK_STREAM, 0), addr))
+      state.SkipWithError("connect failed");
+  }
+
+  auto buf = std::array<char, 64>{};
+  for (auto _ : state)
+  {
+    for (auto &sock : clients)
+    {
+      if (!bench_echo(sock, buf))
+      {
+        state.SkipWithError("echo failed");
+        break;
+      }
+    }
+  }
+
+  state.counters["ops"] = benchmark::Counter(
+      static_cast<double>(state.iterations() * state.range(0)),
+      benchmark::Counter::kIsRate);
+}
+BENCHMARK_TEMPLATE(BM_Operations, bench_echo_service)
+    ->RangeMultiplier(8)
+    ->Range(1, 512)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Operations, bench_ring_service)
+    ->RangeMultiplier(8)
+    ->Range(1, 512)
+    ->UseRealTime();
+// NOLINTEND
@@ -0,0 +1,245 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// NOLINTBEGIN
+#include "bench_tcp_fixture.hpp"
+#include "net/service/latency_histogram.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <fcntl.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <thread>
+
+/** @brief The number of client threads. */
+static constexpr auto BENCH_CLIENT_THREADS = 4;
+/** @brief How long each configuration is measured for. */
+static constexpr auto BENCH_DURATION = std::chrono::seconds(1);
+
+/** @brief A client connection with a pipeline of in-flight messages. */
+struct bench_echo_connection {
+  io::socket::socket_handle socket;
+  /** @brief The send times of the in-flight messages, oldest first. */
+  std::deque<std::chrono::steady_clock::time_point> in_flight;
+  /** @brief Bytes queued but not yet written. */
+  std::size_t unsent = 0;
+  /** @brief Bytes of the oldest in-flight message already echoed. */
+  std::size_t received = 0;
+  /** @brief Whether the connection is waiting to be writable. */
+  bool blocked = false;
+};
+
+/** @brief Raises the open file limit to fit count connections. */
+static auto bench_reserve_fds(std::size_t count) -> bool
+{
+  auto limit = rlimit{};
+  if (::getrlimit(RLIMIT_NOFILE, &limit))
+    return false;
+
+  // Each connection has a client and a server socket.
+  const auto need = static_cast<rlim_t>(2 * count + 64);
+  if (limit.rlim_cur >= need)
+    return true;
+
+  limit.rlim_cur = std::min(need, limit.rlim_max);
+  return !::setrlimit(RLIMIT_NOFILE, &limit) && limit.rlim_cur >= need;
+}
+
+/**
+ * @brief Drives a share of the connections until done is set, keeping
+ * depth messages of size bytes in flight on each of them.
+ */
+static auto bench_echo_client(std::span<bench_echo_connection> connections,
+                              std::size_t size, std::size_t depth,
+                              const std::atomic<bool> &done,
+                              latency_histogram &latency,
+                              std::atomic<std::uint64_t> &messages) -> void
+{
+  using namespace io::socket;
+  using clock = std::chrono::steady_clock;
+
+  const auto epfd = ::epoll_create1(EPOLL_CLOEXEC);
+  auto payload = std::vector<char>(std::max<std::size_t>(size, 64 * 1024));
+  auto scratch = std::vector<char>(64 * 1024);
+
+  auto watch = [&](bench_echo_connection &conn, int op, bool writable) {
+    auto event = epoll_event{.events = EPOLLIN | (writable ? EPOLLOUT : 0U),
+                             .data = {.ptr = &conn}};
+    ::epoll_ctl(epfd, op, static_cast<native_socket_type>(conn.socket),
+                &event);
+  };
+
+  auto flush = [&](bench_echo_connection &conn) {
+    const auto sockfd = static_cast<native_socket_type>(conn.socket);
+    while (conn.unsent > 0)
+    {
+      auto len = ::send(sockfd, payload.data(),
+                        std::min(conn.unsent, payload.size()), MSG_NOSIGNAL);
+      if (len <= 0)
+        break;
+      conn.unsent -= static_cast<std::size_t>(len);
+    }
+
+    if (conn.blocked != (conn.unsent > 0))
+    {
+      conn.blocked = conn.unsent > 0;
+      watch(conn, EPOLL_CTL_MOD, conn.blocked);
+    }
+  };
+
+  auto complete = std::uint64_t{0};
+  for (auto &conn : connections)
+  {
+    watch(conn, EPOLL_CTL_ADD, false);
+    const auto now = clock::now();
+    conn.in_flight.assign(depth, now);
+    conn.unsent = size * depth;
+    flush(conn);
+  }
+
+  auto events = std::array<epoll_event, 256>{};
+  while (!done.load(std::memory_order_relaxed))
+  {
+    const auto count = ::epoll_wait(epfd, events.data(),
+                                    static_cast<int>(events.size()), 10);
+    for (auto i = 0; i < count; ++i)
+    {
+      auto &conn = *static_cast<bench_echo_connection *>(events[i].data.ptr);
+      if (events[i].events & EPOLLOUT)
+        flush(conn);
+      if (!(events[i].events & EPOLLIN))
+        continue;
+
+      const auto sockfd = static_cast<native_socket_type>(conn.socket);
+      auto len = ::recv(sockfd, scratch.data(), scratch.size(), 0);
+      if (len <= 0)
+        continue;
+
+      conn.received += static_cast<std::size_t>(len);
+      const auto now = clock::now();
+      while (conn.received >= size && !conn.in_flight.empty())
+      {
+        latency.record(now - conn.in_flight.front());
+        conn.in_flight.pop_front();
+        conn.received -= size;
+        ++complete;
+
+        // Closed loop: each echo puts the next message in flight.
+        conn.in_flight.push_back(now);
+        conn.unsent += size;
+      }
+      flush(conn);
+    }
+  }
+
+  messages += complete;
+  ::close(epfd);
+}
+
+/**
+ * @brief Loopback echo throughput and latency.
+ * @details Client threads keep `depth` messages of `size` bytes in flight
+ * on each of `conns` connections for one second. Latency is measured from
+ * when a message is queued to when its echo is fully received. Run with
+ * `--benchmark_format=json` or `--benchmark_out=<file>` for
+ * machine-readable results.
+ */
+static void BM_Echo(benchmark::State &state)
+{
+  using namespace io::socket;
+  using namespace std::chrono;
+
+  const auto conns = static_cast<std::size_t>(state.range(0));
+  const auto size = static_cast<std::size_t>(state.range(1));
+  const auto depth = static_cast<std::size_t>(state.range(2));
+  if (!bench_reserve_fds(conns))
+  {
+    state.SkipWithError("RLIMIT_NOFILE is too low");
+    return;
+  }
+
+  const auto addr = bench_loopback_address();
+  auto server = basic_context_thread<bench_echo_service>();
+  server.start(addr);
+
+  auto connections = std::vector<bench_echo_connection>();
+  connections.reserve(conns);
+  for (std::size_t i = 0; i < conns; ++i)
+  {
+    auto &conn = connections.emplace_back(bench_echo_connection{
+        .socket = socket_handle(AF_INET, SOCK_STREAM, 0)});
+    const auto sockfd = static_cast<native_socket_type>(conn.socket);
+    if (io::connect(conn.socket, addr))
+    {
+      state.SkipWithError("connect failed");
+      return;
+    }
+
+    auto nodelay = 1;
+    ::setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    ::fcntl(sockfd, F_SETFL, ::fcntl(sockfd, F_GETFL) | O_NONBLOCK);
+  }
+
+  auto latency = latency_histogram();
+  auto messages = std::atomic<std::uint64_t>();
+  for (auto _ : state)
+  {
+    auto done = std::atomic<bool>();
+    auto clients = std::vector<std::jthread>();
+    const auto threads =
+        std::min<std::size_t>(conns, BENCH_CLIENT_THREADS);
+    const auto share = (conns + threads - 1) / threads;
+    const auto start = steady_clock::now();
+    for (std::size_t offset = 0; offset < conns; offset += share)
+    {
+      auto span = std::span(connections).subspan(
+          offset, std::min(share, conns - offset));
+      clients.emplace_back([&, span] {
+        bench_echo_client(span, size, depth, done, latency, messages);
+      });
+    }
+
+    std::this_thread::sleep_for(BENCH_DURATION);
+    done = true;
+    clients.clear();
+    state.SetIterationTime(
+        duration<double>(steady_clock::now() - start).count());
+  }
+
+  auto micros = [&](double percentile) {
+    return duration<double, std::micro>(latency.percentile(percentile))
+        .count();
+  };
+  state.counters["msgs"] = benchmark::Counter(
+      static_cast<double>(messages), benchmark::Counter::kIsRate);
+  state.counters["bytes"] = benchmark::Counter(
+      static_cast<double>(messages * size), benchmark::Counter::kIsRate);
+  state.counters["p50_us"] = micros(50);
+  state.counters["p99_us"] = micros(99);
+  state.counters["p999_us"] = micros(99.9);
+}
+BENCHMARK(BM_Echo)
+    ->ArgNames({"conns", "size", "depth"})
+    ->ArgsProduct({{1, 10, 100, 1'000, 10'000}, {64, 1024, 16384}, {1, 8}})
+    ->Iterations(1)
+    ->UseManualTime();
+// NOLINTEND
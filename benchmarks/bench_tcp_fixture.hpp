@@ -0,0 +1,115 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// NOLINTBEGIN
+#pragma once
+#ifndef CPPNET_BENCH_TCP_FIXTURE_HPP
+#define CPPNET_BENCH_TCP_FIXTURE_HPP
+#include "net/service/async_tcp_service.hpp"
+#include "net/service/context_thread.hpp"
+
+#include <io/io.hpp>
+
+#include <arpa/inet.h>
+
+#include <cstdlib>
+
+using namespace net::service;
+
+/** @brief A TCP echo service that can be specialized by Service. */
+template <typename Service>
+struct bench_echo_base : public async_tcp_service<Service> {
+  using Base = async_tcp_service<Service>;
+  using socket_dialog = typename Base::socket_dialog;
+  using read_context = typename Base::read_context;
+  using socket_message = io::socket::socket_message<>;
+
+  template <typename T>
+  explicit bench_echo_base(io::socket::socket_address<T> address)
+      : Base(address)
+  {}
+
+  explicit bench_echo_base(shared_listener &listener) : Base(listener) {}
+
+  auto service(async_context &ctx, const socket_dialog &socket,
+               std::shared_ptr<read_context> rctx,
+               std::span<const std::byte> buf) -> void
+  {
+    if (!rctx)
+      return;
+
+    if (buf.empty())
+      return this->submit_recv(ctx, socket, std::move(rctx));
+
+    echo(ctx, socket, std::move(rctx), buf);
+  }
+
+  /** @brief Writes buf back, resuming partial writes, then reads again. */
+  auto echo(async_context &ctx, const socket_dialog &socket,
+            std::shared_ptr<read_context> rctx,
+            std::span<const std::byte> buf) -> void
+  {
+    using namespace stdexec;
+    sender auto sendmsg =
+        io::sendmsg(socket, socket_message{.buffers = buf}, 0) |
+        then([&, socket, rctx, buf](auto &&len) {
+          const auto sent = static_cast<std::size_t>(len);
+          if (sent < buf.size())
+            return echo(ctx, socket, rctx, buf.subspan(sent));
+          this->submit_recv(ctx, socket, rctx);
+        }) |
+        upon_error([](auto &&error) {});
+
+    ctx.scope.spawn(std::move(sendmsg));
+  }
+};
+
+/** @brief The default readiness-based echo service. */
+struct bench_echo_service : public bench_echo_base<bench_echo_service> {
+  using bench_echo_base::bench_echo_base;
+};
+
+/** @brief Returns a loopback address on a random port. */
+inline auto bench_loopback_address() -> io::socket::socket_address<sockaddr_in>
+{
+  constexpr auto PORT_MIN = 8000UL;
+  auto addr = io::socket::socket_address<sockaddr_in>();
+  addr->sin_family = AF_INET;
+  addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr->sin_port = htons(PORT_MIN + std::rand() % (UINT16_MAX - PORT_MIN + 1));
+  return addr;
+}
+
+/**
+ * @brief Sends buf on sock and blocks until it has been echoed back.
+ * @returns false if the echo failed.
+ */
+inline auto bench_echo(const io::socket::socket_handle &sock,
+                       std::span<char> buf) -> bool
+{
+  using namespace io::socket;
+  auto len = io::sendmsg(sock, socket_message<sockaddr_in>{.buffers = buf}, 0);
+  if (len != static_cast<decltype(len)>(buf.size()))
+    return false;
+
+  for (auto received = 0UL; received < buf.size(); received += len)
+  {
+    auto msg = socket_message<sockaddr_in>{.buffers = buf.subspan(received)};
+    if ((len = io::recvmsg(sock, msg, 0)) <= 0)
+      return false;
+  }
+  return true;
+}
+
+#endif // CPPNET_BENCH_TCP_FIXTURE_HPP
+// NOLINTEND
@@ -0,0 +1,90 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// NOLINTBEGIN
+#include "bench_tcp_fixture.hpp"
+#include "net/service/tcp_proxy_service.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <sys/resource.h>
+
+#include <thread>
+
+/** @returns The CPU time used by every thread of the process. */
+static auto process_cpu_seconds() -> double
+{
+  auto usage = rusage{};
+  ::getrusage(RUSAGE_SELF, &usage);
+  auto seconds = [](const timeval &tv) {
+    return static_cast<double>(tv.tv_sec) +
+           static_cast<double>(tv.tv_usec) / 1e6;
+  };
+  return seconds(usage.ru_utime) + seconds(usage.ru_stime);
+}
+
+/**
+ * @brief Loopback throughput from a client to a sink that discards what it
+ * reads, either directly or through the splice proxy. The cpu counter is
+ * the CPU time of all threads (client, proxy and sink) per second.
+ */
+template <bool Proxied> static void BM_Throughput(benchmark::State &state)
+{
+  using namespace io::socket;
+  using namespace std::chrono;
+
+  const auto sink_addr = bench_loopback_address();
+  auto listener = socket_handle(AF_INET, SOCK_STREAM, 0);
+  if (bind(listener, sink_addr) || listen(listener, 1))
+    return state.SkipWithError("failed to listen");
+
+  auto sink = std::jthread([&] {
+    auto sockfd =
+        ::accept(static_cast<native_socket_type>(listener), nullptr, nullptr);
+    auto buf = std::vector<char>(1024UL * 1024);
+    while (::recv(sockfd, buf.data(), buf.size(), 0) > 0);
+    ::close(sockfd);
+  });
+
+  auto addr = sink_addr;
+  auto proxy = basic_context_thread<tcp_proxy_service>();
+  if constexpr (Proxied)
+  {
+    addr->sin_port = htons(ntohs(sink_addr->sin_port) + 1);
+    proxy.start(addr, sink_addr);
+  }
+
+  auto sock = socket_handle(AF_INET, SOCK_STREAM, 0);
+  if (io::connect(sock, addr))
+    return state.SkipWithError("failed to connect");
+
+  auto chunk = std::vector<char>(state.range(0));
+  auto msg = socket_message<sockaddr_in>{.buffers = chunk};
+  auto cpu = process_cpu_seconds();
+  auto start = steady_clock::now();
+  for (auto _ : state)
+  {
+    if (io::sendmsg(sock, msg, 0) != static_cast<ssize_t>(chunk.size()))
+      return state.SkipWithError("send failed");
+  }
+  ::shutdown(static_cast<native_socket_type>(sock), SHUT_WR);
+  sink.join();
+
+  auto wall = duration<double>(steady_clock::now() - start).count();
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+  state.counters["cpu"] = (process_cpu_seconds() - cpu) / wall;
+}
+BENCHMARK_TEMPLATE(BM_Throughput, false)->Arg(4096)->Arg(65536)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Throughput, true)->Arg(4096)->Arg(65536)->UseRealTime();
+// NOLINTEND
@@ -0,0 +1,105 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// NOLINTBEGIN
+#include "bench_tcp_fixture.hpp"
+#include "net/service/rebalancer.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <thread>
+
+/**
+ * @brief Skewed load: every client connects to the first of several
+ * context threads. With rebalancing enabled, connections are migrated to
+ * the idle context threads while the benchmark runs.
+ */
+template <bool Rebalance> static void BM_SkewedLoad(benchmark::State &state)
+{
+  using namespace io::socket;
+  using namespace std::chrono;
+  using server_type = basic_context_thread<bench_echo_service>;
+  constexpr auto NUM_LOOPS = 4;
+
+  auto balancer = rebalancer<bench_echo_service>(1.25);
+  std::array<server_type, NUM_LOOPS> servers;
+  const auto addr = bench_loopback_address();
+  for (auto port = ntohs(addr->sin_port); auto &server : servers)
+  {
+    auto server_addr = addr;
+    server_addr->sin_port = htons(port++);
+    server.start(server_addr);
+    balancer.add(server, server.service());
+  }
+
+  auto timer = net::timers::INVALID_TIMER;
+  if constexpr (Rebalance)
+  {
+    timer = servers[0].timers.add(
+        milliseconds(10), [&](auto) { balancer.rebalance(); },
+        milliseconds(10));
+  }
+
+  auto ops = std::atomic<std::uint64_t>();
+  for (auto _ : state)
+  {
+    auto done = std::atomic<bool>();
+    auto clients = std::vector<std::jthread>();
+    auto start = steady_clock::now();
+    for (auto i = 0; i < state.range(0); ++i)
+    {
+      clients.emplace_back([&] {
+        auto sock = socket_handle(AF_INET, SOCK_STREAM, 0);
+        if (io::connect(sock, addr))
+          return;
+
+        auto buf = std::array<char, 64>{};
+        auto count = std::uint64_t();
+        while (!done && bench_echo(sock, buf))
+          ++count;
+        ops += count;
+      });
+    }
+
+    std::this_thread::sleep_for(seconds(1));
+    done = true;
+    clients.clear();
+    state.SetIterationTime(
+        duration<double>(steady_clock::now() - start).count());
+  }
+
+  servers[0].timers.remove(timer);
+  std::this_thread::sleep_for(milliseconds(20));
+
+  state.counters["ops"] = benchmark::Counter(static_cast<double>(ops),
+                                             benchmark::Counter::kIsRate);
+  for (auto i = 0; i < NUM_LOOPS; ++i)
+  {
+    state.counters["loop" + std::to_string(i) + "_reads"] =
+        static_cast<double>(servers[i].service().reads());
+  }
+}
+BENCHMARK_TEMPLATE(BM_SkewedLoad, false)
+    ->Arg(4)
+    ->Arg(16)
+    ->Arg(64)
+    ->Iterations(1)
+    ->UseManualTime();
+BENCHMARK_TEMPLATE(BM_SkewedLoad, true)
+    ->Arg(4)
+    ->Arg(16)
+    ->Arg(64)
+    ->Iterations(1)
+    ->UseManualTime();
+// NOLINTEND
@@ -0,0 +1,113 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// NOLINTBEGIN
+#include "bench_tcp_fixture.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+
+/** @brief An echo service that counts the connections it accepts. */
+template <typename Service>
+struct bench_counting_base : public bench_echo_base<Service> {
+  using Base = bench_echo_base<Service>;
+  using Base::Base;
+
+  std::atomic<std::size_t> accepted = 0;
+
+  auto service(async_context &ctx, const typename Base::socket_dialog &socket,
+               std::shared_ptr<typename Base::read_context> rctx,
+               std::span<const std::byte> buf) -> void
+  {
+    if (rctx && buf.empty())
+      accepted.fetch_add(1, std::memory_order_relaxed);
+    Base::service(ctx, socket, std::move(rctx), buf);
+  }
+};
+
+/** @brief One listening socket per context thread, with SO_REUSEPORT. */
+struct bench_reuseport_service
+    : public bench_counting_base<bench_reuseport_service> {
+  using bench_counting_base::bench_counting_base;
+
+  auto initialize(const io::socket::socket_handle &socket) -> std::error_code
+  {
+    using namespace io;
+    using namespace io::socket;
+    if (auto reuse = socket_option<int>(1);
+        setsockopt(socket, SOL_SOCKET, SO_REUSEPORT, reuse))
+    {
+      return {errno, std::system_category()};
+    }
+    return {};
+  }
+};
+
+/** @brief One listening socket shared by every context thread. */
+struct bench_shared_service
+    : public bench_counting_base<bench_shared_service> {
+  using bench_counting_base::bench_counting_base;
+};
+
+/**
+ * @brief Accept latency and fairness: each iteration connects, echoes once
+ * and closes. The fairness counter is the ratio of the fewest to the most
+ * connections accepted by any one context thread.
+ */
+template <typename Service> static void BM_Accept(benchmark::State &state)
+{
+  using namespace io::socket;
+  constexpr auto NUM_LOOPS = 4;
+
+  const auto addr = bench_loopback_address();
+  auto listener = shared_listener(addr);
+  std::array<basic_context_thread<Service>, NUM_LOOPS> servers;
+  for (auto &server : servers)
+  {
+    if constexpr (std::is_same_v<Service, bench_shared_service>)
+      server.start(listener);
+    else
+      server.start(addr);
+  }
+
+  auto buf = std::array<char, 64>{};
+  for (auto _ : state)
+  {
+    auto sock = socket_handle(AF_INET, SOCK_STREAM, 0);
+    if (io::connect(sock, addr) || !bench_echo(sock, buf))
+    {
+      state.SkipWithError("echo failed");
+      break;
+    }
+  }
+
+  auto counts = std::array<std::size_t, NUM_LOOPS>{};
+  for (auto i = 0; i < NUM_LOOPS; ++i)
+  {
+    counts[i] = servers[i].service().accepted.load();
+    state.counters["loop" + std::to_string(i) + "_accepts"] =
+        static_cast<double>(counts[i]);
+  }
+
+  auto [min, max] = std::ranges::minmax(counts);
+  state.counters["fairness"] =
+      max ? static_cast<double>(min) / static_cast<double>(max) : 0.0;
+  state.counters["connections"] = benchmark::Counter(
+      static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+BENCHMARK_TEMPLATE(BM_Accept, bench_reuseport_service)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Accept, bench_shared_service)->UseRealTime();
+// NOLINTEND
@@ -0,0 +1,188 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// NOLINTBEGIN
+#include "net/timers/timers.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <deque>
+#include <memory>
+
+using namespace net::timers;
+
+/**
+ * @brief An interrupt source that does nothing, so that the benchmarks
+ * measure the timer engine rather than the event loop wake up.
+ */
+struct bench_null_interrupt {
+  auto interrupt() const noexcept -> void {}
+};
+
+using bench_timers = timers<bench_null_interrupt>;
+
+/** @brief A timer handler that does nothing. */
+static auto bench_noop(timer_id) -> void {}
+
+/** @brief Far enough in the future that the timers never fire. */
+static constexpr auto BENCH_NEVER = std::chrono::hours(1);
+
+/** @brief Adds N timers to an empty engine. */
+static void BM_Add(benchmark::State &state)
+{
+  const auto count = state.range(0);
+  for (auto _ : state)
+  {
+    auto engine = bench_timers();
+    for (auto i = 0; i < count; ++i)
+      benchmark::DoNotOptimize(engine.add(BENCH_NEVER, bench_noop));
+
+    state.PauseTiming();
+    {
+      auto discard = std::move(engine);
+    }
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_Add)->RangeMultiplier(10)->Range(1'000, 1'000'000);
+
+/** @brief Removes N timers, then resolves to reclaim their ids. */
+static void BM_Remove(benchmark::State &state)
+{
+  const auto count = state.range(0);
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    auto engine = bench_timers();
+    auto ids = std::vector<timer_id>();
+    ids.reserve(static_cast<std::size_t>(count));
+    for (auto i = 0; i < count; ++i)
+      ids.push_back(engine.add(BENCH_NEVER, bench_noop));
+    state.ResumeTiming();
+
+    for (auto id : ids)
+      benchmark::DoNotOptimize(engine.remove(id));
+    benchmark::DoNotOptimize(engine.resolve());
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_Remove)->RangeMultiplier(10)->Range(1'000, 1'000'000);
+
+/** @brief Resolves N timers that have all expired. */
+static void BM_ResolveExpired(benchmark::State &state)
+{
+  const auto count = state.range(0);
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    auto engine = bench_timers();
+    const auto now = clock::now();
+    for (auto i = 0; i < count; ++i)
+      engine.add(now, bench_noop);
+    state.ResumeTiming();
+
+    benchmark::DoNotOptimize(engine.resolve());
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_ResolveExpired)->RangeMultiplier(10)->Range(1'000, 1'000'000);
+
+/**
+ * @brief Resolves with N pending timers of which none have expired. This
+ * is the cost the event loop pays on every iteration.
+ */
+static void BM_ResolveIdle(benchmark::State &state)
+{
+  const auto count = state.range(0);
+  auto engine = bench_timers();
+  for (auto i = 0; i < count; ++i)
+    engine.add(BENCH_NEVER, bench_noop);
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(engine.resolve());
+}
+BENCHMARK(BM_ResolveIdle)->RangeMultiplier(10)->Range(1'000, 1'000'000);
+
+/**
+ * @brief Cancel-heavy churn: N timeouts are pending, and each iteration
+ * arms a new one and cancels the oldest, as a request timeout does when
+ * its request completes. The loop resolves every 64 iterations.
+ */
+static void BM_CancelChurn(benchmark::State &state)
+{
+  const auto count = state.range(0);
+  auto engine = bench_timers();
+  auto pending = std::deque<timer_id>();
+  for (auto i = 0; i < count; ++i)
+    pending.push_back(engine.add(BENCH_NEVER, bench_noop));
+
+  auto n = 0U;
+  for (auto _ : state)
+  {
+    pending.push_back(engine.add(BENCH_NEVER, bench_noop));
+    engine.remove(pending.front());
+    pending.pop_front();
+    if ((++n & 63U) == 0)
+      benchmark::DoNotOptimize(engine.resolve());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CancelChurn)->RangeMultiplier(10)->Range(1'000, 1'000'000);
+
+/**
+ * @brief Resolves N periodic timers that are always due, so each resolve
+ * fires and re-queues every timer.
+ */
+static void BM_Periodic(benchmark::State &state)
+{
+  const auto count = state.range(0);
+  auto engine = bench_timers();
+  auto fired = std::uint64_t{0};
+  for (auto i = 0; i < count; ++i)
+  {
+    engine.add(
+        clock::now(), [&](timer_id) { ++fired; }, duration(1));
+  }
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(engine.resolve());
+  state.SetItemsProcessed(static_cast<std::int64_t>(fired));
+}
+BENCHMARK(BM_Periodic)->RangeMultiplier(10)->Range(1'000, 100'000);
+
+/**
+ * @brief Cross-thread add contention: every thread adds timers that
+ * expire immediately to one engine, and the first thread also resolves
+ * them, as an event loop does for timers added by other threads.
+ */
+static void BM_ContendedAdd(benchmark::State &state)
+{
+  static auto engine = std::unique_ptr<bench_timers>();
+  if (state.thread_index() == 0)
+    engine = std::make_unique<bench_timers>();
+
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(engine->add(duration(0), bench_noop));
+    if (state.thread_index() == 0)
+      benchmark::DoNotOptimize(engine->resolve());
+  }
+
+  if (state.thread_index() == 0)
+    engine.reset();
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ContendedAdd)->ThreadRange(1, 8)->UseRealTime();
+// NOLINTEND
@@ -0,0 +1,226 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// NOLINTBEGIN
+#include "bench_tcp_fixture.hpp"
+#include "net/service/async_udp_service.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <pthread.h>
+#include <time.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+/**
+ * @brief A UDP service that counts the datagrams it receives.
+ * @details Services bind with SO_REUSEPORT so that several of them can
+ * share the port, and each records the CPU clock of its context thread.
+ */
+template <typename Service, std::size_t Size>
+struct bench_udp_sink_base : public async_udp_service<Service, Size> {
+  using Base = async_udp_service<Service, Size>;
+  using socket_dialog = typename Base::socket_dialog;
+  using read_context = typename Base::read_context;
+
+  template <typename T>
+  explicit bench_udp_sink_base(io::socket::socket_address<T> address)
+      : Base(address)
+  {}
+
+  std::atomic<std::uint64_t> received = 0;
+  clockid_t cpu_clock = CLOCK_THREAD_CPUTIME_ID;
+
+  auto initialize(const io::socket::socket_handle &socket) -> std::error_code
+  {
+    using namespace io;
+    using namespace io::socket;
+    if (auto reuse = socket_option<int>(1);
+        setsockopt(socket, SOL_SOCKET, SO_REUSEPORT, reuse))
+    {
+      return {errno, std::system_category()};
+    }
+
+    // initialize runs on the context thread.
+    ::pthread_getcpuclockid(::pthread_self(), &cpu_clock);
+    return {};
+  }
+
+  auto service(async_context &ctx, const socket_dialog &socket,
+               std::shared_ptr<read_context> rctx,
+               std::span<const std::byte> buf) -> void
+  {
+    if (!rctx || buf.empty())
+      return;
+
+    received.store(received.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_relaxed);
+    this->submit_recv(ctx, socket, std::move(rctx));
+  }
+
+  /** @returns The CPU time used by the context thread so far. */
+  auto cpu_time() const -> std::chrono::nanoseconds
+  {
+    auto time = timespec{};
+    ::clock_gettime(cpu_clock, &time);
+    return std::chrono::seconds(time.tv_sec) +
+           std::chrono::nanoseconds(time.tv_nsec);
+  }
+};
+
+/** @brief Receives one datagram per recvmsg. */
+template <std::size_t Size>
+struct bench_udp_sink_service
+    : public bench_udp_sink_base<bench_udp_sink_service<Size>, Size> {
+  using bench_udp_sink_base<bench_udp_sink_service<Size>,
+                            Size>::bench_udp_sink_base;
+};
+
+/**
+ * @brief Receives up to recv_batch datagrams per recvmmsg, and counts the
+ * datagrams the kernel drops with SO_RXQ_OVFL.
+ */
+template <std::size_t Size>
+struct bench_udp_mmsg_service
+    : public bench_udp_sink_base<bench_udp_mmsg_service<Size>, Size> {
+  using bench_udp_sink_base<bench_udp_mmsg_service<Size>,
+                            Size>::bench_udp_sink_base;
+
+  static constexpr std::size_t recv_batch = 64;
+  static constexpr bool rxq_overflow = true;
+};
+
+/**
+ * @brief Loopback receive rate: `senders` client threads send datagrams
+ * of `bytes` bytes as fast as they can for one second to `services`
+ * services that share the port with SO_REUSEPORT. Datagrams the services
+ * cannot keep up with are dropped by the kernel, so pps counts only what
+ * was received.
+ * @details Counters:
+ * - `pps` and `sent_pps`: datagrams received and sent per second.
+ * - `drops`: datagrams sent but never received. On loopback these are
+ *   all receive buffer overflows.
+ * - `kernel_drops`: the SO_RXQ_OVFL counters of services that enable it.
+ * - `cpu_ns_per_pkt`: context thread CPU time per received datagram.
+ */
+template <typename Service> static void BM_RecvRate(benchmark::State &state)
+{
+  using namespace io::socket;
+  using namespace std::chrono;
+  constexpr auto BATCH = 64;
+
+  const auto senders = state.range(0);
+  const auto bytes = static_cast<std::size_t>(state.range(1));
+  const auto addr = bench_loopback_address();
+  auto servers = std::vector<std::unique_ptr<basic_context_thread<Service>>>();
+  for (auto i = 0; i < state.range(2); ++i)
+  {
+    servers.push_back(std::make_unique<basic_context_thread<Service>>());
+    servers.back()->start(addr);
+  }
+
+  auto received = [&] {
+    auto total = std::uint64_t{0};
+    for (auto &server : servers)
+      total += server->service().received.load();
+    return total;
+  };
+  auto cpu_time = [&] {
+    auto total = nanoseconds(0);
+    for (auto &server : servers)
+      total += server->service().cpu_time();
+    return total;
+  };
+
+  auto sent = std::atomic<std::uint64_t>();
+  auto total_received = std::uint64_t{0};
+  auto total_cpu = nanoseconds(0);
+  for (auto _ : state)
+  {
+    const auto before = received();
+    const auto cpu_before = cpu_time();
+    auto done = std::atomic<bool>();
+    auto clients = std::vector<std::jthread>();
+    auto start = steady_clock::now();
+    for (auto i = 0; i < senders; ++i)
+    {
+      clients.emplace_back([&] {
+        auto sock = socket_handle(AF_INET, SOCK_DGRAM, 0);
+        const auto sockfd = static_cast<native_socket_type>(sock);
+        if (io::connect(sock, addr))
+          return;
+
+        auto payload = std::vector<char>(bytes);
+        auto iov = iovec{.iov_base = payload.data(), .iov_len = payload.size()};
+        auto headers = std::array<mmsghdr, BATCH>{};
+        for (auto &header : headers)
+          header.msg_hdr = {.msg_iov = &iov, .msg_iovlen = 1};
+
+        auto count = std::uint64_t();
+        while (!done)
+        {
+          if (auto len = ::sendmmsg(sockfd, headers.data(), BATCH, 0); len > 0)
+            count += static_cast<std::uint64_t>(len);
+        }
+        sent += count;
+      });
+    }
+
+    std::this_thread::sleep_for(seconds(1));
+    done = true;
+    clients.clear();
+    std::this_thread::sleep_for(milliseconds(10));
+    state.SetIterationTime(
+        duration<double>(steady_clock::now() - start).count());
+    total_received += received() - before;
+    total_cpu += cpu_time() - cpu_before;
+  }
+
+  state.counters["pps"] = benchmark::Counter(
+      static_cast<double>(total_received), benchmark::Counter::kIsRate);
+  state.counters["sent_pps"] = benchmark::Counter(
+      static_cast<double>(sent), benchmark::Counter::kIsRate);
+  state.counters["drops"] = static_cast<double>(sent - total_received);
+  if constexpr (requires { Service::rxq_overflow; })
+  {
+    auto drops = std::uint64_t{0};
+    for (auto &server : servers)
+      drops += server->service().statistics().drops.load();
+    state.counters["kernel_drops"] = static_cast<double>(drops);
+  }
+  state.counters["cpu_ns_per_pkt"] =
+      total_received ? static_cast<double>(total_cpu.count()) /
+                           static_cast<double>(total_received)
+                     : 0.0;
+}
+
+/** @brief Sweeps senders, datagram bytes and the number of services. */
+static void bench_recv_args(benchmark::internal::Benchmark *bench)
+{
+  bench->ArgNames({"senders", "bytes", "services"})
+      ->ArgsProduct({{1, 4}, {64, 1024}, {1, 4}})
+      ->Iterations(1)
+      ->UseManualTime();
+}
+BENCHMARK_TEMPLATE(BM_RecvRate, bench_udp_sink_service<2048>)
+    ->Apply(bench_recv_args);
+BENCHMARK_TEMPLATE(BM_RecvRate, bench_udp_sink_service<64 * 1024>)
+    ->Apply(bench_recv_args);
+BENCHMARK_TEMPLATE(BM_RecvRate, bench_udp_mmsg_service<2048>)
+    ->Apply(bench_recv_args);
+BENCHMARK_TEMPLATE(BM_RecvRate, bench_udp_mmsg_service<64 * 1024>)
+    ->Apply(bench_recv_args);
+// NOLINTEND
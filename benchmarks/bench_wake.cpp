@@ -0,0 +1,222 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// NOLINTBEGIN
+#include "net/service/context_thread.hpp"
+#include "net/service/latency_histogram.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace net::service;
+
+/** @brief The ways another thread can wake a context thread. */
+enum class bench_source : std::uint8_t {
+  /** @brief async_context::signal, handled by the service signal handler. */
+  signal,
+  /** @brief A zero delay timer added with timers.add. */
+  timer,
+  /** @brief A byte written to a socket that the service watches with isr. */
+  isr,
+};
+
+/** @brief Returns the steady clock time in nanoseconds. */
+static auto bench_now() noexcept -> std::int64_t
+{
+  using namespace std::chrono;
+  return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/**
+ * @brief Records when it was last woken by any source.
+ * @details A busy service keeps its event loop spinning by deferring a
+ * short piece of work to every loop iteration, so that wake ups arrive
+ * while the loop is running instead of while it is blocked in poll.
+ */
+struct bench_wake_service {
+  explicit bench_wake_service(bool busy) : busy{busy} {}
+
+  bool busy = false;
+  bool stopping = false;
+  async_context *ctx = nullptr;
+  std::array<int, 2> sockets{-1, -1};
+  std::atomic<std::uint64_t> wakes = 0;
+  std::atomic<std::int64_t> woken_at = 0;
+
+  auto wake() noexcept -> void
+  {
+    woken_at.store(bench_now(), std::memory_order_relaxed);
+    wakes.fetch_add(1, std::memory_order_release);
+  }
+
+  auto spin() -> void
+  {
+    if (stopping)
+      return;
+
+    const auto until = bench_now() + 1000;
+    while (bench_now() < until);
+    ctx->defer([this] { spin(); });
+  }
+
+  auto signal_handler(int signum) noexcept -> void
+  {
+    if (signum == async_context::user1)
+      return wake();
+
+    if (signum == async_context::terminate && !stopping)
+    {
+      // Let the isr routine see that the service is stopping.
+      stopping = true;
+      ::send(sockets[1], "x", 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+    }
+  }
+
+  auto start(async_context &ctx) noexcept -> std::error_code
+  {
+    this->ctx = &ctx;
+    if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sockets.data()))
+      return {errno, std::system_category()};
+
+    ctx.isr(ctx.poller.emplace(sockets[0]), [this] {
+      wake();
+      return !stopping;
+    });
+
+    if (busy)
+      ctx.defer([this] { spin(); });
+    return {};
+  }
+
+  ~bench_wake_service()
+  {
+    if (sockets[1] >= 0)
+      ::close(sockets[1]);
+  }
+};
+
+using bench_wake_thread = basic_context_thread<bench_wake_service>;
+
+/** @brief Wakes the context thread with Source. */
+template <bench_source Source>
+static auto bench_wake(bench_wake_thread &thread) -> void
+{
+  if constexpr (Source == bench_source::signal)
+  {
+    thread.signal(async_context::user1);
+  }
+  else if constexpr (Source == bench_source::timer)
+  {
+    auto *service = std::addressof(thread.service());
+    thread.timers.add(net::timers::duration(0),
+                      [service](auto) { service->wake(); });
+  }
+  else
+  {
+    ::send(thread.service().sockets[1], "x", 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+  }
+}
+
+/**
+ * @brief One-way wake latency: the time from waking the context thread
+ * to its handler running, with the loop idle (busy=0) or spinning
+ * (busy=1). Each wake waits for the previous one to be handled.
+ */
+template <bench_source Source>
+static void BM_WakeLatency(benchmark::State &state)
+{
+  auto thread = bench_wake_thread();
+  thread.start(state.range(0) != 0);
+  auto &service = thread.service();
+
+  auto latency = latency_histogram();
+  for (auto _ : state)
+  {
+    const auto before = service.wakes.load(std::memory_order_acquire);
+    const auto start = bench_now();
+    bench_wake<Source>(thread);
+    while (service.wakes.load(std::memory_order_acquire) == before);
+
+    latency.record(std::chrono::nanoseconds(
+        service.woken_at.load(std::memory_order_relaxed) - start));
+  }
+
+  const auto percentile = [&](double p) {
+    return static_cast<double>(latency.percentile(p).count());
+  };
+  state.counters["p50_ns"] = percentile(50);
+  state.counters["p99_ns"] = percentile(99);
+  state.counters["p999_ns"] = percentile(99.9);
+}
+BENCHMARK_TEMPLATE(BM_WakeLatency, bench_source::signal)
+    ->ArgName("busy")
+    ->DenseRange(0, 1)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_WakeLatency, bench_source::timer)
+    ->ArgName("busy")
+    ->DenseRange(0, 1)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_WakeLatency, bench_source::isr)
+    ->ArgName("busy")
+    ->DenseRange(0, 1)
+    ->UseRealTime();
+
+/**
+ * @brief Sustained signalling: wakes are sent back to back without
+ * waiting. Signals and isr bytes that arrive before the loop handles the
+ * previous ones coalesce into one wake up, so `handled` may be lower
+ * than the send rate. Timers never coalesce.
+ */
+template <bench_source Source>
+static void BM_WakeThroughput(benchmark::State &state)
+{
+  auto thread = bench_wake_thread();
+  thread.start(state.range(0) != 0);
+  auto &service = thread.service();
+
+  const auto before = service.wakes.load(std::memory_order_acquire);
+  for (auto _ : state)
+    bench_wake<Source>(thread);
+
+  // Let the loop catch up before counting.
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  const auto handled = static_cast<double>(
+      service.wakes.load(std::memory_order_acquire) - before);
+  state.counters["handled"] =
+      benchmark::Counter(handled, benchmark::Counter::kIsRate);
+  state.counters["handled_ratio"] =
+      handled / static_cast<double>(state.iterations());
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+BENCHMARK_TEMPLATE(BM_WakeThroughput, bench_source::signal)
+    ->ArgName("busy")
+    ->DenseRange(0, 1)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_WakeThroughput, bench_source::timer)
+    ->ArgName("busy")
+    ->DenseRange(0, 1)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_WakeThroughput, bench_source::isr)
+    ->ArgName("busy")
+    ->DenseRange(0, 1)
+    ->UseRealTime();
+// NOLINTEND
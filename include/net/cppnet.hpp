@@ -23,7 +23,22 @@ namespace net {}                         // namespace net
 #include "service/async_context.hpp"     // IWYU pragma: export
 #include "service/async_tcp_service.hpp" // IWYU pragma: export
 #include "service/async_udp_service.hpp" // IWYU pragma: export
+#include "service/buffer_tuner.hpp"      // IWYU pragma: export
+#include "service/connection.hpp"        // IWYU pragma: export
 #include "service/context_thread.hpp"    // IWYU pragma: export
+#include "service/latency_histogram.hpp" // IWYU pragma: export
+#include "service/metrics.hpp"           // IWYU pragma: export
+#include "service/metrics_exporter.hpp"  // IWYU pragma: export
+#include "service/pacer.hpp"             // IWYU pragma: export
+#include "service/pipeline.hpp"          // IWYU pragma: export
+#include "service/rebalancer.hpp"        // IWYU pragma: export
+#include "service/request_lifecycle.hpp" // IWYU pragma: export
+#include "service/session_table.hpp"     // IWYU pragma: export
+#include "service/shared_buffer.hpp"     // IWYU pragma: export
+#include "service/shared_listener.hpp"   // IWYU pragma: export
+#include "service/task.hpp"              // IWYU pragma: export
+#include "service/tcp_multiplexer.hpp"   // IWYU pragma: export
+#include "service/tcp_proxy_service.hpp" // IWYU pragma: export
 #include "timers/interrupt.hpp"          // IWYU pragma: export
 #include "timers/timers.hpp"             // IWYU pragma: export
 #endif                                   // CPPNET_HPP
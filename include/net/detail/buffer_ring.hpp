@@ -0,0 +1,89 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file buffer_ring.hpp
+ * @brief This file defines buffer_ring.
+ */
+#pragma once
+#ifndef CPPNET_BUFFER_RING_HPP
+#define CPPNET_BUFFER_RING_HPP
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+/** @brief This namespace provides internal cppnet implementation details. */
+namespace net::detail {
+/**
+ * @brief A fixed-size ring of recyclable buffers.
+ * @details The ring owns one reference to every buffer it holds. A
+ * buffer is free when the ring holds its only reference, so a buffer
+ * returns to the ring as soon as the last external shared pointer to it
+ * is released, regardless of which thread releases it. `acquire` must
+ * only be called from one thread at a time.
+ * @tparam T The buffer type. It must be default constructible.
+ */
+template <typename T> class buffer_ring {
+public:
+  /** @brief Default constructor. Constructs an empty ring. */
+  buffer_ring() = default;
+  /**
+   * @brief Constructs a ring with `capacity` preallocated buffers.
+   * @param capacity The number of buffers in the ring.
+   */
+  explicit buffer_ring(std::size_t capacity)
+  {
+    buffers_.reserve(capacity);
+    for (std::size_t i = 0; i < capacity; ++i)
+      buffers_.push_back(std::make_shared<T>());
+  }
+
+  /**
+   * @brief Acquires a free buffer.
+   * @details The ring is scanned once starting from the last
+   * acquired position. If every buffer is in use, a transient buffer
+   * that is not recycled by the ring is allocated instead.
+   * @returns A shared pointer to a buffer.
+   */
+  auto acquire() -> std::shared_ptr<T>
+  {
+    const auto size = buffers_.size();
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      auto &buffer = buffers_[next_];
+      next_ = (next_ + 1 == size) ? 0 : next_ + 1;
+      if (buffer.use_count() == 1)
+      {
+        // Synchronize with the release of the last external reference.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return buffer;
+      }
+    }
+
+    return std::make_shared<T>();
+  }
+
+  /** @returns The number of buffers owned by the ring. */
+  [[nodiscard]] auto size() const noexcept -> std::size_t
+  {
+    return buffers_.size();
+  }
+
+private:
+  /** @brief The recyclable buffers. */
+  std::vector<std::shared_ptr<T>> buffers_;
+  /** @brief The next ring position to scan from. */
+  std::size_t next_ = 0;
+};
+} // namespace net::detail
+#endif // CPPNET_BUFFER_RING_HPP
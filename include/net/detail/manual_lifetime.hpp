@@ -0,0 +1,65 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file manual_lifetime.hpp
+ * @brief This file defines manual_lifetime.
+ */
+#pragma once
+#ifndef CPPNET_MANUAL_LIFETIME_HPP
+#define CPPNET_MANUAL_LIFETIME_HPP
+#include <array>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+/** @brief This namespace provides internal cppnet implementation details. */
+namespace net::detail {
+/**
+ * @brief Storage for an object whose lifetime is managed by its owner.
+ * @details The object is constructed from the result of a function, so
+ * immovable types such as operation states can be constructed in place.
+ * @tparam T The object type.
+ */
+template <typename T> class manual_lifetime {
+public:
+  /**
+   * @brief Constructs the object.
+   * @tparam Fn A function that returns a T.
+   * @param func The function.
+   * @returns A reference to the object.
+   */
+  template <typename Fn>
+    requires std::is_same_v<std::invoke_result_t<Fn>, T>
+  auto construct(Fn &&func) -> T &
+  {
+    auto *ptr = static_cast<void *>(storage_.data());
+    return *::new (ptr) T(std::forward<Fn>(func)());
+  }
+
+  /** @brief Destroys the object. */
+  auto destroy() noexcept -> void { get().~T(); }
+
+  /** @returns A reference to the object. */
+  [[nodiscard]] auto get() noexcept -> T &
+  {
+    return *std::launder(reinterpret_cast<T *>(storage_.data()));
+  }
+
+private:
+  /** @brief The object storage. */
+  alignas(T) std::array<std::byte, sizeof(T)> storage_;
+};
+
+} // namespace net::detail
+#endif // CPPNET_MANUAL_LIFETIME_HPP
@@ -0,0 +1,64 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file tcp_info.hpp
+ * @brief This file defines tcp_info_ext.
+ */
+#pragma once
+#ifndef CPPNET_TCP_INFO_HPP
+#define CPPNET_TCP_INFO_HPP
+#include <cstddef>
+#include <cstdint>
+
+#include <netinet/tcp.h>
+/** @brief This namespace provides internal cppnet implementation details. */
+namespace net::detail {
+/**
+ * @brief The TCP_INFO socket option structure, extended with the fields
+ * that Linux reports after `tcpi_total_retrans`.
+ * @details glibc's `struct tcp_info` stops at `tcpi_total_retrans`. The
+ * kernel only fills the fields it knows about and reports the length it
+ * wrote, so a field is valid only if the reported length covers it.
+ */
+struct tcp_info_ext {
+  /** @brief The fields declared by glibc. */
+  ::tcp_info info;
+  /** @brief The current pacing rate in bytes per second. */
+  std::uint64_t tcpi_pacing_rate;
+  /** @brief The maximum pacing rate in bytes per second. */
+  std::uint64_t tcpi_max_pacing_rate;
+  /** @brief The number of bytes acknowledged by the peer. */
+  std::uint64_t tcpi_bytes_acked;
+  /** @brief The number of bytes received from the peer. */
+  std::uint64_t tcpi_bytes_received;
+  /** @brief The number of segments sent. */
+  std::uint32_t tcpi_segs_out;
+  /** @brief The number of segments received. */
+  std::uint32_t tcpi_segs_in;
+  /** @brief The number of bytes queued but not yet sent. */
+  std::uint32_t tcpi_notsent_bytes;
+  /** @brief The minimum observed RTT in microseconds. */
+  std::uint32_t tcpi_min_rtt;
+  /** @brief The number of data segments received. */
+  std::uint32_t tcpi_data_segs_in;
+  /** @brief The number of data segments sent. */
+  std::uint32_t tcpi_data_segs_out;
+  /** @brief The most recent delivery rate sample in bytes per second. */
+  std::uint64_t tcpi_delivery_rate;
+};
+
+static_assert(offsetof(tcp_info_ext, tcpi_pacing_rate) == sizeof(::tcp_info),
+              "tcp_info_ext must extend the kernel tcp_info layout.");
+} // namespace net::detail
+#endif // CPPNET_TCP_INFO_HPP
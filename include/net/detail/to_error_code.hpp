@@ -0,0 +1,46 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file to_error_code.hpp
+ * @brief This file defines to_error_code.
+ */
+#pragma once
+#ifndef CPPNET_TO_ERROR_CODE_HPP
+#define CPPNET_TO_ERROR_CODE_HPP
+#include <system_error>
+#include <type_traits>
+/** @brief This namespace provides internal cppnet implementation details. */
+namespace net::detail {
+/**
+ * @brief Converts the error of an io operation to an error code.
+ * @details The io operations report errors as errno values, which are
+ * kept in the system category. Errors of any other type are reported as
+ * io_error.
+ * @tparam Error The error type.
+ * @param error The error.
+ * @returns The error code.
+ */
+template <typename Error>
+auto to_error_code(const Error &error) noexcept -> std::error_code
+{
+  if constexpr (std::is_convertible_v<Error, std::error_code>)
+    return error;
+  else if constexpr (std::is_convertible_v<Error, int>)
+    return {static_cast<int>(error), std::system_category()};
+  else
+    return std::make_error_code(std::errc::io_error);
+}
+
+} // namespace net::detail
+#endif // CPPNET_TO_ERROR_CODE_HPP
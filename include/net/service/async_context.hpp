@@ -27,6 +27,8 @@
 
 #include <atomic>
 #include <cstdint>
+#include <functional>
+#include <vector>
 /** @brief This namespace is for network services. */
 namespace net::service {
 
@@ -68,6 +70,8 @@ struct async_context : detail::immovable {
   std::atomic<signal_mask> sigmask;
   /** @brief A counter that tracks the context state. */
   std::atomic<context_states> state{PENDING};
+  /** @brief Routines deferred to the end of the event loop iteration. */
+  std::vector<std::function<void()>> deferred;
 
   /**
    * @brief Sets the signal mask, then interrupts the service.
@@ -105,7 +109,40 @@ struct async_context : detail::immovable {
     requires std::is_invocable_r_v<bool, Fn>
   auto isr(const socket_dialog &socket, Fn routine) -> void;
 
-  /** @brief Runs the event loop. */
+  /**
+   * @brief Defers a routine to the end of the current event loop
+   * iteration.
+   * @details Deferred routines run once all of the events returned by the
+   * current poll have been handled, and before the timers are resolved.
+   * This lets work that is produced by many events in the same iteration
+   * be handled together. `defer` must only be called from the thread that
+   * runs the event loop.
+   *
+   * Only `run` and `run_deferred` run deferred routines. An event loop
+   * that is driven manually, by calling `poller.wait_for` and
+   * `timers.resolve` directly, must also call `run_deferred` after each
+   * wait, or deferred routines, such as the flushes of `service_batch`
+   * stream handlers, never run.
+   * @tparam Fn A callable type.
+   * @param routine The routine to run.
+   */
+  template <typename Fn>
+    requires std::is_invocable_v<Fn>
+  auto defer(Fn &&routine) -> void;
+
+  /**
+   * @brief Runs all deferred routines.
+   * @details Routines that are deferred by a running routine are run in
+   * the next event loop iteration.
+   * @returns true if any deferred routine ran, false otherwise.
+   */
+  inline auto run_deferred() -> bool;
+
+  /**
+   * @brief Runs the event loop.
+   * @details The loop returns once the poller is empty and no deferred
+   * routines are left to run.
+   */
   inline auto run() -> void;
 };
 
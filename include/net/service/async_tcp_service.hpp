@@ -19,6 +19,21 @@
 #ifndef CPPNET_ASYNC_TCP_SERVICE_HPP
 #define CPPNET_ASYNC_TCP_SERVICE_HPP
 #include "async_context.hpp"
+#include "connection.hpp"
+#include "metrics.hpp"
+#include "net/detail/buffer_ring.hpp"
+#include "net/detail/immovable.hpp"
+#include "pacer.hpp"
+#include "pipeline.hpp"
+#include "request_lifecycle.hpp"
+#include "shared_buffer.hpp"
+#include "shared_listener.hpp"
+
+#include <deque>
+#include <mutex>
+#include <ranges>
+#include <unordered_map>
+#include <vector>
 namespace net::service {
 /**
  * @brief A ServiceLike Async TCP Service.
@@ -37,6 +52,63 @@ namespace net::service {
  * that can be used to gracefully drain and stop TCP connections upon receiving
  * a terminate signal. See `noop_service` below for an example of how to
  * specialize async_tcp_service.
+ *
+ * StreamHandler may also declare two optional `static constexpr std::size_t`
+ * members that tune the service for many short-lived connections:
+ * - `accept_batch`: the maximum number of queued connections accepted per
+ *   listening socket readiness notification. Connections after the first
+ *   are drained from the accept queue without returning to the multiplexer.
+ * - `provided_buffers`: the number of read contexts kept in a ring shared
+ *   by every connection. A connection with no data to read does not hold a
+ *   read context; one is taken from the ring only once the socket is
+ *   readable, and it returns to the ring when the stream handler releases
+ *   it.
+ *
+ * Instead of `service`, StreamHandler may define
+ * `service_batch(async_context &ctx, std::span<read_event> events)`. Reads
+ * that complete in the same event loop iteration, across all connections,
+ * are then delivered to `service_batch` together at the end of the
+ * iteration, in the order in which they completed. Each event carries the
+ * same arguments that `service` would have received.
+ *
+ * A service constructed from a shared_listener accepts on a listening
+ * socket that is shared with services on other async contexts, instead of
+ * binding its own. The services take turns to accept connections. Only
+ * the first service to start initializes the shared socket.
+ *
+ * A StreamHandler that has a `pacing` member of type `pacer` paces
+ * `broadcast` with a token bucket per connection. Sends that exceed a
+ * connection's rate are queued and released on the timers of the async
+ * context rather than dropped. A connection's bucket and queued sends are
+ * dropped when it closes. Writes made through a `connection` are not
+ * paced.
+ *
+ * A StreamHandler that has a `metrics` member of type `tcp_metrics`
+ * counts the connections it accepts and closes, and the bytes it reads,
+ * with one relaxed atomic increment per event.
+ *
+ * A StreamHandler that has a `lifecycle` member of type
+ * `request_lifecycle` has the accept, first readable, and stream handler
+ * entry and exit of sampled requests timed. The stamps are kept in the
+ * read context, where the stream handler adds the send stamps. Read
+ * contexts from `provided_buffers` are not held by idle connections, so
+ * the first_byte phase is not timed for them.
+ *
+ * A StreamHandler that has a `middleware` member of a `pipeline` type
+ * passes every event through the pipeline's stages before `service`. The
+ * stages can forward, transform or short-circuit each event. See
+ * `pipeline` for how stages are called. Batched events are not passed
+ * through the stages, so a StreamHandler with `middleware` can't define
+ * `service_batch`.
+ *
+ * Instead of `service`, StreamHandler may define
+ * `handle(connection &conn) -> task<void>`. Each accepted connection is
+ * then served by one `handle` coroutine that awaits `conn.read`,
+ * `conn.write` and `conn.sleep`, and the connection is closed when the
+ * coroutine returns. The connection and the coroutine frame are
+ * allocated from the `frame_pool`, and no sender is spawned per
+ * operation. `provided_buffers`, `service_batch`, `metrics` and
+ * `lifecycle` do not apply to coroutine handlers.
  * @code
  * struct noop_service : public async_tcp_service<noop_service>
  * {
@@ -70,7 +142,7 @@ namespace net::service {
  */
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
 template <typename TCPStreamHandler, std::size_t Size = 64 * 1024UL>
-class async_tcp_service {
+class async_tcp_service : net::detail::immovable {
 public:
   /** @brief Templated socket address type. */
   template <typename T> using socket_address = io::socket::socket_address<T>;
@@ -100,6 +172,18 @@ public:
     std::span<std::byte> buffer{read_buffer};
     /** @brief The read socket message. */
     socket_message msg{.buffers = buffer};
+    /** @brief The lifecycle stamps of the connection's current request. */
+    request_lifecycle::stamps stamps{};
+  };
+
+  /** @brief A read event delivered to `StreamHandler::service_batch`. */
+  struct read_event {
+    /** @brief The socket the bytes in buf were read from. */
+    socket_dialog socket;
+    /** @brief The read context. Empty if the socket was closed. */
+    std::shared_ptr<read_context> rctx;
+    /** @brief The data read from the socket. */
+    std::span<const std::byte> buf;
   };
 
   /**
@@ -121,6 +205,86 @@ public:
    */
   auto submit_recv(async_context &ctx, const socket_dialog &socket,
                    std::shared_ptr<read_context> rctx) -> void;
+  /**
+   * @brief Submits an asynchronous socket recv into a handler-owned buffer.
+   * @details The read context is rebound to `buffer` before the recv is
+   * submitted, so the span emitted to the stream handler points directly
+   * into `buffer` and no intermediate copy is made. The binding persists
+   * across subsequent calls to `submit_recv` until the read context is
+   * rebound again. Handlers that always provide their own buffers can
+   * set `Size` to 0 so that the read context carries no buffer of its own.
+   * An empty buffer is rejected, since a zero-length recv can not be told
+   * apart from the peer closing the connection.
+   * @param ctx The async context to start the reader on.
+   * @param socket the socket to read data from.
+   * @param rctx A shared pointer to a mutable read buffer.
+   * @param buffer The destination of the next read. It must remain valid
+   * until the recv completes.
+   * @returns A default constructed error code if the recv was submitted.
+   * `std::errc::no_buffer_space` if `buffer` is empty, in which case no
+   * recv is submitted and the read context is not rebound.
+   */
+  auto submit_recv(async_context &ctx, const socket_dialog &socket,
+                   std::shared_ptr<read_context> rctx,
+                   std::span<std::byte> buffer) -> std::error_code;
+  /**
+   * @brief Migrates a connection to another async context.
+   * @details `migrate` is called in place of `submit_recv`, when no other
+   * operations are pending on the connection. The connection's socket is
+   * duplicated and, once `target` resolves its timers, it is registered
+   * with the `target` poller and `service.submit_recv` re-arms it there
+   * with the same read context. The source socket dialog is released as
+   * soon as the caller drops its references to it. If `target` stops
+   * before the handoff resolves, the duplicated socket is closed and the
+   * read context is released. `target` and `service` must outlive the
+   * handoff, which holds for the context that runs `service`.
+   * @param socket The connection to migrate.
+   * @param rctx The read context of the connection.
+   * @param target The async context to migrate the connection to.
+   * @param service The stream handler that serves the connection on
+   * `target`.
+   * @returns A default constructed error code if the migration was
+   * scheduled, or `operation_canceled` if `target` has stopped. Otherwise
+   * the connection was not migrated and remains the responsibility of the
+   * caller.
+   */
+  auto migrate(const socket_dialog &socket, std::shared_ptr<read_context> rctx,
+               async_context &target,
+               TCPStreamHandler &service) -> std::error_code;
+  /**
+   * @brief Migrates the next `count` connections that re-arm a recv.
+   * @details Connections are shed from inside `submit_recv`, so busier
+   * connections are more likely to be shed. This method is thread-safe.
+   * @param target The async context to migrate connections to.
+   * @param service The stream handler that serves migrated connections on
+   * `target`.
+   * @param count The number of connections to migrate.
+   */
+  auto shed(async_context &target, TCPStreamHandler &service,
+            std::size_t count) -> void;
+  /**
+   * @brief The number of reads completed by the service.
+   * @details This method is thread-safe.
+   */
+  [[nodiscard]] auto reads() const noexcept -> std::uint64_t;
+  /**
+   * @brief Sends the same buffer to every connection in a range.
+   * @details Each connection's send queue holds a reference to `buffer`
+   * rather than a copy of its bytes, so a fanout costs one allocation
+   * regardless of the number of connections. A connection has at most
+   * one send in flight. The next buffer in its queue is sent once the
+   * previous one has been written in full, so broadcasts reach each
+   * connection whole and in the order they were made. A connection whose
+   * send fails drops its queue. `broadcast` must be called on the thread
+   * that runs `ctx`.
+   * @tparam Range An input range of socket dialogs.
+   * @param ctx The async context to send on.
+   * @param connections The connections to send the buffer to.
+   * @param buffer The buffer to send.
+   */
+  template <std::ranges::input_range Range>
+  auto broadcast(async_context &ctx, Range &&connections,
+                 const shared_buffer &buffer) -> void;
 
 protected:
   /** @brief Default constructor. */
@@ -132,17 +296,45 @@ protected:
    */
   template <typename T>
   explicit async_tcp_service(socket_address<T> address) noexcept;
+  /**
+   * @brief Shared listener constructor.
+   * @param listener The listener to accept connections on.
+   */
+  explicit async_tcp_service(shared_listener &listener) noexcept;
 
 private:
   /** @brief The native socket type. */
   using socket_type = io::socket::native_socket_type;
 
+  /** @brief The buffers queued to be sent on a connection. */
+  struct send_queue {
+    /** @brief The buffers, in send order. The front one is in flight. */
+    std::deque<shared_buffer> buffers;
+    /** @brief The number of bytes of the front buffer already sent. */
+    std::size_t offset = 0;
+  };
+
   /**
    * @brief Accept new connections on a listening socket.
    * @param ctx The async context to start the acceptor on.
    * @param socket The socket to listen for connections on.
    */
   auto acceptor(async_context &ctx, const socket_dialog &socket) -> void;
+  /**
+   * @brief Waits for the next connection after one has been accepted.
+   * @details A service on a shared listener passes the accept token on
+   * instead of accepting again itself.
+   * @param ctx The async context to restart the acceptor on.
+   * @param socket The socket to listen for connections on.
+   */
+  auto rearm_(async_context &ctx, const socket_dialog &socket) -> void;
+  /**
+   * @brief Joins the shared listener.
+   * @param ctx The async context to accept connections on.
+   * @return A default constructed error code if successful, otherwise a system
+   * error code.
+   */
+  [[nodiscard]] auto join_(async_context &ctx) -> std::error_code;
   /**
    * @brief Emits a span of bytes buf read from socket that must be handled by
    * the derived stream handler.
@@ -168,6 +360,100 @@ private:
   [[nodiscard]] auto
   initialize_(const socket_handle &socket) -> std::error_code;
 
+  /**
+   * @brief Serves a newly accepted connection.
+   * @details Starts a `handle` coroutine for the connection if the stream
+   * handler is a coroutine handler, and otherwise emits the connection to
+   * the stream handler with a new read context.
+   * @param ctx The async context to serve the connection on.
+   * @param socket The accepted connection.
+   */
+  auto accepted_(async_context &ctx, const socket_dialog &socket) -> void;
+  /**
+   * @brief Accepts connections that are already queued on the acceptor
+   * socket, up to `StreamHandler::accept_batch - 1` of them.
+   * @param ctx The async context to emit the accepted connections on.
+   * @param socket The socket to accept connections on.
+   */
+  auto accept_queued(async_context &ctx, const socket_dialog &socket) -> void;
+  /**
+   * @brief Submits an asynchronous socket recv into the read context.
+   * @details The read context's buffer must not be empty.
+   * @param ctx The async context to start the reader on.
+   * @param socket the socket to read data from.
+   * @param rctx A shared pointer to a mutable read buffer.
+   */
+  auto recv_(async_context &ctx, const socket_dialog &socket,
+             std::shared_ptr<read_context> rctx) -> void;
+  /**
+   * @brief Appends a shared buffer to a connection's send queue, and
+   * starts sending it if the connection has no send in flight.
+   * @param ctx The async context to send on.
+   * @param socket The connection to send the buffer to.
+   * @param buffer The buffer to send.
+   */
+  auto enqueue_(async_context &ctx, const socket_dialog &socket,
+                const shared_buffer &buffer) -> void;
+  /**
+   * @brief Sends the rest of the buffer at the front of a connection's
+   * send queue.
+   * @param ctx The async context to send on.
+   * @param socket The connection to send to.
+   * @param queue The send queue of the connection.
+   */
+  auto send_(async_context &ctx, const socket_dialog &socket,
+             const send_queue &queue) -> void;
+  /** @returns Whether the stream handler paces its sends. */
+  static constexpr auto pacing_() noexcept -> bool;
+  /**
+   * @brief Identifies the pacing flow of a connection.
+   * @details Flows are keyed by the socket handle rather than the
+   * descriptor, which the kernel reuses as soon as a connection closes.
+   * @param socket The connection.
+   * @returns The flow identifier.
+   */
+  static auto flow_(const socket_dialog &socket) noexcept -> pacer::flow_type;
+  /** @returns Whether the stream handler counts tcp_metrics. */
+  static constexpr auto metrics_() noexcept -> bool;
+  /** @returns Whether the stream handler times request lifecycles. */
+  static constexpr auto lifecycle_() noexcept -> bool;
+  /** @returns Whether the stream handler serves connections with `handle`. */
+  static constexpr auto coroutine_() noexcept -> bool;
+  /** @returns Whether the stream handler has a middleware pipeline. */
+  static constexpr auto middleware_() noexcept -> bool;
+  /**
+   * @brief Calls the stream handler, through its middleware if it has any.
+   * @param ctx The async context.
+   * @param socket The socket the bytes in buf were read from.
+   * @param rctx The read context.
+   * @param buf The data read from the socket.
+   */
+  auto dispatch_(async_context &ctx, const socket_dialog &socket,
+                 std::shared_ptr<read_context> rctx,
+                 std::span<const std::byte> buf) -> void;
+  /**
+   * @brief Migrates the connection if connections are being shed.
+   * @param ctx The async context the connection is currently served on.
+   * @param socket The connection.
+   * @param rctx The read context of the connection.
+   * @returns true if the connection was migrated.
+   */
+  auto shed_(async_context &ctx, const socket_dialog &socket,
+             const std::shared_ptr<read_context> &rctx) -> bool;
+  /**
+   * @brief Makes a read context for a connection.
+   * @returns A read context from the buffer ring if the stream handler
+   * requests provided buffers, otherwise a newly allocated read context.
+   */
+  auto make_read_context() -> std::shared_ptr<read_context>;
+
+  /**
+   * @brief Delivers the read events batched during the last event loop
+   * iteration to `StreamHandler::service_batch`.
+   * @param ctx The async context the events were read on.
+   */
+  auto flush_(async_context &ctx) -> void;
+
   /** @brief Stop the service. */
   auto stop_() -> void;
   /**
@@ -178,6 +464,37 @@ private:
   socket_address<sockaddr_in6> address_;
   /** @brief The native acceptor socket handle. */
   std::atomic<socket_type> acceptor_sockfd_ = io::socket::INVALID_SOCKET;
+  /** @brief The shared listener, if the service accepts on one. */
+  shared_listener *listener_ = nullptr;
+  /** @brief The provided buffer ring. */
+  net::detail::buffer_ring<read_context> buffers_;
+  /** @brief The buffer that readable sockets are peeked into. */
+  std::array<std::byte, 1> peek_buffer_{};
+  /**
+   * @brief The socket message that readable sockets are peeked into.
+   * @note The message refers to peek_buffer_, which is why the service is
+   * immovable.
+   */
+  io::socket::socket_message<> peek_msg_{.buffers = peek_buffer_};
+  /** @brief The number of reads completed by the service. */
+  std::atomic<std::uint64_t> reads_{0};
+  /** @brief The number of connections left to shed. */
+  std::atomic<std::size_t> shed_count_{0};
+  /** @brief The context and stream handler to shed connections to. */
+  std::pair<async_context *, TCPStreamHandler *> shed_to_{};
+  /** @brief Mutex for thread-safety. */
+  std::mutex mtx_;
+  /** @brief Read events waiting for the end of the loop iteration. */
+  std::vector<read_event> batch_;
+  /** @brief Sampled read contexts of the batch being serviced. */
+  std::vector<std::shared_ptr<read_context>> sampled_;
+  /**
+   * @brief The send queues of connections with a send in flight, keyed
+   * by their socket handle.
+   * @details The send in flight keeps the socket handle alive, so a key
+   * can not be reused by another connection while its queue exists.
+   */
+  std::unordered_map<const socket_handle *, send_queue> sends_;
 };
 
 } // namespace net::service
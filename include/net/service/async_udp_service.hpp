@@ -19,6 +19,19 @@
 #ifndef CPPNET_ASYNC_UDP_SERVICE_HPP
 #define CPPNET_ASYNC_UDP_SERVICE_HPP
 #include "async_context.hpp"
+#include "latency_histogram.hpp"
+#include "net/detail/buffer_ring.hpp"
+#include "net/detail/immovable.hpp"
+#include "pacer.hpp"
+#include "pipeline.hpp"
+#include "session_table.hpp"
+#include "shared_buffer.hpp"
+
+#include <chrono>
+#include <ranges>
+#include <vector>
+
+#include <sys/socket.h>
 namespace net::service {
 /**
  * @brief A ServiceLike Async UDP Service.
@@ -35,6 +48,78 @@ namespace net::service {
  * reader to restart the read loop. It also optionally specifies an initialize
  * member that can be used to configure the service socket. See `noop_service`
  * below for an example of how to specialize async_udp_service.
+ *
+ * StreamHandler may declare a `static constexpr std::size_t recv_batch`
+ * member to receive datagrams in batches. The service then keeps a pool of
+ * `recv_batch` read contexts, one per datagram slot. Each time the socket
+ * becomes readable, a single recvmmsg fills every free slot, and each
+ * datagram is emitted with its own read context and peer address. A slot
+ * returns to the pool when the stream handler passes its read context back
+ * to `submit_recv`. Each slot holds a `Size` byte buffer, so batched
+ * services usually also choose a smaller `Size`.
+ *
+ * StreamHandler may instead declare a `static constexpr std::size_t
+ * provided_buffers` member to receive continuously. The service then
+ * re-arms the socket as soon as each datagram is read, before the datagram
+ * is emitted, so the socket keeps draining while the stream handler holds
+ * earlier datagrams or does asynchronous work with them. The stream
+ * handler does not call `submit_recv`. Read contexts come from a ring of
+ * `provided_buffers` contexts, and a context returns to the ring when the
+ * stream handler releases its last reference to it. If every context in
+ * the ring is held, transient contexts are allocated until one is
+ * released.
+ *
+ * A StreamHandler that has a `sessions` member of type
+ * `session_table<State>` is given the session of each datagram's peer. It
+ * then defines `service` with a fifth `State *session` parameter, which is
+ * nullptr for the events that carry no read context. Sessions that are
+ * idle for longer than the table's timeout are expired on the timers of
+ * the async context that the service was started on.
+ *
+ * A StreamHandler that has a `middleware` member of a `pipeline` type
+ * passes every datagram through the pipeline's stages before `service`,
+ * with the session as the last argument if the handler has sessions. The
+ * stages can forward, transform or short-circuit each datagram. See
+ * `pipeline` for how stages are called. Batched datagrams are not passed
+ * through the stages, so a StreamHandler with `middleware` can't define
+ * `service_batch`.
+ *
+ * StreamHandler may also declare `static constexpr bool udp_gro = true` to
+ * enable UDP generic receive offload. The kernel may then coalesce
+ * consecutive datagrams from the same peer into one read of up to 64KiB,
+ * and `read_context::segment_size` holds the size of the coalesced
+ * datagrams. Every datagram but the last in such a read is exactly
+ * `segment_size` bytes long. The read buffer `Size` must be at least
+ * 65535 bytes with `udp_gro`, so that a coalesced read is never
+ * truncated. In the other direction, `send_segments` uses
+ * UDP generic segmentation offload to send one buffer as many datagrams.
+ *
+ * The service keeps statistics that can be read from any thread with
+ * `statistics()`. StreamHandler may declare `static constexpr bool
+ * rxq_overflow = true` to enable SO_RXQ_OVFL, so that the number of
+ * datagrams the kernel dropped because the socket receive buffer was full
+ * is counted in `statistics().drops`. It may also declare `static
+ * constexpr bool rx_timestamps = true` to enable SO_TIMESTAMPNS. Each read
+ * context then carries the kernel receive time of its datagram, and the
+ * time from the kernel receiving a datagram to the stream handler being
+ * called with it is recorded in `statistics().latency`. Growing drops
+ * point at socket buffer exhaustion, while growing latency points at a
+ * lagging event loop. Either option receives with recvmmsg.
+ *
+ * A StreamHandler that has a `pacing` member of type `pacer` paces
+ * `broadcast` and `send_segments` with a token bucket per destination.
+ * Sends that exceed a destination's rate are queued and released on the
+ * timers of the async context rather than dropped. Replies queued with
+ * `reply` are not paced, because a reply holds its read context until it
+ * is sent.
+ *
+ * Instead of `service`, StreamHandler may define
+ * `service_batch(async_context &ctx, std::span<read_event> events)`.
+ * Datagrams that are read in the same event loop iteration are then
+ * delivered to `service_batch` together at the end of the iteration, in
+ * the order in which they were read. Each event carries the same arguments
+ * that `service` would have received. A read event has no session, so a
+ * StreamHandler with `sessions` can't define `service_batch`.
  * @code
  * struct noop_service : public async_udp_service<noop_service>
  * {
@@ -63,7 +148,7 @@ namespace net::service {
  */
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
 template <typename UDPStreamHandler, std::size_t Size = 64 * 1024UL>
-class async_udp_service {
+class async_udp_service : net::detail::immovable {
 public:
   /** @brief Templated socket address type. */
   template <typename T> using socket_address = io::socket::socket_address<T>;
@@ -103,6 +188,44 @@ public:
     std::span<std::byte> buffer{read_buffer};
     /** @brief The read socket message. */
     socket_message msg{.address = socket_address{}, .buffers = buffer};
+    /**
+     * @brief The size of the datagrams that the kernel coalesced into
+     * the last read, or 0 if the read holds a single datagram.
+     */
+    std::size_t segment_size = 0;
+    /**
+     * @brief The time at which the kernel received the datagram, if the
+     * stream handler enables rx_timestamps.
+     */
+    std::chrono::system_clock::time_point timestamp;
+  };
+
+  /** @brief The service statistics. */
+  struct statistics_type {
+    /** @brief The number of datagrams received. */
+    std::atomic<std::uint64_t> datagrams = 0;
+    /**
+     * @brief The number of datagrams dropped by the kernel because the
+     * socket receive buffer was full, if the stream handler enables
+     * rxq_overflow.
+     */
+    std::atomic<std::uint64_t> drops = 0;
+    /**
+     * @brief The latency from the kernel receiving a datagram to the
+     * stream handler being called with it, if the stream handler enables
+     * rx_timestamps.
+     */
+    latency_histogram latency;
+  };
+
+  /** @brief A read event delivered to `StreamHandler::service_batch`. */
+  struct read_event {
+    /** @brief The socket the bytes in buf were read from. */
+    socket_dialog socket;
+    /** @brief The read context. Empty if the socket was closed. */
+    std::shared_ptr<read_context> rctx;
+    /** @brief The data read from the socket. */
+    std::span<const std::byte> buf;
   };
 
   /**
@@ -118,12 +241,80 @@ public:
   auto start(async_context &ctx) noexcept -> std::error_code;
   /**
    * @brief Submits an asynchronous socket recv.
+   * @details If the stream handler declares `provided_buffers`, the
+   * service receives continuously and this only releases rctx.
    * @param ctx The async context to start the reader on.
    * @param socket the socket to read data from.
    * @param rctx A shared pointer to a mutable read buffer.
    */
   auto submit_recv(async_context &ctx, const socket_dialog &socket,
                    std::shared_ptr<read_context> rctx) -> void;
+  /**
+   * @brief Sends the same buffer to every peer in a range.
+   * @details Every send holds a reference to `buffer` rather than a copy
+   * of its bytes, so a fanout costs one allocation regardless of the
+   * number of peers. Failed sends are dropped.
+   * @tparam Range An input range of `socket_address<sockaddr_in6>` peers,
+   * such as the addresses of previously received read contexts.
+   * @param ctx The async context to send on.
+   * @param socket The socket to send the datagrams from.
+   * @param peers The peers to send the buffer to.
+   * @param buffer The buffer to send.
+   */
+  template <std::ranges::input_range Range>
+  auto broadcast(async_context &ctx, const socket_dialog &socket,
+                 Range &&peers, const shared_buffer &buffer) -> void;
+  /**
+   * @brief Sends a buffer to a peer as datagrams of segment_size bytes.
+   * @details The buffer is handed to the kernel in as few sendmsg calls
+   * as possible with the UDP_SEGMENT option, and the kernel splits it into
+   * datagrams. The last datagram may be shorter than segment_size. If the
+   * kernel does not support segmentation offload, or the socket would
+   * block, the datagrams of that sendmsg are sent one at a time instead.
+   * Failed sends are dropped.
+   *
+   * The segmented sendmsg is a non-blocking ::sendmsg made directly on
+   * the calling thread, because it needs a control message that the io
+   * wrappers do not pass through. It therefore bypasses io::sendmsg, and
+   * anything that intercepts it, such as a mock; only the fallback
+   * datagrams are sent asynchronously through io::sendmsg.
+   * @param ctx The async context to send on.
+   * @param socket The socket to send the datagrams from.
+   * @param peer The peer to send the datagrams to.
+   * @param buffer The buffer to send.
+   * @param segment_size The size of each datagram.
+   */
+  auto send_segments(async_context &ctx, const socket_dialog &socket,
+                     const socket_address<sockaddr_in6> &peer,
+                     const shared_buffer &buffer,
+                     std::size_t segment_size) -> void;
+  /**
+   * @brief Queues a reply to the peer that a read context was read from.
+   * @details Replies queued during an event loop iteration are sent
+   * together with sendmmsg at the end of the iteration. If the socket
+   * send buffer fills up, the rest of the queue is sent once the socket
+   * is writable again. Once its reply has been sent, or has failed, the
+   * read context is passed back to `submit_recv`.
+   *
+   * A queued reply holds its read context. A service that reads into a
+   * single read context reads nothing else until its reply is sent, so
+   * its queue never holds more than one reply. Replies are only batched
+   * into one sendmmsg when the service has many read contexts, with
+   * `recv_batch` or `provided_buffers`.
+   * @param ctx The async context to send on.
+   * @param socket The socket to send the reply from.
+   * @param rctx The read context of the request.
+   * @param buf The reply. It must stay valid until the read context is
+   * passed back to `submit_recv`, for example by pointing into its buffer.
+   */
+  auto reply(async_context &ctx, const socket_dialog &socket,
+             std::shared_ptr<read_context> rctx,
+             std::span<const std::byte> buf) -> void;
+  /**
+   * @returns The service statistics. They are updated on the event loop
+   * and may be read from any thread.
+   */
+  [[nodiscard]] auto statistics() const noexcept -> const statistics_type &;
 
 protected:
   /** @brief Default constructor. */
@@ -165,6 +356,114 @@ private:
   [[nodiscard]] auto
   initialize_(const socket_handle &socket) -> std::error_code;
 
+  /**
+   * @returns The number of datagram slots that each recvmmsg receives
+   * into, or 0 if the service receives with io::recvmsg.
+   */
+  static constexpr auto recv_slots_() noexcept -> std::size_t;
+  /** @returns Whether the stream handler enables UDP_GRO. */
+  static constexpr auto gro_() noexcept -> bool;
+  /** @returns Whether the stream handler enables SO_RXQ_OVFL. */
+  static constexpr auto rxq_overflow_() noexcept -> bool;
+  /** @returns Whether the stream handler enables SO_TIMESTAMPNS. */
+  static constexpr auto rx_timestamps_() noexcept -> bool;
+  /** @returns Whether the stream handler paces its sends. */
+  static constexpr auto pacing_() noexcept -> bool;
+  /** @returns Whether the stream handler has a session table. */
+  static constexpr auto sessions_() noexcept -> bool;
+  /** @returns Whether the stream handler has a middleware pipeline. */
+  static constexpr auto middleware_() noexcept -> bool;
+  /**
+   * @brief Calls the stream handler, through its middleware if it has any.
+   * @tparam Args The argument types of `service`.
+   * @param args The arguments of `service`.
+   */
+  template <typename... Args> auto dispatch_(Args &&...args) -> void;
+  /**
+   * @brief Sends len bytes of a buffer from offset with one synchronous
+   * UDP_SEGMENT ::sendmsg, or as separate datagrams if that fails.
+   * @param ctx The async context to send on.
+   * @param socket The socket to send the datagrams from.
+   * @param peer The peer to send the datagrams to.
+   * @param buffer The buffer to send.
+   * @param offset The offset of the bytes to send.
+   * @param len The number of bytes to send.
+   * @param segment_size The size of each datagram.
+   */
+  auto send_segment_(async_context &ctx, const socket_dialog &socket,
+                     const socket_address<sockaddr_in6> &peer,
+                     const shared_buffer &buffer, std::size_t offset,
+                     std::size_t len, std::size_t segment_size) -> void;
+  /**
+   * @brief Sends a buffer from offset to end as datagrams of
+   * segment_size bytes, one asynchronous sendmsg per datagram.
+   * @param ctx The async context to send on.
+   * @param socket The socket to send the datagrams from.
+   * @param peer The peer to send the datagrams to.
+   * @param buffer The buffer to send.
+   * @param offset The offset of the first datagram.
+   * @param end The offset of the end of the last datagram.
+   * @param segment_size The size of each datagram.
+   */
+  auto send_datagrams_(async_context &ctx, const socket_dialog &socket,
+                       const socket_address<sockaddr_in6> &peer,
+                       const shared_buffer &buffer, std::size_t offset,
+                       std::size_t end, std::size_t segment_size) -> void;
+  /**
+   * @brief Receives one datagram into a read context from the ring, and
+   * receives the next one as soon as it completes.
+   * @param ctx The async context to start the reader on.
+   * @param socket The socket to read datagrams from.
+   */
+  auto recv_(async_context &ctx, const socket_dialog &socket) -> void;
+  /**
+   * @brief Waits for the socket to become readable, then receives into
+   * the free datagram slots.
+   * @param ctx The async context to start the reader on.
+   * @param socket The socket to read datagrams from.
+   */
+  auto recv_batch_(async_context &ctx, const socket_dialog &socket) -> void;
+  /**
+   * @brief Receives up to one datagram per free slot with recvmmsg and
+   * emits each datagram that was received.
+   * @param ctx The async context.
+   * @param socket The readable socket.
+   */
+  auto recvmmsg_(async_context &ctx, const socket_dialog &socket) -> void;
+  /**
+   * @brief Records the latency from the kernel receiving a datagram to
+   * now, if the stream handler enables rx_timestamps.
+   * @param rctx The read context of the datagram.
+   */
+  auto record_latency_(const read_context &rctx) noexcept -> void;
+
+  /**
+   * @brief Sends the queued replies with sendmmsg until the queue is
+   * empty or the socket would block.
+   * @param ctx The async context to send on.
+   */
+  auto flush_replies_(async_context &ctx) -> void;
+  /**
+   * @brief Waits for the socket to become writable by sending the first
+   * queued reply asynchronously, then flushes the rest.
+   * @param ctx The async context to send on.
+   */
+  auto await_writable_(async_context &ctx) -> void;
+  /**
+   * @brief Passes the read context of the first count replies back to
+   * `submit_recv` and removes them from the queue.
+   * @param ctx The async context.
+   * @param count The number of replies to complete.
+   */
+  auto complete_replies_(async_context &ctx, std::size_t count) -> void;
+
+  /**
+   * @brief Delivers the read events batched during the last event loop
+   * iteration to `StreamHandler::service_batch`.
+   * @param ctx The async context the events were read on.
+   */
+  auto flush_(async_context &ctx) -> void;
+
   /** @brief Stop the service. */
   auto stop_() -> void;
   /**
@@ -175,6 +474,44 @@ private:
   socket_address<sockaddr_in6> address_;
   /** @brief The native server socket handle. */
   std::atomic<socket_type> server_sockfd_ = io::socket::INVALID_SOCKET;
+  /** @brief The service statistics. */
+  statistics_type statistics_;
+  /** @brief Read events waiting for the end of the loop iteration. */
+  std::vector<read_event> batch_;
+  /** @brief A queued reply. */
+  struct reply_type {
+    /** @brief The socket to send the reply from. */
+    socket_dialog socket;
+    /** @brief The read context of the request. */
+    std::shared_ptr<read_context> rctx;
+    /** @brief The reply. */
+    std::span<const std::byte> buf;
+  };
+
+  /** @brief The provided buffer ring. */
+  net::detail::buffer_ring<read_context> buffers_;
+  /** @brief Replies waiting to be sent. */
+  std::vector<reply_type> replies_;
+  /** @brief Replies that have been sent and are being completed. */
+  std::vector<reply_type> sent_;
+  /** @brief The message headers of the last sendmmsg. */
+  std::vector<mmsghdr> reply_headers_;
+  /** @brief The buffers of the last sendmmsg. */
+  std::vector<iovec> reply_iovecs_;
+  /** @brief Whether the reply queue is waiting for the socket. */
+  bool blocked_ = false;
+  /** @brief The free datagram slots for batched receives. */
+  std::vector<std::shared_ptr<read_context>> slots_;
+  /** @brief Whether a batched receive is waiting for the socket. */
+  bool reading_ = false;
+  /** @brief The buffer that the readable socket is peeked into. */
+  std::array<std::byte, 1> peek_buffer_{};
+  /**
+   * @brief The socket message that the readable socket is peeked into.
+   * @note The message refers to peek_buffer_, which is why the service is
+   * immovable.
+   */
+  io::socket::socket_message<> peek_msg_{.buffers = peek_buffer_};
 };
 
 } // namespace net::service
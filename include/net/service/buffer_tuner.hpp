@@ -0,0 +1,140 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file buffer_tuner.hpp
+ * @brief This file declares a socket buffer size controller.
+ */
+#pragma once
+#ifndef CPPNET_BUFFER_TUNER_HPP
+#define CPPNET_BUFFER_TUNER_HPP
+#include "async_context.hpp"
+#include "net/detail/tcp_info.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <vector>
+namespace net::service {
+/**
+ * @brief Sizes the socket buffers of TCP connections to their measured
+ * bandwidth-delay product.
+ * @details Connections added to the tuner are sampled periodically on the
+ * timers of an async context. Each sample reads TCP_INFO and estimates the
+ * bandwidth-delay product (BDP) of the connection as its delivery rate
+ * multiplied by its smoothed RTT. Kernels that do not report a delivery
+ * rate fall back to the congestion window multiplied by the MSS. The
+ * send and receive buffers are then set to the BDP scaled by a gain and
+ * clamped to the configured bounds. Buffers are only resized when the
+ * target moves by more than a quarter of the current size, so that
+ * connections with a stable BDP are not resized on every sample.
+ *
+ * Setting SO_RCVBUF disables the kernel's receive buffer autotuning for
+ * the connection, so the bounds should be chosen to cover the largest BDP
+ * that is expected. Connections are released when they close. The tuner
+ * must only be used on the thread that runs the async context.
+ * @code
+ * auto tuner = buffer_tuner(ctx, {.max_buffer = 32UL * 1024 * 1024});
+ * // In the stream handler, when a connection is accepted:
+ * tuner.add(socket);
+ * @endcode
+ */
+class buffer_tuner {
+public:
+  /** @brief The async context type. */
+  using async_context = service::async_context;
+  /** @brief The socket dialog type. */
+  using socket_dialog = async_context::socket_dialog;
+  /** @brief The sample interval type. */
+  using duration = timers::duration;
+
+  /** @brief The tuner configuration. */
+  struct config {
+    /** @brief The smallest buffer size to set. */
+    std::size_t min_buffer = 64UL * 1024;
+    /** @brief The largest buffer size to set. */
+    std::size_t max_buffer = 16UL * 1024 * 1024;
+    /** @brief The BDP multiplier that leaves headroom for rate growth. */
+    double gain = 2.0;
+    /** @brief The time between samples. */
+    duration interval = std::chrono::milliseconds(100);
+  };
+
+  /**
+   * @brief Constructs a tuner with the default configuration.
+   * @param ctx The async context whose timers drive the tuner.
+   */
+  explicit buffer_tuner(async_context &ctx) noexcept;
+  /**
+   * @brief Constructs a tuner.
+   * @param ctx The async context whose timers drive the tuner.
+   * @param cfg The tuner configuration.
+   */
+  buffer_tuner(async_context &ctx, config cfg) noexcept;
+  /** @brief Deleted copy constructor. */
+  buffer_tuner(const buffer_tuner &other) = delete;
+  /** @brief Deleted copy assignment. */
+  auto operator=(const buffer_tuner &other) -> buffer_tuner & = delete;
+
+  /**
+   * @brief Starts tuning the buffers of a connection.
+   * @param socket The connection.
+   */
+  auto add(const socket_dialog &socket) -> void;
+  /** @brief Samples every connection and resizes its buffers. */
+  auto tune() -> void;
+  /** @returns The number of connections being tuned. */
+  [[nodiscard]] auto size() const noexcept -> std::size_t;
+
+  /**
+   * @brief Estimates the bandwidth-delay product of a connection.
+   * @param info The TCP_INFO of the connection.
+   * @param len The number of bytes of info that the kernel wrote.
+   * @returns The estimated BDP in bytes.
+   */
+  [[nodiscard]] static auto bdp(const net::detail::tcp_info_ext &info,
+                                std::size_t len) noexcept -> std::size_t;
+
+  /** @brief Stops the sample timer. */
+  ~buffer_tuner();
+
+private:
+  /** @brief A tuned connection. */
+  struct connection {
+    /** @brief The connection socket. */
+    std::weak_ptr<io::socket::socket_handle> socket;
+    /** @brief The buffer size last set on the connection. */
+    std::size_t buffer = 0;
+  };
+
+  /**
+   * @brief Samples one connection and resizes its buffers.
+   * @param conn The connection.
+   * @returns false if the connection could not be sampled.
+   */
+  auto tune_(connection &conn) const noexcept -> bool;
+
+  /** @brief The async context. */
+  async_context *ctx_;
+  /** @brief The tuner configuration. */
+  config config_;
+  /** @brief The tuned connections. */
+  std::vector<connection> connections_;
+  /** @brief The sample timer. */
+  timers::timer_id timer_ = timers::INVALID_TIMER;
+};
+
+} // namespace net::service
+
+#include "impl/buffer_tuner_impl.hpp" // IWYU pragma: export
+#endif                                // CPPNET_BUFFER_TUNER_HPP
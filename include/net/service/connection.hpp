@@ -0,0 +1,402 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file connection.hpp
+ * @brief This file declares a connection served by a coroutine.
+ */
+#pragma once
+#ifndef CPPNET_CONNECTION_HPP
+#define CPPNET_CONNECTION_HPP
+#include "async_context.hpp"
+#include "net/detail/immovable.hpp"
+#include "net/detail/manual_lifetime.hpp"
+#include "task.hpp"
+
+#include <array>
+#include <chrono>
+#include <coroutine>
+#include <span>
+#include <system_error>
+namespace net::service {
+/**
+ * @brief A connection that is served by one coroutine.
+ * @details The awaitables returned by `read`, `write` and `sleep` suspend
+ * the coroutine until the operation completes. Each io operation is
+ * connected directly to a receiver that resumes the coroutine, and its
+ * operation state lives in the awaiter, inside the coroutine frame, so
+ * awaiting an operation does not allocate. A failed operation sets
+ * `error`. Operations, including sleeps, are cancelled with
+ * operation_canceled when the async scope of the context is stopped, so a
+ * coroutine parked on a connection still runs to completion and frees it
+ * when the context shuts down.
+ *
+ * The connection and its coroutine frame are allocated from the
+ * `frame_pool`, so a thread that serves many short-lived connections
+ * reuses the same few blocks.
+ * @code
+ * auto handle(connection &conn) -> task<void>
+ * {
+ *   auto buf = std::array<std::byte, 1024>{};
+ *   while (auto len = co_await conn.read(buf))
+ *   {
+ *     if (co_await conn.write(std::span(buf).first(len)) < len)
+ *       co_return;
+ *   }
+ * }
+ * @endcode
+ */
+class connection : net::detail::immovable {
+public:
+  /** @brief The socket dialog type. */
+  using socket_dialog = async_context::socket_dialog;
+  /** @brief The socket message type. */
+  using socket_message = io::socket::socket_message<>;
+  /** @brief The sleep duration type. */
+  using duration = async_context::clock::duration;
+
+  /**
+   * @brief Resumes an awaiter when its io operation completes.
+   * @tparam Awaiter The awaiter type.
+   */
+  template <typename Awaiter> struct receiver {
+    /** @brief The receiver concept. */
+    using receiver_concept = stdexec::receiver_t;
+
+    /** @brief The receiver environment. */
+    struct env {
+      /** @returns The stop token of the async scope. */
+      [[nodiscard]] auto query(stdexec::get_stop_token_t) const noexcept
+          -> stdexec::inplace_stop_token;
+
+      /** @brief The async context. */
+      async_context *ctx;
+    };
+
+    /**
+     * @brief Completes the operation with a length.
+     * @tparam Length The length type.
+     * @param len The number of bytes transferred.
+     */
+    template <typename Length> auto set_value(Length len) && noexcept -> void;
+    /**
+     * @brief Completes the operation with an error.
+     * @tparam Error The error type.
+     * @param error The error.
+     */
+    template <typename Error> auto set_error(Error error) && noexcept -> void;
+    /** @brief Completes a cancelled operation. */
+    auto set_stopped() && noexcept -> void;
+    /** @returns The receiver environment. */
+    [[nodiscard]] auto get_env() const noexcept -> env;
+
+    /** @brief The awaiter. */
+    Awaiter *awaiter;
+    /** @brief The async context. */
+    async_context *ctx;
+  };
+
+  /** @brief Awaits a read. */
+  class read_awaiter : net::detail::immovable {
+  public:
+    /**
+     * @brief Constructs a read awaiter.
+     * @param conn The connection.
+     * @param buffer The buffer to read into.
+     */
+    read_awaiter(connection &conn, std::span<std::byte> buffer) noexcept;
+    /** @brief Destroys the operation state. */
+    ~read_awaiter();
+
+    /** @returns false. */
+    [[nodiscard]] static auto await_ready() noexcept -> bool;
+    /**
+     * @brief Starts the read.
+     * @param handle The awaiting coroutine.
+     * @returns false if the read completed inside start(), so that the
+     * coroutine continues without being resumed from the completion.
+     */
+    auto await_suspend(std::coroutine_handle<> handle) -> bool;
+    /** @returns The number of bytes read. Zero on EOF or error. */
+    [[nodiscard]] auto await_resume() const noexcept -> std::size_t;
+
+    /**
+     * @brief Completes the read.
+     * @param len The number of bytes read.
+     */
+    auto complete(std::size_t len) noexcept -> void;
+    /**
+     * @brief Fails the read.
+     * @param error The error.
+     */
+    auto fail(std::error_code error) noexcept -> void;
+
+  private:
+    /** @brief The sender type. */
+    using sender_type = decltype(io::recvmsg(
+        std::declval<const socket_dialog &>(),
+        std::declval<socket_message &>(), 0));
+    /** @brief The operation state type. */
+    using operation_type =
+        stdexec::connect_result_t<sender_type, receiver<read_awaiter>>;
+
+    /** @brief The connection. */
+    connection *conn_;
+    /** @brief The read socket message. */
+    socket_message msg_;
+    /** @brief The number of bytes read. */
+    std::size_t len_ = 0;
+    /** @brief The awaiting coroutine. */
+    std::coroutine_handle<> handle_;
+    /** @brief Whether the read is being started. */
+    bool starting_ = false;
+    /** @brief Whether the read completed while it was being started. */
+    bool finished_ = false;
+    /** @brief Whether the operation state has been constructed. */
+    bool started_ = false;
+    /** @brief The operation state. */
+    net::detail::manual_lifetime<operation_type> op_;
+  };
+
+  /** @brief Awaits a write of a whole buffer. */
+  class write_awaiter : net::detail::immovable {
+  public:
+    /**
+     * @brief Constructs a write awaiter.
+     * @param conn The connection.
+     * @param buffer The buffer to write.
+     */
+    write_awaiter(connection &conn, std::span<const std::byte> buffer) noexcept;
+    /** @brief Destroys the operation state. */
+    ~write_awaiter();
+
+    /** @returns Whether there is nothing to write. */
+    [[nodiscard]] auto await_ready() const noexcept -> bool;
+    /**
+     * @brief Starts the write.
+     * @param handle The awaiting coroutine.
+     * @returns false if the write completed inside start(), so that the
+     * coroutine continues without being resumed from the completion.
+     */
+    auto await_suspend(std::coroutine_handle<> handle) -> bool;
+    /**
+     * @returns The number of bytes written. Less than the size of the
+     * buffer on error.
+     */
+    [[nodiscard]] auto await_resume() const noexcept -> std::size_t;
+
+    /**
+     * @brief Completes a send, and sends the rest of a partial write.
+     * @param len The number of bytes sent.
+     */
+    auto complete(std::size_t len) noexcept -> void;
+    /**
+     * @brief Fails the write.
+     * @param error The error.
+     */
+    auto fail(std::error_code error) noexcept -> void;
+
+  private:
+    /** @brief The sender type. */
+    using sender_type = decltype(io::sendmsg(
+        std::declval<const socket_dialog &>(),
+        std::declval<const socket_message &>(), 0));
+    /** @brief The operation state type. */
+    using operation_type =
+        stdexec::connect_result_t<sender_type, receiver<write_awaiter>>;
+
+    /**
+     * @brief Sends the unwritten part of the buffer until a send is left
+     * in flight, or the write has finished.
+     * @details The send is made from the operation state that is not
+     * completing. Sends that complete inside start() are sent again from
+     * the same operation state in a loop rather than by recursion.
+     * @returns Whether the write finished, in which case the caller
+     * continues the coroutine.
+     */
+    auto send_() noexcept -> bool;
+    /**
+     * @brief Sends the unwritten part of the buffer from an operation
+     * state.
+     * @param slot The operation state to send from.
+     */
+    auto submit_(std::size_t slot) -> void;
+    /**
+     * @brief Finishes the write. The coroutine is resumed only if no send
+     * is being started; otherwise send_() reports that it finished.
+     * @param error The error of the write.
+     */
+    auto finish_(std::error_code error) noexcept -> void;
+
+    /** @brief The connection. */
+    connection *conn_;
+    /** @brief The buffer to write. */
+    std::span<const std::byte> buffer_;
+    /** @brief The write socket message. */
+    socket_message msg_;
+    /** @brief The number of bytes written. */
+    std::size_t written_ = 0;
+    /** @brief The awaiting coroutine. */
+    std::coroutine_handle<> handle_;
+    /** @brief The operation state of the send in flight. */
+    std::size_t slot_ = 0;
+    /** @brief Whether a send is being started. */
+    bool sending_ = false;
+    /** @brief Whether a send completed while it was being started. */
+    bool resend_ = false;
+    /** @brief Whether the write finished while a send was being started. */
+    bool finished_ = false;
+    /** @brief Whether each operation state has been constructed. */
+    std::array<bool, 2> started_{};
+    /** @brief The operation states, used in turn. */
+    std::array<net::detail::manual_lifetime<operation_type>, 2> ops_;
+  };
+
+  /** @brief Awaits a timer. */
+  class sleep_awaiter : net::detail::immovable {
+  public:
+    /**
+     * @brief Constructs a sleep awaiter.
+     * @param conn The connection.
+     * @param interval The time to sleep for.
+     */
+    sleep_awaiter(connection &conn, duration interval) noexcept;
+    /** @brief Deregisters the stop callback. */
+    ~sleep_awaiter();
+
+    /** @returns Whether there is no time to sleep for. */
+    [[nodiscard]] auto await_ready() const noexcept -> bool;
+    /**
+     * @brief Adds a timer that resumes the coroutine, and a stop callback
+     * that resumes it early if the async scope is stopped.
+     * @param handle The awaiting coroutine.
+     * @returns false if the async scope has already been stopped.
+     */
+    auto await_suspend(std::coroutine_handle<> handle) -> bool;
+    /** @brief Resumes the coroutine. */
+    static auto await_resume() noexcept -> void;
+
+  private:
+    /** @brief Cancels the sleep when the async scope is stopped. */
+    struct on_stop {
+      /** @brief Removes the timer and resumes the coroutine. */
+      auto operator()() const noexcept -> void;
+
+      /** @brief The sleep awaiter. */
+      sleep_awaiter *awaiter;
+    };
+    /** @brief The stop callback type. */
+    using stop_callback = stdexec::inplace_stop_callback<on_stop>;
+
+    /** @brief The connection. */
+    connection *conn_;
+    /** @brief The time to sleep for. */
+    duration interval_;
+    /** @brief The awaiting coroutine. */
+    std::coroutine_handle<> handle_;
+    /** @brief The timer that ends the sleep. */
+    timers::timer_id timer_ = timers::INVALID_TIMER;
+    /** @brief Whether the stop callback has been constructed. */
+    bool registered_ = false;
+    /** @brief The stop callback. */
+    net::detail::manual_lifetime<stop_callback> stop_;
+  };
+
+  /**
+   * @brief Constructs a connection.
+   * @param ctx The async context that serves the connection.
+   * @param socket The connected socket.
+   */
+  connection(async_context &ctx, socket_dialog socket) noexcept;
+  /** @brief Default destructor. */
+  ~connection() = default;
+
+  /**
+   * @brief Allocates a connection from the frame pool.
+   * @param size The size of the connection.
+   * @returns The storage for the connection.
+   */
+  [[nodiscard]] static auto operator new(std::size_t size) -> void *;
+  /**
+   * @brief Returns a connection to the frame pool.
+   * @param ptr The storage of the connection.
+   * @param size The size of the connection.
+   */
+  static auto operator delete(void *ptr, std::size_t size) noexcept -> void;
+
+  /**
+   * @brief Reads from the connection.
+   * @param buffer The buffer to read into.
+   * @returns An awaiter that completes with the number of bytes read, or
+   * zero on EOF or error.
+   */
+  [[nodiscard]] auto read(std::span<std::byte> buffer) noexcept
+      -> read_awaiter;
+  /**
+   * @brief Writes a whole buffer to the connection.
+   * @details Partial sends are resumed until the whole buffer has been
+   * written.
+   * @param buffer The buffer to write. It must remain valid until the
+   * write completes.
+   * @returns An awaiter that completes with the number of bytes written.
+   */
+  [[nodiscard]] auto write(std::span<const std::byte> buffer) noexcept
+      -> write_awaiter;
+  /**
+   * @brief Suspends the coroutine on the timers of the async context.
+   * @tparam Rep The duration tick type.
+   * @tparam Period The tick period.
+   * @param interval The time to sleep for.
+   * @returns An awaiter that completes once the time has passed, or early
+   * with `error` set to operation_canceled if the async scope is stopped.
+   */
+  template <typename Rep, typename Period>
+  [[nodiscard]] auto sleep(std::chrono::duration<Rep, Period> interval) noexcept
+      -> sleep_awaiter;
+
+  /**
+   * @brief Runs the coroutine that serves the connection.
+   * @details The connection must have been allocated with new, and it
+   * deletes itself, closing the socket, when the coroutine completes.
+   * An exception that escapes the coroutine closes the connection.
+   * @param handler The coroutine.
+   */
+  auto start(task<void> handler) noexcept -> void;
+
+  /** @returns The error of the last operation, if it failed. */
+  [[nodiscard]] auto error() const noexcept -> std::error_code;
+  /** @returns The connected socket. */
+  [[nodiscard]] auto socket() const noexcept -> const socket_dialog &;
+  /** @returns The async context that serves the connection. */
+  [[nodiscard]] auto context() const noexcept -> async_context &;
+
+private:
+  /**
+   * @brief Deletes a connection whose coroutine has completed.
+   * @param conn The connection.
+   */
+  static auto finish_(void *conn) noexcept -> void;
+
+  /** @brief The async context. */
+  async_context *ctx_;
+  /** @brief The connected socket. */
+  socket_dialog socket_;
+  /** @brief The error of the last operation. */
+  std::error_code error_;
+  /** @brief The coroutine that serves the connection. */
+  task<void> handler_;
+};
+} // namespace net::service
+
+#include "impl/connection_impl.hpp" // IWYU pragma: export
+#endif                              // CPPNET_CONNECTION_HPP
@@ -20,6 +20,7 @@
 #define CPPNET_CONTEXT_THREAD_HPP
 #include "async_context.hpp"
 
+#include <atomic>
 #include <mutex>
 #include <thread>
 /** @brief This namespace is for network services. */
@@ -77,6 +78,20 @@ public:
    */
   template <typename... Args> auto start(Args &&...args) -> void;
 
+  /**
+   * @brief Returns the service run by the context thread.
+   * @details The service is constructed on the context thread by `start`,
+   * so it may only be used after `start` returns and while the context
+   * thread is running. The service is destroyed when the context thread
+   * stops, for instance during destruction, and the pointer that backs
+   * this reference is only cleared once the event loop has returned.
+   * Callers that keep the reference on other threads, such as a
+   * `rebalancer`, must stop using it before the context thread is
+   * stopped.
+   * @returns A reference to the running service.
+   */
+  [[nodiscard]] auto service() noexcept -> Service &;
+
   /** @brief The destructor signals the thread before joining it. */
   ~basic_context_thread();
 
@@ -85,6 +100,8 @@ private:
   std::thread server_;
   /** @brief Mutex for thread-safety. */
   std::mutex mtx_;
+  /** @brief The running service, or nullptr once it has stopped. */
+  std::atomic<Service *> service_ = nullptr;
 
   /** @brief Called when the async_service is stopped. */
   auto stop() noexcept -> void;
@@ -85,6 +85,32 @@ auto async_context::isr(const socket_dialog &socket, Fn routine) -> void
   scope.spawn(std::move(recvmsg));
 }
 
+template <typename Fn>
+  requires std::is_invocable_v<Fn>
+auto async_context::defer(Fn &&routine) -> void
+{
+  deferred.emplace_back(std::forward<Fn>(routine));
+}
+
+inline auto async_context::run_deferred() -> bool
+{
+  if (deferred.empty())
+    return false;
+
+  // Swap out the routines so that they may defer more work.
+  auto routines = std::vector<std::function<void()>>();
+  routines.swap(deferred);
+  for (auto &routine : routines)
+    routine();
+
+  // Hand the storage back to avoid reallocating it next iteration.
+  routines.clear();
+  if (deferred.empty())
+    deferred.swap(routines);
+
+  return true;
+}
+
 inline auto async_context::run() -> void
 {
   using namespace stdexec;
@@ -95,7 +121,14 @@ inline auto async_context::run() -> void
   scope.spawn(poller.on_empty() |
               then([&]() noexcept { is_empty.test_and_set(); }));
 
-  while (poller.wait_for(to_millis(timers.resolve())) || !is_empty.test());
+  auto next_timeout = [&] {
+    run_deferred();
+    auto timeout = to_millis(timers.resolve());
+    return deferred.empty() ? timeout : 0;
+  };
+
+  while (poller.wait_for(next_timeout()) || !is_empty.test() ||
+         !deferred.empty());
 }
 
 } // namespace net::service
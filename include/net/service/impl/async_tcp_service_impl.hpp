@@ -18,9 +18,17 @@
 #pragma once
 #ifndef CPPNET_ASYNC_TCP_SERVICE_IMPL_HPP
 #define CPPNET_ASYNC_TCP_SERVICE_IMPL_HPP
+#include "net/detail/to_error_code.hpp"
+#include "net/detail/with_lock.hpp"
 #include "net/service/async_tcp_service.hpp"
 
+#include <cassert>
+#include <optional>
 #include <system_error>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
 namespace net::service {
 template <typename TCPStreamHandler, std::size_t Size>
 template <typename T>
@@ -29,6 +37,12 @@ async_tcp_service<TCPStreamHandler, Size>::async_tcp_service(
     : address_{address}
 {}
 
+template <typename TCPStreamHandler, std::size_t Size>
+async_tcp_service<TCPStreamHandler, Size>::async_tcp_service(
+    shared_listener &listener) noexcept
+    : address_{listener.address()}, listener_{std::addressof(listener)}
+{}
+
 template <typename TCPStreamHandler, std::size_t Size>
 auto async_tcp_service<TCPStreamHandler, Size>::signal_handler(
     int signum) noexcept -> void
@@ -50,13 +64,33 @@ template <typename TCPStreamHandler, std::size_t Size>
 auto async_tcp_service<TCPStreamHandler, Size>::start(
     async_context &ctx) noexcept -> std::error_code
 {
-  auto sock = socket_handle(address_->sin6_family, SOCK_STREAM, 0);
-  if (auto error = initialize_(sock))
-    return error;
+  auto sock = std::optional<socket_handle>{};
+  if (!listener_)
+  {
+    sock.emplace(address_->sin6_family, SOCK_STREAM, 0);
+    if (auto error = initialize_(*sock))
+      return error;
+  }
+
+  if constexpr (requires { TCPStreamHandler::provided_buffers; })
+  {
+    try
+    {
+      buffers_ = net::detail::buffer_ring<read_context>(
+          TCPStreamHandler::provided_buffers);
+    }
+    catch (const std::bad_alloc &)
+    {
+      return std::make_error_code(std::errc::not_enough_memory);
+    }
+  }
+
+  if (listener_)
+    return join_(ctx);
 
-  acceptor_sockfd_ = static_cast<socket_type>(sock);
+  acceptor_sockfd_ = static_cast<socket_type>(*sock);
 
-  acceptor(ctx, ctx.poller.emplace(std::move(sock)));
+  acceptor(ctx, ctx.poller.emplace(std::move(*sock)));
 
   return {};
 }
@@ -69,30 +103,164 @@ auto async_tcp_service<TCPStreamHandler, Size>::acceptor(
 
   sender auto accept = io::accept(socket) | then([&, socket](auto accepted) {
                          auto [dialog, addr] = std::move(accepted);
-                         emit(ctx, dialog, std::make_shared<read_context>());
-                         acceptor(ctx, socket);
+                         accepted_(ctx, dialog);
+                         accept_queued(ctx, socket);
+                         rearm_(ctx, socket);
                        }) |
-                       upon_error([](auto &&error) {});
+                       upon_error([&, socket](auto &&error) {
+                         if (!listener_)
+                           return;
+
+                         // The connection was reset before it could be
+                         // accepted, so keep waiting with the token.
+                         using enum std::errc;
+                         auto code = net::detail::to_error_code(error);
+                         if (acceptor_sockfd_ != io::socket::INVALID_SOCKET &&
+                             (code == resource_unavailable_try_again ||
+                              code == operation_would_block))
+                         {
+                           return acceptor(ctx, socket);
+                         }
+                         listener_->pass(this);
+                       });
 
   ctx.scope.spawn(std::move(accept));
 }
 
+template <typename TCPStreamHandler, std::size_t Size>
+auto async_tcp_service<TCPStreamHandler, Size>::rearm_(
+    async_context &ctx, const socket_dialog &socket) -> void
+{
+  if (listener_)
+    return listener_->pass(this);
+
+  acceptor(ctx, socket);
+}
+
+template <typename TCPStreamHandler, std::size_t Size>
+auto async_tcp_service<TCPStreamHandler, Size>::join_(async_context &ctx)
+    -> std::error_code
+{
+  using namespace io::socket;
+
+  if (auto error = listener_->open(
+          [this](const socket_handle &sock) { return initialize_(sock); }))
+  {
+    return error;
+  }
+
+  // Each context polls its own descriptor for the shared socket so that
+  // stop_() can retire it without affecting the other contexts.
+  auto sockfd = ::fcntl(listener_->native_handle(), F_DUPFD_CLOEXEC, 0);
+  if (sockfd == INVALID_SOCKET)
+    return {errno, std::system_category()};
+
+  address_ = listener_->address();
+  acceptor_sockfd_ = sockfd;
+  auto socket = ctx.poller.emplace(sockfd);
+  listener_->join(this, ctx, [&ctx, this, socket] { acceptor(ctx, socket); });
+
+  return {};
+}
+
+template <typename TCPStreamHandler, std::size_t Size>
+auto async_tcp_service<TCPStreamHandler, Size>::accepted_(
+    async_context &ctx, const socket_dialog &socket) -> void
+{
+  if constexpr (coroutine_())
+  {
+    auto conn = std::make_unique<connection>(ctx, socket);
+    auto handler = static_cast<TCPStreamHandler *>(this)->handle(*conn);
+    // The connection deletes itself when the coroutine completes.
+    conn.release()->start(std::move(handler));
+  }
+  else
+  {
+    emit(ctx, socket, make_read_context());
+  }
+}
+
+template <typename TCPStreamHandler, std::size_t Size>
+auto async_tcp_service<TCPStreamHandler, Size>::accept_queued(
+    async_context &ctx, const socket_dialog &socket) -> void
+{
+  using namespace io::socket;
+
+  if constexpr (requires { TCPStreamHandler::accept_batch; })
+  {
+    for (std::size_t i = 1; i < TCPStreamHandler::accept_batch; ++i)
+    {
+      // The acceptor is non-blocking, so this stops at an empty queue.
+      auto [accepted, addr] = io::accept(*socket.socket);
+      if (static_cast<socket_type>(accepted) == INVALID_SOCKET)
+        break;
+
+      accepted_(ctx, ctx.poller.emplace(std::move(accepted)));
+    }
+  }
+}
+
 template <typename TCPStreamHandler, std::size_t Size>
 auto async_tcp_service<TCPStreamHandler, Size>::submit_recv(
     async_context &ctx, const socket_dialog &socket,
     std::shared_ptr<read_context> rctx) -> void
 {
   using namespace stdexec;
-  using namespace io::socket;
   if (!rctx)
     return;
 
+  if (shed_count_.load(std::memory_order_relaxed)) [[unlikely]]
+  {
+    if (shed_(ctx, socket, rctx))
+      return;
+  }
+
+  if constexpr (requires { TCPStreamHandler::provided_buffers; })
+  {
+    // Return the read context to the ring while the socket is idle, and
+    // take one back out only once there is data to read.
+    rctx.reset();
+    sender auto peek =
+        io::recvmsg(socket, peek_msg_, MSG_PEEK) |
+        then([&, socket](auto &&len) {
+          if (!len)
+            return emit(ctx, socket);
+
+          recv_(ctx, socket, make_read_context());
+        }) |
+        upon_error([&, socket](auto &&error) { emit(ctx, socket); });
+
+    ctx.scope.spawn(std::move(peek));
+  }
+  else
+  {
+    recv_(ctx, socket, std::move(rctx));
+  }
+}
+
+template <typename TCPStreamHandler, std::size_t Size>
+auto async_tcp_service<TCPStreamHandler, Size>::recv_(
+    async_context &ctx, const socket_dialog &socket,
+    std::shared_ptr<read_context> rctx) -> void
+{
+  using namespace stdexec;
+  using namespace io::socket;
+  assert(!rctx->buffer.empty() && "read buffer must not be empty.");
+
   sender auto recvmsg =
       io::recvmsg(socket, rctx->msg, 0) |
       then([&, socket, rctx](auto &&len) mutable {
         if (!len)
           return emit(ctx, socket);
 
+        // reads_ is only written by the context thread.
+        reads_.store(reads_.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_relaxed);
+        if constexpr (lifecycle_())
+        {
+          static_cast<TCPStreamHandler *>(this)->lifecycle.readable(
+              rctx->stamps);
+        }
         auto buf =
             std::span{rctx->buffer.data(), static_cast<std::size_t>(len)};
         emit(ctx, socket, std::move(rctx), buf);
@@ -102,13 +270,386 @@ auto async_tcp_service<TCPStreamHandler, Size>::submit_recv(
   ctx.scope.spawn(std::move(recvmsg));
 }
 
+template <typename TCPStreamHandler, std::size_t Size>
+auto async_tcp_service<TCPStreamHandler, Size>::submit_recv(
+    async_context &ctx, const socket_dialog &socket,
+    std::shared_ptr<read_context> rctx,
+    std::span<std::byte> buffer) -> std::error_code
+{
+  if (!rctx)
+    return {};
+
+  if (buffer.empty())
+    return std::make_error_code(std::errc::no_buffer_space);
+
+  rctx->buffer = buffer;
+  rctx->msg.buffers = buffer;
+  recv_(ctx, socket, std::move(rctx));
+  return {};
+}
+
+template <typename TCPStreamHandler, std::size_t Size>
+auto async_tcp_service<TCPStreamHandler, Size>::migrate(
+    const socket_dialog &socket, std::shared_ptr<read_context> rctx,
+    async_context &target, TCPStreamHandler &service) -> std::error_code
+{
+  using namespace io::socket;
+  using namespace std::chrono;
+  if (!rctx || !socket.socket)
+    return std::make_error_code(std::errc::invalid_argument);
+
+  if (target.state == async_context::STOPPED ||
+      target.scope.get_stop_token().stop_requested())
+  {
+    return std::make_error_code(std::errc::operation_canceled);
+  }
+
+  // Owns the duplicated socket until the target poller adopts it, so a
+  // handoff that the target abandons, by stopping before its timers are
+  // resolved or by removing the timer, closes the socket and releases
+  // the read context.
+  struct handoff : net::detail::immovable {
+    socket_type sockfd = INVALID_SOCKET;
+    ~handoff()
+    {
+      if (sockfd != INVALID_SOCKET)
+        ::close(sockfd);
+    }
+  };
+
+  try
+  {
+    auto owner = std::make_shared<handoff>();
+    owner->sockfd = ::dup(static_cast<socket_type>(*socket.socket));
+    if (owner->sockfd == INVALID_SOCKET)
+      return {errno, std::system_category()};
+
+    // Timers are resolved on the target context thread, which is the
+    // only thread that may register sockets with the target poller.
+    // `service` serves `target`, so both are alive while it resolves
+    // timers.
+    target.timers.add(microseconds(0), [&target, &service, owner,
+                                        rctx](auto) {
+      if (target.scope.get_stop_token().stop_requested())
+        return;
+
+      auto sockfd = std::exchange(owner->sockfd, INVALID_SOCKET);
+      service.submit_recv(target, target.poller.emplace(sockfd), rctx);
+    });
+  }
+  catch (const std::bad_alloc &)
+  {
+    return std::make_error_code(std::errc::not_enough_memory);
+  }
+
+  return {};
+}
+
+template <typename TCPStreamHandler, std::size_t Size>
+auto async_tcp_service<TCPStreamHandler, Size>::shed(
+    async_context &target, TCPStreamHandler &service,
+    std::size_t count) -> void
+{
+  using net::detail::with_lock;
+  with_lock(mtx_, [&] {
+    shed_to_ = {std::addressof(target), std::addressof(service)};
+    shed_count_ = count;
+  });
+}
+
+template <typename TCPStreamHandler, std::size_t Size>
+auto async_tcp_service<TCPStreamHandler, Size>::reads() const noexcept
+    -> std::uint64_t
+{
+  return reads_.load(std::memory_order_relaxed);
+}
+
+template <typename TCPStreamHandler, std::size_t Size>
+template <std::ranges::input_range Range>
+auto async_tcp_service<TCPStreamHandler, Size>::broadcast(
+    async_context &ctx, Range &&connections,
+    const shared_buffer &buffer) -> void
+{
+  for (const socket_dialog &socket : connections)
+  {
+    if constexpr (pacing_())
+    {
+      static_cast<TCPStreamHandler *>(this)->pacing.send(
+          ctx, flow_(socket), buffer.size(),
+          [&ctx, this, socket, buffer] { enqueue_(ctx, socket, buffer); });
+    }
+    else
+    {
+      enqueue_(ctx, socket, buffer);
+    }
+  }
+}
+
+template <typename TCPStreamHandler, std::size_t Size>
+auto async_tcp_service<TCPStreamHandler, Size>::enqueue_(
+    async_context &ctx, const socket_dialog &socket,
+    const shared_buffer &buffer) -> void
+{
+  if (buffer.empty() || !socket.socket)
+    return;
+
+  auto &queue = sends_[socket.socket.get()];
+  queue.buffers.push_back(buffer);
+  if (queue.buffers.size() == 1)
+    send_(ctx, socket, queue);
+}
+
+template <typename TCPStreamHandler, std::size_t Size>
+auto async_tcp_service<TCPStreamHandler, Size>::send_(
+    async_context &ctx, const socket_dialog &socket,
+    const send_queue &queue) -> void
+{
+  using namespace stdexec;
+  using socket_message = io::socket::socket_message<>;
+
+  auto msg = socket_message{
+      .buffers = queue.buffers.front().span().subspan(queue.offset)};
+  sender auto sendmsg =
+      io::sendmsg(socket, msg, MSG_NOSIGNAL) |
+      then([&, socket](auto &&len) {
+        auto it = sends_.find(socket.socket.get());
+        auto &[buffers, offset] = it->second;
+        offset += static_cast<std::size_t>(len);
+        if (offset == buffers.front().size())
+        {
+          buffers.pop_front();
+          offset = 0;
+        }
+
+        if (buffers.empty())
+        {
+          sends_.erase(it);
+          return;
+        }
+        send_(ctx, socket, it->second);
+      }) |
+      upon_error(
+          [&, socket](auto &&error) { sends_.erase(socket.socket.get()); }) |
+      upon_stopped([&, socket] { sends_.erase(socket.socket.get()); });
+
+  ctx.scope.spawn(std::move(sendmsg));
+}
+
+template <typename TCPStreamHandler, std::size_t Size>
+constexpr auto async_tcp_service<TCPStreamHandler, Size>::pacing_() noexcept
+    -> bool
+{
+  return requires(TCPStreamHandler handler) {
+    { handler.pacing } -> std::same_as<pacer &>;
+  };
+}
+
+template <typename TCPStreamHandler, std::size_t Size>
+constexpr auto async_tcp_service<TCPStreamHandler, Size>::lifecycle_() noexcept
+    -> bool
+{
+  return requires(TCPStreamHandler handler) {
+    { handler.lifecycle } -> std::same_as<request_lifecycle &>;
+  };
+}
+
+template <typename TCPStreamHandler, std::size_t Size>
+constexpr auto async_tcp_service<TCPStreamHandler, Size>::coroutine_() noexcept
+    -> bool
+{
+  return requires(TCPStreamHandler handler, connection &conn) {
+    { handler.handle(conn) } -> std::same_as<task<void>>;
+  };
+}
+
+template <typename TCPStreamHandler, std::size_t Size>
+constexpr auto async_tcp_service<TCPStreamHandler, Size>::middleware_() noexcept
+    -> bool
+{
+  return requires(TCPStreamHandler handler) {
+    requires is_pipeline_v<decltype(handler.middleware)>;
+  };
+}
+
+template <typename TCPStreamHandler, std::size_t Size>
+auto async_tcp_service<TCPStreamHandler, Size>::flow_(
+    const socket_dialog &socket) noexcept -> pacer::flow_type
+{
+  return reinterpret_cast<std::uintptr_t>(socket.socket.get());
+}
+
+template <typename TCPStreamHandler, std::size_t Size>
+constexpr auto async_tcp_service<TCPStreamHandler, Size>::metrics_() noexcept
+    -> bool
+{
+  return requires(TCPStreamHandler handler) {
+    { handler.metrics } -> std::same_as<tcp_metrics &>;
+  };
+}
+
+template <typename TCPStreamHandler, std::size_t Size>
+auto async_tcp_service<TCPStreamHandler, Size>::shed_(
+    async_context &ctx, const socket_dialog &socket,
+    const std::shared_ptr<read_context> &rctx) -> bool
+{
+  using net::detail::with_lock;
+  auto [target, service] = with_lock(mtx_, [&] {
+    auto count = shed_count_.load();
+    if (!count)
+      return std::pair<async_context *, TCPStreamHandler *>{};
+
+    shed_count_ = count - 1;
+    return shed_to_;
+  });
+
+  if (!target || target == std::addressof(ctx))
+    return false;
+
+  return !migrate(socket, rctx, *target, *service);
+}
+
+template <typename TCPStreamHandler, std::size_t Size>
+auto async_tcp_service<TCPStreamHandler, Size>::make_read_context()
+    -> std::shared_ptr<read_context>
+{
+  if constexpr (requires { TCPStreamHandler::provided_buffers; })
+  {
+    auto rctx = buffers_.acquire();
+    rctx->buffer = rctx->read_buffer;
+    rctx->msg.buffers = rctx->buffer;
+    rctx->stamps = {};
+    return rctx;
+  }
+  else
+  {
+    return std::make_shared<read_context>();
+  }
+}
+
 template <typename TCPStreamHandler, std::size_t Size>
 auto async_tcp_service<TCPStreamHandler, Size>::emit(
     async_context &ctx, const socket_dialog &socket,
     std::shared_ptr<read_context> rctx, std::span<const std::byte> buf) -> void
 {
-  static_cast<TCPStreamHandler *>(this)->service(ctx, socket, std::move(rctx),
-                                                 buf);
+  if constexpr (metrics_())
+  {
+    auto &metrics = static_cast<TCPStreamHandler *>(this)->metrics;
+    if (!rctx)
+      metrics.closed.add();
+    else if (buf.empty())
+      metrics.accepted.add();
+    else
+      metrics.bytes.add(buf.size());
+  }
+
+  if constexpr (pacing_())
+  {
+    if (!rctx)
+      static_cast<TCPStreamHandler *>(this)->pacing.forget(flow_(socket));
+  }
+
+  if constexpr (requires(TCPStreamHandler handler,
+                         std::span<read_event> events) {
+                  handler.service_batch(ctx, events);
+                })
+  {
+    static_assert(!middleware_(),
+                  "middleware can't be combined with service_batch.");
+    if (batch_.empty())
+      ctx.defer([&, this] { flush_(ctx); });
+
+    batch_.push_back({.socket = socket, .rctx = std::move(rctx), .buf = buf});
+  }
+  else if constexpr (lifecycle_())
+  {
+    auto &lifecycle = static_cast<TCPStreamHandler *>(this)->lifecycle;
+    if (rctx && buf.empty())
+      lifecycle.accepted(rctx->stamps);
+
+    // Hold sampled read contexts so that the exit can be stamped even if
+    // the stream handler releases them.
+    auto sampled = std::shared_ptr<read_context>();
+    if (rctx && !buf.empty() && rctx->stamps.sampled)
+    {
+      lifecycle.entered(rctx->stamps);
+      sampled = rctx;
+    }
+
+    dispatch_(ctx, socket, std::move(rctx), buf);
+    if (sampled)
+      lifecycle.exited(sampled->stamps);
+  }
+  else
+  {
+    dispatch_(ctx, socket, std::move(rctx), buf);
+  }
+}
+
+template <typename TCPStreamHandler, std::size_t Size>
+auto async_tcp_service<TCPStreamHandler, Size>::dispatch_(
+    async_context &ctx, const socket_dialog &socket,
+    std::shared_ptr<read_context> rctx, std::span<const std::byte> buf) -> void
+{
+  auto *handler = static_cast<TCPStreamHandler *>(this);
+  if constexpr (middleware_())
+  {
+    handler->middleware(
+        [](TCPStreamHandler &self, auto &&...forwarded) {
+          self.service(std::forward<decltype(forwarded)>(forwarded)...);
+        },
+        *handler, ctx, socket, std::move(rctx), buf);
+  }
+  else
+  {
+    handler->service(ctx, socket, std::move(rctx), buf);
+  }
+}
+
+template <typename TCPStreamHandler, std::size_t Size>
+auto async_tcp_service<TCPStreamHandler, Size>::flush_(async_context &ctx)
+    -> void
+{
+  if constexpr (requires(TCPStreamHandler handler,
+                         std::span<read_event> events) {
+                  handler.service_batch(ctx, events);
+                })
+  {
+    auto events = std::vector<read_event>{};
+    events.swap(batch_);
+
+    if constexpr (lifecycle_())
+    {
+      auto &lifecycle = static_cast<TCPStreamHandler *>(this)->lifecycle;
+      for (const auto &event : events)
+      {
+        if (event.rctx && event.buf.empty())
+          lifecycle.accepted(event.rctx->stamps);
+
+        if (event.rctx && !event.buf.empty() && event.rctx->stamps.sampled)
+        {
+          lifecycle.entered(event.rctx->stamps);
+          sampled_.push_back(event.rctx);
+        }
+      }
+    }
+
+    static_cast<TCPStreamHandler *>(this)->service_batch(ctx,
+                                                         std::span(events));
+
+    if constexpr (lifecycle_())
+    {
+      auto &lifecycle = static_cast<TCPStreamHandler *>(this)->lifecycle;
+      for (const auto &rctx : sampled_)
+        lifecycle.exited(rctx->stamps);
+      sampled_.clear();
+    }
+
+    // Reuse the storage for the next batch if the handler has not
+    // started one.
+    events.clear();
+    if (batch_.empty())
+      batch_.swap(events);
+  }
 }
 
 template <typename TCPStreamHandler, std::size_t Size>
@@ -134,6 +675,14 @@ auto async_tcp_service<TCPStreamHandler, Size>::initialize_(
       return error;
   }
 
+  if constexpr (requires { TCPStreamHandler::accept_batch; })
+  {
+    // Batched accepts drain the accept queue until it is empty.
+    const auto sockfd = static_cast<socket_type>(socket);
+    if (::fcntl(sockfd, F_SETFL, ::fcntl(sockfd, F_GETFL) | O_NONBLOCK))
+      return {errno, std::system_category()};
+  }
+
   if (bind(socket, address_))
     return {errno, std::system_category()};
 
@@ -150,7 +699,25 @@ auto async_tcp_service<TCPStreamHandler, Size>::stop_() -> void
 {
   using namespace io::socket;
   auto sockfd = acceptor_sockfd_.exchange(INVALID_SOCKET);
-  shutdown(sockfd, SHUT_RD);
+  if (!listener_)
+  {
+    shutdown(sockfd, SHUT_RD);
+    return;
+  }
+
+  if (sockfd == INVALID_SOCKET)
+    return;
+
+  // Shutting down the shared socket would stop every context from
+  // accepting. Instead, replace this context's descriptor with an unbound
+  // socket, which fails any accept that is still pending on it.
+  listener_->leave(this);
+  if (auto unbound = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+      unbound != INVALID_SOCKET)
+  {
+    ::dup3(unbound, sockfd, O_CLOEXEC);
+    ::close(unbound);
+  }
 }
 
 } // namespace net::service
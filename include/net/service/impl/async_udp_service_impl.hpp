@@ -19,6 +19,17 @@
 #ifndef CPPNET_ASYNC_UDP_SERVICE_IMPL_HPP
 #define CPPNET_ASYNC_UDP_SERVICE_IMPL_HPP
 #include "net/service/async_udp_service.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <iterator>
+
+#include <netinet/udp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 namespace net::service {
 
 template <typename UDPStreamHandler, std::size_t Size>
@@ -46,8 +57,59 @@ auto async_udp_service<UDPStreamHandler, Size>::start(
 
   server_sockfd_ = static_cast<socket_type>(sock);
 
-  submit_recv(ctx, ctx.poller.emplace(std::move(sock)),
-              std::make_shared<read_context>());
+  if constexpr (sessions_())
+  {
+    auto *handler = static_cast<UDPStreamHandler *>(this);
+    const auto timeout = handler->sessions.timeout();
+    ctx.timers.add(
+        timeout,
+        [&, handler](timers::timer_id tid) {
+          if (server_sockfd_ == io::socket::INVALID_SOCKET)
+          {
+            ctx.timers.remove(tid);
+            return;
+          }
+
+          handler->sessions.expire(timers::clock::now());
+        },
+        timeout);
+  }
+
+  if constexpr (recv_slots_() > 0)
+  {
+    try
+    {
+      slots_.reserve(recv_slots_());
+      for (std::size_t i = 1; i < recv_slots_(); ++i)
+        slots_.push_back(std::make_shared<read_context>());
+    }
+    catch (const std::bad_alloc &)
+    {
+      return std::make_error_code(std::errc::not_enough_memory);
+    }
+  }
+
+  if constexpr (requires { UDPStreamHandler::provided_buffers; })
+  {
+    static_assert(recv_slots_() == 0,
+                  "provided_buffers can't be combined with batched receives.");
+    try
+    {
+      buffers_ = net::detail::buffer_ring<read_context>(
+          UDPStreamHandler::provided_buffers);
+    }
+    catch (const std::bad_alloc &)
+    {
+      return std::make_error_code(std::errc::not_enough_memory);
+    }
+
+    recv_(ctx, ctx.poller.emplace(std::move(sock)));
+  }
+  else
+  {
+    submit_recv(ctx, ctx.poller.emplace(std::move(sock)),
+                std::make_shared<read_context>());
+  }
 
   return {};
 }
@@ -60,6 +122,18 @@ auto async_udp_service<UDPStreamHandler, Size>::submit_recv(
   using namespace stdexec;
   using namespace io::socket;
 
+  if constexpr (recv_slots_() > 0)
+  {
+    if (rctx)
+      slots_.push_back(std::move(rctx));
+    return recv_batch_(ctx, socket);
+  }
+  else if constexpr (requires { UDPStreamHandler::provided_buffers; })
+  {
+    // The service re-arms itself, so there is nothing to submit.
+    return;
+  }
+
   sender auto recvmsg =
       io::recvmsg(socket, rctx->msg, 0) |
       then([&, socket, rctx](auto &&len) mutable {
@@ -73,13 +147,618 @@ auto async_udp_service<UDPStreamHandler, Size>::submit_recv(
   ctx.scope.spawn(std::move(recvmsg));
 }
 
+template <typename UDPStreamHandler, std::size_t Size>
+auto async_udp_service<UDPStreamHandler, Size>::recv_(
+    async_context &ctx, const socket_dialog &socket) -> void
+{
+  using namespace stdexec;
+
+  auto rctx = buffers_.acquire();
+  sender auto recvmsg =
+      io::recvmsg(socket, rctx->msg, 0) |
+      then([&, socket, rctx](auto &&len) mutable {
+        if (server_sockfd_ == io::socket::INVALID_SOCKET)
+          return emit(ctx, socket);
+
+        // Keep the socket draining while the handler holds this datagram.
+        recv_(ctx, socket);
+        auto buf =
+            std::span{rctx->buffer.data(), static_cast<std::size_t>(len)};
+        emit(ctx, socket, std::move(rctx), buf);
+      }) |
+      upon_error([&, socket](auto &&error) { emit(ctx, socket); });
+
+  ctx.scope.spawn(std::move(recvmsg));
+}
+
+template <typename UDPStreamHandler, std::size_t Size>
+auto async_udp_service<UDPStreamHandler, Size>::recv_batch_(
+    async_context &ctx, const socket_dialog &socket) -> void
+{
+  using namespace stdexec;
+
+  if (reading_ || slots_.empty())
+    return;
+
+  reading_ = true;
+  sender auto peek = io::recvmsg(socket, peek_msg_, MSG_PEEK) |
+                     then([&, socket](auto &&len) {
+                       reading_ = false;
+                       if (server_sockfd_ == io::socket::INVALID_SOCKET)
+                         return emit(ctx, socket);
+
+                       recvmmsg_(ctx, socket);
+                     }) |
+                     upon_error([&, socket](auto &&error) {
+                       reading_ = false;
+                       emit(ctx, socket);
+                     });
+
+  ctx.scope.spawn(std::move(peek));
+}
+
+template <typename UDPStreamHandler, std::size_t Size>
+auto async_udp_service<UDPStreamHandler, Size>::recvmmsg_(
+    async_context &ctx, const socket_dialog &socket) -> void
+{
+  using namespace io::socket;
+
+  if constexpr (recv_slots_() > 0)
+  {
+    // A coalesced read that doesn't fit the read buffer is truncated.
+    static_assert(!gro_() || Size >= 65535,
+                  "udp_gro can't be combined with a read buffer smaller "
+                  "than 65535 bytes.");
+
+    // Room for the UDP_GRO segment size, the SO_RXQ_OVFL drop count and
+    // the SO_TIMESTAMPNS receive time of each datagram.
+    struct alignas(cmsghdr) control_buffer {
+      std::array<char, CMSG_SPACE(sizeof(int)) +
+                           CMSG_SPACE(sizeof(std::uint32_t)) +
+                           CMSG_SPACE(sizeof(timespec))>
+          data;
+    };
+    constexpr auto control = gro_() || rxq_overflow_() || rx_timestamps_();
+
+    constexpr auto batch = recv_slots_();
+    auto iovecs = std::array<iovec, batch>{};
+    auto headers = std::array<mmsghdr, batch>{};
+    auto controls = std::array<control_buffer, control ? batch : 0>{};
+    auto ready = std::array<std::shared_ptr<read_context>, batch>{};
+
+    const auto count = std::min(slots_.size(), batch);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      auto &rctx = slots_[i];
+      iovecs[i] = {.iov_base = rctx->read_buffer.data(),
+                   .iov_len = rctx->read_buffer.size()};
+      headers[i].msg_hdr = {
+          .msg_name = std::addressof(**rctx->msg.address),
+          .msg_namelen = sizeof(sockaddr_in6),
+          .msg_iov = std::addressof(iovecs[i]),
+          .msg_iovlen = 1,
+      };
+      if constexpr (control)
+      {
+        headers[i].msg_hdr.msg_control = controls[i].data.data();
+        headers[i].msg_hdr.msg_controllen = controls[i].data.size();
+      }
+    }
+
+    const auto sockfd = static_cast<native_socket_type>(*socket.socket);
+    auto received = ::recvmmsg(sockfd, headers.data(),
+                               static_cast<unsigned>(count), MSG_DONTWAIT,
+                               nullptr);
+    if (received <= 0)
+    {
+      if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK ||
+                           errno == EINTR))
+      {
+        return recv_batch_(ctx, socket);
+      }
+      return emit(ctx, socket);
+    }
+
+    // The stream handler may return slots to the pool while the datagrams
+    // are emitted, so take the filled slots out first.
+    const auto filled = static_cast<std::size_t>(received);
+    std::ranges::move(slots_.begin(), slots_.begin() + filled, ready.begin());
+    slots_.erase(slots_.begin(), slots_.begin() + filled);
+
+    for (std::size_t i = 0; i < filled; ++i)
+    {
+      auto &msg = headers[i].msg_hdr;
+      ready[i]->segment_size = 0;
+      for (auto *cmsg = CMSG_FIRSTHDR(&msg); control && cmsg;
+           cmsg = CMSG_NXTHDR(&msg, cmsg))
+      {
+        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO)
+        {
+          auto size = 0;
+          std::memcpy(&size, CMSG_DATA(cmsg), sizeof(size));
+          ready[i]->segment_size = static_cast<std::size_t>(size);
+        }
+        else if (cmsg->cmsg_level == SOL_SOCKET &&
+                 cmsg->cmsg_type == SO_RXQ_OVFL)
+        {
+          // The kernel reports the socket's running total of drops.
+          auto drops = std::uint32_t{0};
+          std::memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+          statistics_.drops.store(drops, std::memory_order_relaxed);
+        }
+        else if (cmsg->cmsg_level == SOL_SOCKET &&
+                 cmsg->cmsg_type == SCM_TIMESTAMPNS)
+        {
+          auto time = timespec{};
+          std::memcpy(&time, CMSG_DATA(cmsg), sizeof(time));
+          ready[i]->timestamp = std::chrono::system_clock::time_point(
+              std::chrono::duration_cast<
+                  std::chrono::system_clock::duration>(
+                  std::chrono::seconds(time.tv_sec) +
+                  std::chrono::nanoseconds(time.tv_nsec)));
+        }
+      }
+
+      auto buf = std::span{ready[i]->read_buffer.data(),
+                           static_cast<std::size_t>(headers[i].msg_len)};
+      emit(ctx, socket, std::move(ready[i]), buf);
+    }
+
+    recv_batch_(ctx, socket);
+  }
+}
+
+template <typename UDPStreamHandler, std::size_t Size>
+constexpr auto
+async_udp_service<UDPStreamHandler, Size>::recv_slots_() noexcept
+    -> std::size_t
+{
+  if constexpr (requires { UDPStreamHandler::recv_batch; })
+    return UDPStreamHandler::recv_batch;
+  else
+    return gro_() || rxq_overflow_() || rx_timestamps_() ? 1 : 0;
+}
+
+template <typename UDPStreamHandler, std::size_t Size>
+constexpr auto async_udp_service<UDPStreamHandler, Size>::gro_() noexcept
+    -> bool
+{
+  if constexpr (requires { UDPStreamHandler::udp_gro; })
+    return UDPStreamHandler::udp_gro;
+  else
+    return false;
+}
+
+template <typename UDPStreamHandler, std::size_t Size>
+constexpr auto
+async_udp_service<UDPStreamHandler, Size>::rxq_overflow_() noexcept -> bool
+{
+  if constexpr (requires { UDPStreamHandler::rxq_overflow; })
+    return UDPStreamHandler::rxq_overflow;
+  else
+    return false;
+}
+
+template <typename UDPStreamHandler, std::size_t Size>
+constexpr auto
+async_udp_service<UDPStreamHandler, Size>::rx_timestamps_() noexcept -> bool
+{
+  if constexpr (requires { UDPStreamHandler::rx_timestamps; })
+    return UDPStreamHandler::rx_timestamps;
+  else
+    return false;
+}
+
+template <typename UDPStreamHandler, std::size_t Size>
+auto async_udp_service<UDPStreamHandler, Size>::record_latency_(
+    const read_context &rctx) noexcept -> void
+{
+  if constexpr (rx_timestamps_())
+  {
+    statistics_.latency.record(
+        std::chrono::duration_cast<latency_histogram::duration>(
+            std::chrono::system_clock::now() - rctx.timestamp));
+  }
+}
+
+template <typename UDPStreamHandler, std::size_t Size>
+auto async_udp_service<UDPStreamHandler, Size>::statistics() const noexcept
+    -> const statistics_type &
+{
+  return statistics_;
+}
+
+template <typename UDPStreamHandler, std::size_t Size>
+constexpr auto async_udp_service<UDPStreamHandler, Size>::pacing_() noexcept
+    -> bool
+{
+  return requires(UDPStreamHandler handler) {
+    { handler.pacing } -> std::same_as<pacer &>;
+  };
+}
+
+template <typename UDPStreamHandler, std::size_t Size>
+constexpr auto async_udp_service<UDPStreamHandler, Size>::sessions_() noexcept
+    -> bool
+{
+  return requires(UDPStreamHandler handler, socket_address<sockaddr_in6> peer) {
+    handler.sessions.get(peer, timers::clock::now());
+    handler.sessions.expire(timers::clock::now());
+  };
+}
+
+template <typename UDPStreamHandler, std::size_t Size>
+constexpr auto async_udp_service<UDPStreamHandler, Size>::middleware_() noexcept
+    -> bool
+{
+  return requires(UDPStreamHandler handler) {
+    requires is_pipeline_v<decltype(handler.middleware)>;
+  };
+}
+
+template <typename UDPStreamHandler, std::size_t Size>
+auto async_udp_service<UDPStreamHandler, Size>::send_segments(
+    async_context &ctx, const socket_dialog &socket,
+    const socket_address<sockaddr_in6> &peer, const shared_buffer &buffer,
+    std::size_t segment_size) -> void
+{
+  // The kernel limits a segmented send to 64 segments in one IP packet.
+  constexpr auto max_segments = 64UL;
+  constexpr auto max_payload = 65507UL;
+
+  const auto bytes = buffer.span();
+  if (segment_size == 0 || segment_size > max_payload)
+    return;
+
+  const auto chunk =
+      segment_size * std::min(max_segments, max_payload / segment_size);
+  for (std::size_t offset = 0; offset < bytes.size(); offset += chunk)
+  {
+    auto len = std::min(chunk, bytes.size() - offset);
+    if constexpr (pacing_())
+    {
+      static_cast<UDPStreamHandler *>(this)->pacing.send(
+          ctx, pacer::flow_of(peer), len,
+          [&ctx, this, socket, peer, buffer, offset, len, segment_size] {
+            send_segment_(ctx, socket, peer, buffer, offset, len,
+                          segment_size);
+          });
+    }
+    else
+    {
+      send_segment_(ctx, socket, peer, buffer, offset, len, segment_size);
+    }
+  }
+}
+
+template <typename UDPStreamHandler, std::size_t Size>
+auto async_udp_service<UDPStreamHandler, Size>::send_segment_(
+    async_context &ctx, const socket_dialog &socket,
+    const socket_address<sockaddr_in6> &peer, const shared_buffer &buffer,
+    std::size_t offset, std::size_t len, std::size_t segment_size) -> void
+{
+  using namespace io::socket;
+
+  // Room for the UDP_SEGMENT segment size.
+  struct alignas(cmsghdr) control_buffer {
+    std::array<char, CMSG_SPACE(sizeof(std::uint16_t))> data;
+  };
+
+  const auto bytes = buffer.span();
+  const auto sockfd = static_cast<native_socket_type>(*socket.socket);
+  auto address = peer;
+  auto iov = iovec{.iov_base = const_cast<std::byte *>(bytes.data()) + offset,
+                   .iov_len = len};
+  auto control = control_buffer{};
+  auto msg = msghdr{
+      .msg_name = std::addressof(*address),
+      .msg_namelen = address->sin6_family == AF_INET
+                         ? socklen_t{sizeof(sockaddr_in)}
+                         : socklen_t{sizeof(sockaddr_in6)},
+      .msg_iov = &iov,
+      .msg_iovlen = 1,
+      .msg_control = control.data.data(),
+      .msg_controllen = control.data.size(),
+  };
+
+  auto *cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_UDP;
+  cmsg->cmsg_type = UDP_SEGMENT;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(std::uint16_t));
+  const auto size = static_cast<std::uint16_t>(segment_size);
+  std::memcpy(CMSG_DATA(cmsg), &size, sizeof(size));
+
+  // The io wrappers cannot attach control messages to a send, so the
+  // segmented send is a synchronous ::sendmsg that they never see.
+  if (::sendmsg(sockfd, &msg, MSG_DONTWAIT) < 0)
+  {
+    send_datagrams_(ctx, socket, peer, buffer, offset, offset + len,
+                    segment_size);
+  }
+}
+
+template <typename UDPStreamHandler, std::size_t Size>
+auto async_udp_service<UDPStreamHandler, Size>::send_datagrams_(
+    async_context &ctx, const socket_dialog &socket,
+    const socket_address<sockaddr_in6> &peer, const shared_buffer &buffer,
+    std::size_t offset, std::size_t end, std::size_t segment_size) -> void
+{
+  using namespace stdexec;
+  using socket_message = io::socket::socket_message<>;
+
+  auto address = peer;
+  if (address->sin6_family == AF_INET)
+  {
+    const auto *ptr =
+        reinterpret_cast<const struct sockaddr *>(std::addressof(*peer));
+    address = socket_address<sockaddr_in>(ptr);
+  }
+
+  const auto bytes = buffer.span();
+  for (; offset < end; offset += segment_size)
+  {
+    auto len = std::min(segment_size, end - offset);
+    auto msg = socket_message{.address = address,
+                              .buffers = bytes.subspan(offset, len)};
+    sender auto sendmsg = io::sendmsg(socket, msg, 0) |
+                          then([buffer](auto &&len) {}) |
+                          upon_error([](auto &&error) {});
+
+    ctx.scope.spawn(std::move(sendmsg));
+  }
+}
+
+template <typename UDPStreamHandler, std::size_t Size>
+template <std::ranges::input_range Range>
+auto async_udp_service<UDPStreamHandler, Size>::broadcast(
+    async_context &ctx, const socket_dialog &socket, Range &&peers,
+    const shared_buffer &buffer) -> void
+{
+  using namespace stdexec;
+  using socket_message = io::socket::socket_message<>;
+
+  for (const socket_address<sockaddr_in6> &peer : peers)
+  {
+    auto address = peer;
+    if (address->sin6_family == AF_INET)
+    {
+      const auto *ptr =
+          reinterpret_cast<const struct sockaddr *>(std::addressof(*peer));
+      address = socket_address<sockaddr_in>(ptr);
+    }
+
+    auto msg = socket_message{.address = address, .buffers = buffer.span()};
+    auto send = [&ctx, socket, msg, buffer] {
+      sender auto sendmsg = io::sendmsg(socket, msg, 0) |
+                            then([buffer](auto &&len) {}) |
+                            upon_error([](auto &&error) {});
+
+      ctx.scope.spawn(std::move(sendmsg));
+    };
+
+    if constexpr (pacing_())
+    {
+      static_cast<UDPStreamHandler *>(this)->pacing.send(
+          ctx, pacer::flow_of(peer), buffer.size(), std::move(send));
+    }
+    else
+    {
+      send();
+    }
+  }
+}
+
+template <typename UDPStreamHandler, std::size_t Size>
+auto async_udp_service<UDPStreamHandler, Size>::reply(
+    async_context &ctx, const socket_dialog &socket,
+    std::shared_ptr<read_context> rctx, std::span<const std::byte> buf) -> void
+{
+  if (!rctx)
+    return;
+
+  if (replies_.empty() && !blocked_)
+    ctx.defer([&, this] { flush_replies_(ctx); });
+
+  replies_.push_back({.socket = socket, .rctx = std::move(rctx), .buf = buf});
+}
+
+template <typename UDPStreamHandler, std::size_t Size>
+auto async_udp_service<UDPStreamHandler, Size>::flush_replies_(
+    async_context &ctx) -> void
+{
+  using namespace io::socket;
+
+  while (!blocked_ && !replies_.empty())
+  {
+    // A sendmmsg is limited to one socket and UIO_MAXIOV messages.
+    const auto sockfd =
+        static_cast<native_socket_type>(*replies_.front().socket.socket);
+    auto count = std::size_t{0};
+    while (count < replies_.size() && count < UIO_MAXIOV &&
+           static_cast<native_socket_type>(
+               *replies_[count].socket.socket) == sockfd)
+    {
+      ++count;
+    }
+
+    reply_headers_.resize(count);
+    reply_iovecs_.resize(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      auto &[socket, rctx, buf] = replies_[i];
+      auto &address = *rctx->msg.address;
+      reply_iovecs_[i] = {.iov_base = const_cast<std::byte *>(buf.data()),
+                          .iov_len = buf.size()};
+      reply_headers_[i] = {};
+      reply_headers_[i].msg_hdr = {
+          .msg_name = std::addressof(*address),
+          .msg_namelen = address->sin6_family == AF_INET
+                             ? socklen_t{sizeof(sockaddr_in)}
+                             : socklen_t{sizeof(sockaddr_in6)},
+          .msg_iov = std::addressof(reply_iovecs_[i]),
+          .msg_iovlen = 1,
+      };
+    }
+
+    auto sent = ::sendmmsg(sockfd, reply_headers_.data(),
+                           static_cast<unsigned>(count), MSG_DONTWAIT);
+    if (sent < 0)
+    {
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        return await_writable_(ctx);
+
+      // The first reply could not be sent, so drop it and carry on.
+      sent = 1;
+    }
+
+    complete_replies_(ctx, static_cast<std::size_t>(sent));
+  }
+}
+
+template <typename UDPStreamHandler, std::size_t Size>
+auto async_udp_service<UDPStreamHandler, Size>::await_writable_(
+    async_context &ctx) -> void
+{
+  using namespace stdexec;
+  using socket_message = io::socket::socket_message<>;
+
+  auto &[socket, rctx, buf] = replies_.front();
+  auto address = *rctx->msg.address;
+  if (address->sin6_family == AF_INET)
+  {
+    const auto *ptr =
+        reinterpret_cast<const struct sockaddr *>(std::addressof(*address));
+    address = socket_address<sockaddr_in>(ptr);
+  }
+
+  blocked_ = true;
+  auto msg = socket_message{.address = address, .buffers = buf};
+  sender auto sendmsg = io::sendmsg(socket, msg, 0) |
+                        then([&](auto &&len) {
+                          blocked_ = false;
+                          complete_replies_(ctx, 1);
+                          flush_replies_(ctx);
+                        }) |
+                        upon_error([&](auto &&error) {
+                          blocked_ = false;
+                          complete_replies_(ctx, 1);
+                          flush_replies_(ctx);
+                        });
+
+  ctx.scope.spawn(std::move(sendmsg));
+}
+
+template <typename UDPStreamHandler, std::size_t Size>
+auto async_udp_service<UDPStreamHandler, Size>::complete_replies_(
+    async_context &ctx, std::size_t count) -> void
+{
+  // Take the sent replies out of the queue first, because passing a read
+  // context back may queue new replies.
+  auto done = std::vector<reply_type>{};
+  done.swap(sent_);
+  done.assign(std::make_move_iterator(replies_.begin()),
+              std::make_move_iterator(replies_.begin() + count));
+  replies_.erase(replies_.begin(), replies_.begin() + count);
+
+  for (auto &[socket, rctx, buf] : done)
+    submit_recv(ctx, socket, std::move(rctx));
+
+  // Reuse the storage for the next completion.
+  done.clear();
+  if (sent_.empty())
+    sent_.swap(done);
+}
+
 template <typename UDPStreamHandler, std::size_t Size>
 auto async_udp_service<UDPStreamHandler, Size>::emit(
     async_context &ctx, const socket_dialog &socket,
     std::shared_ptr<read_context> rctx, std::span<const std::byte> buf) -> void
 {
-  static_cast<UDPStreamHandler *>(this)->service(ctx, socket, std::move(rctx),
-                                                 buf);
+  if (rctx)
+    statistics_.datagrams.fetch_add(1, std::memory_order_relaxed);
+
+  if constexpr (requires(UDPStreamHandler handler,
+                         std::span<read_event> events) {
+                  handler.service_batch(ctx, events);
+                })
+  {
+    static_assert(!sessions_(),
+                  "sessions can't be combined with service_batch.");
+    static_assert(!middleware_(),
+                  "middleware can't be combined with service_batch.");
+    if (batch_.empty())
+      ctx.defer([&, this] { flush_(ctx); });
+
+    batch_.push_back({.socket = socket, .rctx = std::move(rctx), .buf = buf});
+  }
+  else if constexpr (sessions_())
+  {
+    auto *handler = static_cast<UDPStreamHandler *>(this);
+    using state_type =
+        typename decltype(UDPStreamHandler::sessions)::state_type;
+
+    state_type *session = nullptr;
+    if (rctx)
+    {
+      record_latency_(*rctx);
+      session = std::addressof(
+          handler->sessions.get(*rctx->msg.address, timers::clock::now()));
+    }
+    dispatch_(ctx, socket, std::move(rctx), buf, session);
+  }
+  else
+  {
+    if (rctx)
+      record_latency_(*rctx);
+    dispatch_(ctx, socket, std::move(rctx), buf);
+  }
+}
+
+template <typename UDPStreamHandler, std::size_t Size>
+template <typename... Args>
+auto async_udp_service<UDPStreamHandler, Size>::dispatch_(Args &&...args)
+    -> void
+{
+  auto *handler = static_cast<UDPStreamHandler *>(this);
+  if constexpr (middleware_())
+  {
+    handler->middleware(
+        [](UDPStreamHandler &self, auto &&...forwarded) {
+          self.service(std::forward<decltype(forwarded)>(forwarded)...);
+        },
+        *handler, std::forward<Args>(args)...);
+  }
+  else
+  {
+    handler->service(std::forward<Args>(args)...);
+  }
+}
+
+template <typename UDPStreamHandler, std::size_t Size>
+auto async_udp_service<UDPStreamHandler, Size>::flush_(async_context &ctx)
+    -> void
+{
+  if constexpr (requires(UDPStreamHandler handler,
+                         std::span<read_event> events) {
+                  handler.service_batch(ctx, events);
+                })
+  {
+    auto events = std::vector<read_event>{};
+    events.swap(batch_);
+    for (const auto &event : events)
+    {
+      if (event.rctx)
+        record_latency_(*event.rctx);
+    }
+    static_cast<UDPStreamHandler *>(this)->service_batch(ctx,
+                                                         std::span(events));
+
+    // Reuse the storage for the next batch if the handler has not
+    // started one.
+    events.clear();
+    if (batch_.empty())
+      batch_.swap(events);
+  }
 }
 
 template <typename UDPStreamHandler, std::size_t Size>
@@ -105,6 +784,33 @@ template <typename UDPStreamHandler, std::size_t Size>
       return error;
   }
 
+  if constexpr (gro_())
+  {
+    if (auto gro = socket_option<int>(1);
+        setsockopt(socket, SOL_UDP, UDP_GRO, gro))
+    {
+      return {errno, std::system_category()};
+    }
+  }
+
+  if constexpr (rxq_overflow_())
+  {
+    if (auto overflow = socket_option<int>(1);
+        setsockopt(socket, SOL_SOCKET, SO_RXQ_OVFL, overflow))
+    {
+      return {errno, std::system_category()};
+    }
+  }
+
+  if constexpr (rx_timestamps_())
+  {
+    if (auto timestamps = socket_option<int>(1);
+        setsockopt(socket, SOL_SOCKET, SO_TIMESTAMPNS, timestamps))
+    {
+      return {errno, std::system_category()};
+    }
+  }
+
   if (bind(socket, address_))
     return {errno, std::system_category()};
 
@@ -0,0 +1,113 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file buffer_tuner_impl.hpp
+ * @brief This file defines a socket buffer size controller.
+ */
+#pragma once
+#ifndef CPPNET_BUFFER_TUNER_IMPL_HPP
+#define CPPNET_BUFFER_TUNER_IMPL_HPP
+#include "net/service/buffer_tuner.hpp"
+
+#include <algorithm>
+#include <climits>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+namespace net::service {
+inline buffer_tuner::buffer_tuner(async_context &ctx) noexcept
+    : buffer_tuner(ctx, config{})
+{}
+
+inline buffer_tuner::buffer_tuner(async_context &ctx, config cfg) noexcept
+    : ctx_{std::addressof(ctx)}, config_{cfg}
+{}
+
+inline auto buffer_tuner::add(const socket_dialog &socket) -> void
+{
+  connections_.push_back({.socket = socket.socket});
+  if (timer_ == timers::INVALID_TIMER)
+  {
+    timer_ = ctx_->timers.add(
+        config_.interval, [this](auto) { tune(); }, config_.interval);
+  }
+}
+
+inline auto buffer_tuner::tune() -> void
+{
+  std::erase_if(connections_, [&](auto &conn) { return !tune_(conn); });
+  if (connections_.empty())
+    timer_ = ctx_->timers.remove(timer_);
+}
+
+inline auto buffer_tuner::size() const noexcept -> std::size_t
+{
+  return connections_.size();
+}
+
+inline auto buffer_tuner::bdp(const net::detail::tcp_info_ext &info,
+                              std::size_t len) noexcept -> std::size_t
+{
+  using net::detail::tcp_info_ext;
+  constexpr auto usec_per_sec = 1'000'000UL;
+
+  const auto rtt = std::uint64_t{info.info.tcpi_rtt};
+  if (len >= offsetof(tcp_info_ext, tcpi_delivery_rate) +
+                 sizeof(info.tcpi_delivery_rate) &&
+      info.tcpi_delivery_rate > 0 && rtt > 0)
+  {
+    return info.tcpi_delivery_rate * rtt / usec_per_sec;
+  }
+
+  return std::size_t{info.info.tcpi_snd_cwnd} * info.info.tcpi_snd_mss;
+}
+
+inline auto buffer_tuner::tune_(connection &conn) const noexcept -> bool
+{
+  using namespace io::socket;
+
+  auto socket = conn.socket.lock();
+  if (!socket)
+    return false;
+
+  const auto sockfd = static_cast<native_socket_type>(*socket);
+  auto info = net::detail::tcp_info_ext{};
+  auto len = socklen_t{sizeof(info)};
+  if (::getsockopt(sockfd, IPPROTO_TCP, TCP_INFO, &info, &len))
+    return false;
+
+  auto estimate = static_cast<double>(bdp(info, len)) * config_.gain;
+  auto target = std::clamp(static_cast<std::size_t>(estimate),
+                           config_.min_buffer, config_.max_buffer);
+  target = std::min<std::size_t>(target, INT_MAX);
+
+  // Hysteresis: ignore changes of less than a quarter of the buffer.
+  auto delta = std::max(target, conn.buffer) - std::min(target, conn.buffer);
+  if (conn.buffer && delta <= conn.buffer / 4)
+    return true;
+
+  const auto size = static_cast<int>(target);
+  if (::setsockopt(sockfd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size)) ||
+      ::setsockopt(sockfd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)))
+  {
+    return false;
+  }
+
+  conn.buffer = target;
+  return true;
+}
+
+inline buffer_tuner::~buffer_tuner() { ctx_->timers.remove(timer_); }
+} // namespace net::service
+#endif // CPPNET_BUFFER_TUNER_IMPL_HPP
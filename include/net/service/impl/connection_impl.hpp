@@ -0,0 +1,348 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file connection_impl.hpp
+ * @brief This file defines a connection served by a coroutine.
+ */
+#pragma once
+#ifndef CPPNET_CONNECTION_IMPL_HPP
+#define CPPNET_CONNECTION_IMPL_HPP
+#include "net/detail/to_error_code.hpp"
+#include "net/service/connection.hpp"
+
+#include <exception>
+#include <new>
+#include <utility>
+
+#include <sys/socket.h>
+namespace net::service {
+template <typename Awaiter>
+auto connection::receiver<Awaiter>::env::query(
+    stdexec::get_stop_token_t) const noexcept -> stdexec::inplace_stop_token
+{
+  return ctx->scope.get_stop_token();
+}
+
+template <typename Awaiter>
+template <typename Length>
+auto connection::receiver<Awaiter>::set_value(Length len) && noexcept -> void
+{
+  awaiter->complete(static_cast<std::size_t>(len));
+}
+
+template <typename Awaiter>
+template <typename Error>
+auto connection::receiver<Awaiter>::set_error(Error error) && noexcept -> void
+{
+  awaiter->fail(net::detail::to_error_code(error));
+}
+
+template <typename Awaiter>
+auto connection::receiver<Awaiter>::set_stopped() && noexcept -> void
+{
+  awaiter->fail(std::make_error_code(std::errc::operation_canceled));
+}
+
+template <typename Awaiter>
+auto connection::receiver<Awaiter>::get_env() const noexcept -> env
+{
+  return {ctx};
+}
+
+inline connection::read_awaiter::read_awaiter(
+    connection &conn, std::span<std::byte> buffer) noexcept
+    : conn_{std::addressof(conn)}, msg_{.buffers = buffer}
+{}
+
+inline connection::read_awaiter::~read_awaiter()
+{
+  if (started_)
+    op_.destroy();
+}
+
+inline auto connection::read_awaiter::await_ready() noexcept -> bool
+{
+  return false;
+}
+
+inline auto
+connection::read_awaiter::await_suspend(std::coroutine_handle<> handle) -> bool
+{
+  handle_ = handle;
+  auto &op = op_.construct([&] {
+    return stdexec::connect(io::recvmsg(conn_->socket_, msg_, 0),
+                            receiver<read_awaiter>{this, conn_->ctx_});
+  });
+  started_ = true;
+
+  // A read that completes inside start() continues the coroutine here,
+  // rather than resuming it on top of this frame.
+  starting_ = true;
+  stdexec::start(op);
+  starting_ = false;
+  return !finished_;
+}
+
+inline auto connection::read_awaiter::await_resume() const noexcept
+    -> std::size_t
+{
+  return len_;
+}
+
+inline auto connection::read_awaiter::complete(std::size_t len) noexcept
+    -> void
+{
+  conn_->error_ = {};
+  len_ = len;
+  if (starting_)
+  {
+    finished_ = true;
+    return;
+  }
+  handle_.resume();
+}
+
+inline auto connection::read_awaiter::fail(std::error_code error) noexcept
+    -> void
+{
+  conn_->error_ = error;
+  if (starting_)
+  {
+    finished_ = true;
+    return;
+  }
+  handle_.resume();
+}
+
+inline connection::write_awaiter::write_awaiter(
+    connection &conn, std::span<const std::byte> buffer) noexcept
+    : conn_{std::addressof(conn)}, buffer_{buffer}
+{}
+
+inline connection::write_awaiter::~write_awaiter()
+{
+  for (std::size_t slot = 0; slot < ops_.size(); ++slot)
+  {
+    if (started_[slot])
+      ops_[slot].destroy();
+  }
+}
+
+inline auto connection::write_awaiter::await_ready() const noexcept -> bool
+{
+  return buffer_.empty();
+}
+
+inline auto
+connection::write_awaiter::await_suspend(std::coroutine_handle<> handle) -> bool
+{
+  handle_ = handle;
+  return !send_();
+}
+
+inline auto connection::write_awaiter::await_resume() const noexcept
+    -> std::size_t
+{
+  return written_;
+}
+
+inline auto connection::write_awaiter::complete(std::size_t len) noexcept
+    -> void
+{
+  written_ += len;
+  if (!len || written_ == buffer_.size())
+    return finish_({});
+
+  if (sending_)
+  {
+    resend_ = true;
+    return;
+  }
+
+  if (send_())
+    handle_.resume();
+}
+
+inline auto connection::write_awaiter::fail(std::error_code error) noexcept
+    -> void
+{
+  finish_(error);
+}
+
+inline auto connection::write_awaiter::send_() noexcept -> bool
+{
+  // The operation state that is completing can not be replaced from
+  // inside its own completion, so the next send uses the other one.
+  const auto slot = 1 - slot_;
+  sending_ = true;
+  do
+  {
+    resend_ = false;
+    try
+    {
+      submit_(slot);
+    }
+    catch (const std::bad_alloc &)
+    {
+      conn_->error_ = std::make_error_code(std::errc::not_enough_memory);
+      finished_ = true;
+    }
+  } while (resend_ && !finished_);
+  sending_ = false;
+  return finished_;
+}
+
+inline auto connection::write_awaiter::submit_(std::size_t slot) -> void
+{
+  if (std::exchange(started_[slot], false))
+    ops_[slot].destroy();
+
+  slot_ = slot;
+  msg_.buffers = buffer_.subspan(written_);
+  auto &op = ops_[slot].construct([&] {
+    return stdexec::connect(io::sendmsg(conn_->socket_, msg_, MSG_NOSIGNAL),
+                            receiver<write_awaiter>{this, conn_->ctx_});
+  });
+  started_[slot] = true;
+  stdexec::start(op);
+}
+
+inline auto connection::write_awaiter::finish_(std::error_code error) noexcept
+    -> void
+{
+  conn_->error_ = error;
+  if (sending_)
+  {
+    finished_ = true;
+    return;
+  }
+
+  handle_.resume();
+}
+
+inline connection::sleep_awaiter::sleep_awaiter(connection &conn,
+                                                duration interval) noexcept
+    : conn_{std::addressof(conn)}, interval_{interval}
+{}
+
+inline connection::sleep_awaiter::~sleep_awaiter()
+{
+  if (registered_)
+    stop_.destroy();
+}
+
+inline auto connection::sleep_awaiter::await_ready() const noexcept -> bool
+{
+  return interval_ <= duration::zero();
+}
+
+inline auto
+connection::sleep_awaiter::await_suspend(std::coroutine_handle<> handle) -> bool
+{
+  auto &ctx = *conn_->ctx_;
+  const auto token = ctx.scope.get_stop_token();
+  if (token.stop_requested())
+  {
+    conn_->error_ = std::make_error_code(std::errc::operation_canceled);
+    return false;
+  }
+
+  handle_ = handle;
+  timer_ = ctx.timers.add(interval_, [this](auto) {
+    timer_ = timers::INVALID_TIMER;
+    conn_->error_ = {};
+    handle_.resume();
+  });
+  stop_.construct([&] { return stop_callback(token, on_stop{this}); });
+  registered_ = true;
+  return true;
+}
+
+inline auto connection::sleep_awaiter::await_resume() noexcept -> void {}
+
+inline auto connection::sleep_awaiter::on_stop::operator()() const noexcept
+    -> void
+{
+  // Without this, a sleeping coroutine would never resume once the event
+  // loop stops, leaking its frame and the connection. The scope is
+  // stopped on the thread of the context, so the timer can be removed.
+  auto *conn = awaiter->conn_;
+  conn->ctx_->timers.remove(std::exchange(awaiter->timer_,
+                                          timers::INVALID_TIMER));
+  conn->error_ = std::make_error_code(std::errc::operation_canceled);
+  awaiter->handle_.resume();
+}
+
+inline connection::connection(async_context &ctx,
+                              socket_dialog socket) noexcept
+    : ctx_{std::addressof(ctx)}, socket_{std::move(socket)}
+{}
+
+inline auto connection::operator new(std::size_t size) -> void *
+{
+  return frame_pool::allocate(size);
+}
+
+inline auto connection::operator delete(void *ptr, std::size_t size) noexcept
+    -> void
+{
+  frame_pool::deallocate(ptr, size);
+}
+
+inline auto connection::read(std::span<std::byte> buffer) noexcept
+    -> read_awaiter
+{
+  return {*this, buffer};
+}
+
+inline auto connection::write(std::span<const std::byte> buffer) noexcept
+    -> write_awaiter
+{
+  return {*this, buffer};
+}
+
+template <typename Rep, typename Period>
+auto connection::sleep(std::chrono::duration<Rep, Period> interval) noexcept
+    -> sleep_awaiter
+{
+  return {*this, std::chrono::duration_cast<duration>(interval)};
+}
+
+inline auto connection::start(task<void> handler) noexcept -> void
+{
+  handler_ = std::move(handler);
+  handler_.start(&finish_, this);
+}
+
+inline auto connection::error() const noexcept -> std::error_code
+{
+  return error_;
+}
+
+inline auto connection::socket() const noexcept -> const socket_dialog &
+{
+  return socket_;
+}
+
+inline auto connection::context() const noexcept -> async_context &
+{
+  return *ctx_;
+}
+
+inline auto connection::finish_(void *conn) noexcept -> void
+{
+  delete static_cast<connection *>(conn);
+}
+} // namespace net::service
+#endif // CPPNET_CONNECTION_IMPL_HPP
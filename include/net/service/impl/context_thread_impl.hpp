@@ -22,6 +22,8 @@
 #include "net/service/context_thread.hpp"
 
 #include <stdexec/execution.hpp>
+
+#include <cassert>
 namespace net::service {
 template <ServiceLike Service>
 auto basic_context_thread<Service>::stop() noexcept -> void
@@ -50,6 +52,7 @@ auto basic_context_thread<Service>::start(Args &&...args) -> void
   auto error = std::error_code();
   server_ = std::thread([&] {
     auto service = Service{std::forward<Args>(args)...};
+    service_ = std::addressof(service);
     const auto token = scope.get_stop_token();
 
     isr(poller.emplace(sockets[0]), [&] {
@@ -83,6 +86,8 @@ auto basic_context_thread<Service>::start(Args &&...args) -> void
     }
 
     run();
+    // The service is destroyed when this thread returns.
+    service_ = nullptr;
     stop();
   });
 
@@ -91,6 +96,14 @@ auto basic_context_thread<Service>::start(Args &&...args) -> void
     throw std::system_error(error, "service failed to start");
 }
 
+template <ServiceLike Service>
+auto basic_context_thread<Service>::service() noexcept -> Service &
+{
+  auto *service = service_.load();
+  assert(service && "service must only be used while the thread runs.");
+  return *service;
+}
+
 template <ServiceLike Service>
 basic_context_thread<Service>::~basic_context_thread()
 {
@@ -0,0 +1,101 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file latency_histogram_impl.hpp
+ * @brief This file defines a lock-free latency histogram.
+ */
+#pragma once
+#ifndef CPPNET_LATENCY_HISTOGRAM_IMPL_HPP
+#define CPPNET_LATENCY_HISTOGRAM_IMPL_HPP
+#include "net/service/latency_histogram.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+namespace net::service {
+inline auto latency_histogram::record(duration latency) noexcept -> void
+{
+  const auto nanos = static_cast<std::uint64_t>(
+      std::max(latency.count(), duration::rep{0}));
+  counts_[index_(nanos)].fetch_add(1, std::memory_order_relaxed);
+}
+
+inline auto latency_histogram::count() const noexcept -> std::uint64_t
+{
+  auto total = std::uint64_t{0};
+  for (const auto &count : counts_)
+    total += count.load(std::memory_order_relaxed);
+  return total;
+}
+
+inline auto
+latency_histogram::percentile(double percentile) const noexcept -> duration
+{
+  const auto total = count();
+  if (!total)
+    return duration::zero();
+
+  const auto clamped = std::clamp(percentile, 0.0, 100.0);
+  const auto rank = std::max<std::uint64_t>(
+      1, static_cast<std::uint64_t>(
+             std::ceil(clamped / 100.0 * static_cast<double>(total))));
+
+  auto seen = std::uint64_t{0};
+  for (std::size_t index = 0; index < buckets; ++index)
+  {
+    seen += counts_[index].load(std::memory_order_relaxed);
+    if (seen >= rank)
+      return upper_bound(index);
+  }
+  return upper_bound(buckets - 1);
+}
+
+inline auto latency_histogram::bucket_count(std::size_t index) const noexcept
+    -> std::uint64_t
+{
+  return counts_[index].load(std::memory_order_relaxed);
+}
+
+inline auto latency_histogram::upper_bound(std::size_t index) noexcept
+    -> duration
+{
+  if (index < sub_buckets)
+    return duration(index);
+
+  const auto shift = index / sub_buckets - 1;
+  const auto lower = (sub_buckets + index % sub_buckets) << shift;
+  return duration(static_cast<duration::rep>(lower + (1UL << shift) - 1));
+}
+
+inline auto latency_histogram::reset() noexcept -> void
+{
+  for (auto &count : counts_)
+    count.store(0, std::memory_order_relaxed);
+}
+
+inline auto latency_histogram::index_(std::uint64_t nanos) noexcept
+    -> std::size_t
+{
+  if (nanos < sub_buckets)
+    return nanos;
+
+  // The three bits below the most significant bit pick the sub-bucket.
+  const auto msb = static_cast<std::size_t>(std::bit_width(nanos)) - 1;
+  const auto shift = msb - 3;
+  const auto index =
+      (shift + 1) * sub_buckets + ((nanos >> shift) & (sub_buckets - 1));
+  return std::min(index, buckets - 1);
+}
+} // namespace net::service
+#endif // CPPNET_LATENCY_HISTOGRAM_IMPL_HPP
@@ -0,0 +1,126 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file metrics_exporter_impl.hpp
+ * @brief This file defines an HTTP service that exports metrics.
+ */
+#pragma once
+#ifndef CPPNET_METRICS_EXPORTER_IMPL_HPP
+#define CPPNET_METRICS_EXPORTER_IMPL_HPP
+#include "net/service/metrics_exporter.hpp"
+
+#include <algorithm>
+#include <string>
+
+#include <sys/socket.h>
+namespace net::service {
+template <typename T>
+metrics_exporter::metrics_exporter(const metrics_registry &registry,
+                                   socket_address<T> address) noexcept
+    : Base(address), registry_{std::addressof(registry)}
+{}
+
+inline auto metrics_exporter::service(async_context &ctx,
+                                      const socket_dialog &socket,
+                                      std::shared_ptr<read_context> rctx,
+                                      std::span<const std::byte> buf) -> void
+{
+  if (!rctx)
+    return;
+
+  // Reads after the first are appended to the read buffer, so the whole
+  // request so far starts at the front of it.
+  const auto *begin = rctx->read_buffer.data();
+  const auto size = static_cast<std::size_t>(buf.data() + buf.size() - begin);
+  const auto request =
+      std::string_view(reinterpret_cast<const char *>(begin), size);
+
+  if (request.find("\r\n\r\n") == std::string_view::npos)
+  {
+    if (size < rctx->read_buffer.size())
+    {
+      auto rest = std::span(rctx->read_buffer).subspan(size);
+      submit_recv(ctx, socket, std::move(rctx), rest);
+      return;
+    }
+
+    constexpr auto too_large =
+        std::string_view("HTTP/1.1 431 Request Header Fields Too Large\r\n"
+                         "Content-Length: 0\r\nConnection: close\r\n\r\n");
+    return reply_(ctx, socket, {}, shared_buffer(too_large), 0);
+  }
+
+  reply_(ctx, socket, std::move(rctx), shared_buffer(respond(request)), 0);
+}
+
+inline auto
+metrics_exporter::respond(std::string_view request) const -> std::string
+{
+  const auto line = request.substr(0, request.find("\r\n"));
+  const auto method = line.substr(0, line.find(' '));
+  auto target = line.substr(std::min(method.size() + 1, line.size()));
+  target = target.substr(0, target.find(' '));
+  target = target.substr(0, target.find('?'));
+
+  auto response = std::string("HTTP/1.1 ");
+  auto body = std::string();
+  if (method != "GET")
+  {
+    response.append("405 Method Not Allowed\r\nAllow: GET\r\n");
+  }
+  else if (target != path)
+  {
+    response.append("404 Not Found\r\n");
+  }
+  else
+  {
+    body = registry_->expose();
+    response.append("200 OK\r\nContent-Type: text/plain; version=0.0.4; "
+                    "charset=utf-8\r\n");
+  }
+
+  response.append("Content-Length: ")
+      .append(std::to_string(body.size()))
+      .append("\r\n\r\n")
+      .append(body);
+  return response;
+}
+
+inline auto metrics_exporter::reply_(async_context &ctx,
+                                     const socket_dialog &socket,
+                                     std::shared_ptr<read_context> rctx,
+                                     shared_buffer response,
+                                     std::size_t offset) -> void
+{
+  using namespace stdexec;
+  using socket_message = io::socket::socket_message<>;
+
+  auto msg = socket_message{.buffers = response.span().subspan(offset)};
+  sender auto sendmsg =
+      io::sendmsg(socket, msg, MSG_NOSIGNAL) |
+      then([&, socket, rctx, response, offset](auto &&len) mutable {
+        auto sent = offset + static_cast<std::size_t>(len);
+        if (sent < response.size())
+          return reply_(ctx, socket, std::move(rctx), response, sent);
+
+        // Read the next request into the front of the read buffer.
+        if (rctx)
+          submit_recv(ctx, socket, rctx, rctx->read_buffer);
+      }) |
+      upon_error([](auto &&error) {});
+
+  ctx.scope.spawn(std::move(sendmsg));
+}
+} // namespace net::service
+#endif // CPPNET_METRICS_EXPORTER_IMPL_HPP
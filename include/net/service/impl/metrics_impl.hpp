@@ -0,0 +1,392 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file metrics_impl.hpp
+ * @brief This file defines a registry of Prometheus style metrics.
+ */
+#pragma once
+#ifndef CPPNET_METRICS_IMPL_HPP
+#define CPPNET_METRICS_IMPL_HPP
+#include "net/service/metrics.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <type_traits>
+
+#include <time.h>
+namespace net::service {
+namespace detail {
+/**
+ * @brief Appends a number in the text exposition format.
+ * @param out The string to append to.
+ * @param value The number to append.
+ */
+template <typename T> auto append_number(std::string &out, T value) -> void
+{
+  if constexpr (std::is_floating_point_v<T>)
+  {
+    if (std::isnan(value))
+    {
+      out.append("NaN");
+      return;
+    }
+
+    if (std::isinf(value))
+    {
+      out.append(value > 0 ? "+Inf" : "-Inf");
+      return;
+    }
+  }
+
+  auto buf = std::array<char, 32>{};
+  auto [end, ec] = std::to_chars(buf.data(), buf.data() + buf.size(), value);
+  out.append(buf.data(), end);
+}
+
+/**
+ * @brief Appends the HELP and TYPE lines of a metric.
+ * @param out The string to append to.
+ * @param name The metric name.
+ * @param help The metric description.
+ * @param type The metric type.
+ */
+inline auto append_header(std::string &out, std::string_view name,
+                          std::string_view help, std::string_view type) -> void
+{
+  out.append("# HELP ").append(name).push_back(' ');
+  for (auto chr : help)
+  {
+    if (chr == '\\')
+      out.append("\\\\");
+    else if (chr == '\n')
+      out.append("\\n");
+    else
+      out.push_back(chr);
+  }
+  out.append("\n# TYPE ").append(name).push_back(' ');
+  out.append(type).push_back('\n');
+}
+
+/** @returns The CPU time used by the calling thread. */
+inline auto thread_cpu_time() noexcept -> std::chrono::nanoseconds
+{
+  auto now = timespec{};
+  ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return std::chrono::seconds(now.tv_sec) +
+         std::chrono::nanoseconds(now.tv_nsec);
+}
+} // namespace detail.
+
+inline metrics_registry::counter::counter(std::string_view name,
+                                          std::string_view help)
+    : name_{name}, help_{help}
+{}
+
+inline auto metrics_registry::counter::add(std::uint64_t count) noexcept
+    -> void
+{
+  shards_[thread_shard()].value.fetch_add(count, std::memory_order_relaxed);
+}
+
+inline auto metrics_registry::counter::value() const noexcept -> std::uint64_t
+{
+  auto total = std::uint64_t{0};
+  for (const auto &shard : shards_)
+    total += shard.value.load(std::memory_order_relaxed);
+  return total;
+}
+
+inline auto metrics_registry::counter::expose(std::string &out) const -> void
+{
+  detail::append_header(out, name_, help_, "counter");
+  out.append(name_).push_back(' ');
+  detail::append_number(out, value());
+  out.push_back('\n');
+}
+
+inline auto metrics_registry::counter::name() const noexcept
+    -> std::string_view
+{
+  return name_;
+}
+
+inline metrics_registry::gauge::gauge(std::string_view name,
+                                      std::string_view help)
+    : name_{name}, help_{help}
+{}
+
+inline auto metrics_registry::gauge::set(double value) noexcept -> void
+{
+  value_.store(value, std::memory_order_relaxed);
+}
+
+inline auto metrics_registry::gauge::add(double value) noexcept -> void
+{
+  value_.fetch_add(value, std::memory_order_relaxed);
+}
+
+inline auto metrics_registry::gauge::value() const noexcept -> double
+{
+  return value_.load(std::memory_order_relaxed);
+}
+
+inline auto metrics_registry::gauge::expose(std::string &out) const -> void
+{
+  detail::append_header(out, name_, help_, "gauge");
+  out.append(name_).push_back(' ');
+  detail::append_number(out, value());
+  out.push_back('\n');
+}
+
+inline auto metrics_registry::gauge::name() const noexcept -> std::string_view
+{
+  return name_;
+}
+
+inline metrics_registry::histogram::histogram(std::string_view name,
+                                              std::string_view help,
+                                              std::vector<double> bounds)
+    : name_{name}, help_{help}, bounds_{std::move(bounds)}
+{
+  constexpr auto width = std::tuple_size_v<decltype(line::counts)>;
+  stride_ = (bounds_.size() + width) / width;
+  lines_ = std::make_unique<line[]>(stride_ * shards);
+}
+
+inline auto metrics_registry::histogram::observe(double value) noexcept
+    -> void
+{
+  const auto bucket = static_cast<std::size_t>(
+      std::ranges::lower_bound(bounds_, value) - bounds_.begin());
+  const auto index = thread_shard();
+  count_(index, bucket).fetch_add(1, std::memory_order_relaxed);
+  shards_[index].sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+template <typename Rep, typename Period>
+auto metrics_registry::histogram::observe(
+    std::chrono::duration<Rep, Period> value) noexcept -> void
+{
+  observe(std::chrono::duration<double>(value).count());
+}
+
+inline auto metrics_registry::histogram::count() const noexcept
+    -> std::uint64_t
+{
+  auto total = std::uint64_t{0};
+  for (std::size_t index = 0; index <= bounds_.size(); ++index)
+    total += bucket_count(index);
+  return total;
+}
+
+inline auto metrics_registry::histogram::sum() const noexcept -> double
+{
+  auto total = 0.0;
+  for (const auto &shard : shards_)
+    total += shard.sum.load(std::memory_order_relaxed);
+  return total;
+}
+
+inline auto metrics_registry::histogram::bucket_count(
+    std::size_t index) const noexcept -> std::uint64_t
+{
+  auto total = std::uint64_t{0};
+  for (std::size_t shard = 0; shard < shards; ++shard)
+    total += count_(shard, index).load(std::memory_order_relaxed);
+  return total;
+}
+
+inline auto metrics_registry::histogram::count_(
+    std::size_t shard, std::size_t index) const noexcept
+    -> std::atomic<std::uint64_t> &
+{
+  constexpr auto width = std::tuple_size_v<decltype(line::counts)>;
+  return lines_[(shard * stride_) + (index / width)].counts[index % width];
+}
+
+inline auto metrics_registry::histogram::bounds() const noexcept
+    -> const std::vector<double> &
+{
+  return bounds_;
+}
+
+inline auto metrics_registry::histogram::expose(std::string &out) const
+    -> void
+{
+  detail::append_header(out, name_, help_, "histogram");
+
+  // Bucket counts are cumulative in the exposition format.
+  auto cumulative = std::uint64_t{0};
+  for (std::size_t index = 0; index <= bounds_.size(); ++index)
+  {
+    cumulative += bucket_count(index);
+    out.append(name_).append("_bucket{le=\"");
+    if (index < bounds_.size())
+      detail::append_number(out, bounds_[index]);
+    else
+      out.append("+Inf");
+    out.append("\"} ");
+    detail::append_number(out, cumulative);
+    out.push_back('\n');
+  }
+
+  out.append(name_).append("_sum ");
+  detail::append_number(out, sum());
+  out.append("\n").append(name_).append("_count ");
+  detail::append_number(out, cumulative);
+  out.push_back('\n');
+}
+
+inline auto metrics_registry::histogram::name() const noexcept
+    -> std::string_view
+{
+  return name_;
+}
+
+inline auto metrics_registry::add_counter(std::string_view name,
+                                          std::string_view help) -> counter &
+{
+  return add_<counter>(name, help);
+}
+
+inline auto metrics_registry::add_gauge(std::string_view name,
+                                        std::string_view help) -> gauge &
+{
+  return add_<gauge>(name, help);
+}
+
+inline auto metrics_registry::add_histogram(std::string_view name,
+                                            std::string_view help,
+                                            std::vector<double> bounds)
+    -> histogram &
+{
+  return add_<histogram>(name, help, std::move(bounds));
+}
+
+inline auto metrics_registry::expose() const -> std::string
+{
+  auto out = std::string();
+  auto lock = std::lock_guard(mtx_);
+  for (const auto &metric : metrics_)
+    std::visit([&](const auto &value) { value.expose(out); }, metric);
+  return out;
+}
+
+inline auto metrics_registry::default_buckets() -> std::vector<double>
+{
+  return {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01,
+          0.025,  0.05,    0.1,    0.25,  0.5,    1,     2.5,
+          5,      10};
+}
+
+inline auto metrics_registry::exponential_buckets(double start, double factor,
+                                                  std::size_t count)
+    -> std::vector<double>
+{
+  auto bounds = std::vector<double>(count);
+  for (auto &bound : bounds)
+  {
+    bound = start;
+    start *= factor;
+  }
+  return bounds;
+}
+
+inline auto metrics_registry::thread_shard() noexcept -> std::size_t
+{
+  static auto next = std::atomic<std::size_t>{0};
+  thread_local const auto index =
+      next.fetch_add(1, std::memory_order_relaxed) % shards;
+  return index;
+}
+
+template <typename Metric, typename... Args>
+auto metrics_registry::add_(std::string_view name,
+                            Args &&...args) -> Metric &
+{
+  auto lock = std::lock_guard(mtx_);
+  for (auto &metric : metrics_)
+  {
+    auto found = std::visit(
+        [&](const auto &value) { return value.name() == name; }, metric);
+    if (found)
+      return std::get<Metric>(metric);
+  }
+
+  return std::get<Metric>(metrics_.emplace_back(
+      std::in_place_type<Metric>, name, std::forward<Args>(args)...));
+}
+
+inline tcp_metrics::tcp_metrics(metrics_registry &registry,
+                                std::string_view prefix)
+    : accepted{registry.add_counter(
+          std::string(prefix) + "_connections_accepted_total",
+          "Connections accepted.")},
+      closed{registry.add_counter(
+          std::string(prefix) + "_connections_closed_total",
+          "Connections closed by the peer or on error.")},
+      bytes{registry.add_counter(std::string(prefix) + "_received_bytes_total",
+                                 "Bytes read from connections.")}
+{}
+
+inline loop_metrics::loop_metrics(metrics_registry &registry,
+                                  std::string_view prefix)
+    : utilization_{registry.add_gauge(
+          std::string(prefix) + "_utilization",
+          "Fraction of time the event loop was busy.")},
+      lateness_{registry.add_histogram(
+          std::string(prefix) + "_timer_lateness_seconds",
+          "How late timers fire after they are due.")}
+{}
+
+inline auto loop_metrics::start(async_context &ctx,
+                                timers::duration interval) -> void
+{
+  stop();
+  ctx_ = std::addressof(ctx);
+  interval_ = interval;
+  due_ = timers::clock::now() + interval;
+  timer_ = ctx.timers.add(
+      due_, [this](timers::timer_id) { sample_(); }, interval);
+}
+
+inline auto loop_metrics::stop() noexcept -> void
+{
+  if (ctx_ && timer_ != timers::INVALID_TIMER)
+    timer_ = ctx_->timers.remove(timer_);
+  cpu_ = std::chrono::nanoseconds(-1);
+}
+
+inline loop_metrics::~loop_metrics() { stop(); }
+
+inline auto loop_metrics::sample_() noexcept -> void
+{
+  using seconds = std::chrono::duration<double>;
+  const auto now = timers::clock::now();
+  const auto cpu = detail::thread_cpu_time();
+
+  lateness_.observe(now - due_);
+  due_ += interval_;
+
+  if (cpu_.count() >= 0 && now > wall_)
+  {
+    const auto busy = seconds(cpu - cpu_) / seconds(now - wall_);
+    utilization_.set(std::clamp(busy, 0.0, 1.0));
+  }
+  cpu_ = cpu;
+  wall_ = now;
+}
+} // namespace net::service
+#endif // CPPNET_METRICS_IMPL_HPP
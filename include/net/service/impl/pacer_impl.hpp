@@ -0,0 +1,228 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file pacer_impl.hpp
+ * @brief This file defines a token bucket egress pacer.
+ */
+#pragma once
+#ifndef CPPNET_PACER_IMPL_HPP
+#define CPPNET_PACER_IMPL_HPP
+#include "net/service/pacer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <utility>
+namespace net::service {
+inline pacer::pacer(std::size_t rate, std::size_t burst) noexcept
+    : rate_{static_cast<double>(std::max<std::size_t>(rate, 1))},
+      burst_{static_cast<double>(burst)}
+{}
+
+inline auto pacer::send(async_context &ctx, flow_type flow, std::size_t size,
+                        send_function send) -> void
+{
+  ctx_ = std::addressof(ctx);
+  const auto now = timers::clock::now();
+  auto [it, inserted] =
+      flows_.try_emplace(flow, flow_state{.tokens = burst_, .updated = now});
+  auto &state = it->second;
+
+  refill_(state, now);
+  const auto need = std::min(static_cast<double>(size), burst_);
+  if (state.head == NONE && state.tokens >= need)
+  {
+    state.tokens -= static_cast<double>(size);
+    // Remember the flow until its bucket is full again.
+    if (!state.scheduled)
+      schedule_(flow, state, due_(state, 0, now));
+    return send();
+  }
+
+  auto index = NONE;
+  if (free_.empty())
+  {
+    index = static_cast<std::uint32_t>(pool_.size());
+    pool_.push_back({.size = size, .send = std::move(send)});
+  }
+  else
+  {
+    index = free_.back();
+    free_.pop_back();
+    pool_[index] = {.size = size, .send = std::move(send)};
+  }
+
+  if (state.tail == NONE)
+    state.head = index;
+  else
+    pool_[state.tail].next = index;
+  state.tail = index;
+
+  if (!state.scheduled)
+    schedule_(flow, state, due_(state, size, now));
+}
+
+inline auto pacer::forget(flow_type flow) -> void
+{
+  auto it = flows_.find(flow);
+  if (it == flows_.end())
+    return;
+
+  // The flow's release heap entry is skipped once the flow is gone.
+  for (auto index = it->second.head; index != NONE;)
+  {
+    const auto next = pool_[index].next;
+    pool_[index] = {};
+    free_.push_back(index);
+    index = next;
+  }
+  flows_.erase(it);
+}
+
+inline auto pacer::pending() const noexcept -> std::size_t
+{
+  return pool_.size() - free_.size();
+}
+
+inline auto pacer::flows() const noexcept -> std::size_t
+{
+  return flows_.size();
+}
+
+inline auto pacer::flow_of(const socket_address &peer) noexcept -> flow_type
+{
+  const auto &address = *peer;
+  if (address.sin6_family == AF_INET)
+  {
+    const auto *ipv4 = reinterpret_cast<const sockaddr_in *>(&address);
+    return (flow_type{AF_INET} << 48U) |
+           (flow_type{ipv4->sin_addr.s_addr} << 16U) | ipv4->sin_port;
+  }
+
+  // Multiply-xorshift mixing of the address words.
+  constexpr auto K0 = 0x9E3779B97F4A7C15ULL;
+  constexpr auto K1 = 0xC2B2AE3D27D4EB4FULL;
+  auto words = std::array<std::uint64_t, 2>{};
+  std::memcpy(words.data(), &address.sin6_addr, sizeof(words));
+  auto hash = (words[0] * K0) ^ (words[1] * K1) ^ address.sin6_port;
+  hash ^= hash >> 29U;
+  return hash;
+}
+
+inline pacer::~pacer()
+{
+  if (ctx_ && timer_ != timers::INVALID_TIMER)
+    ctx_->timers.remove(timer_);
+}
+
+inline auto pacer::refill_(flow_state &state,
+                           timers::timestamp now) const noexcept -> void
+{
+  using seconds = std::chrono::duration<double>;
+  const auto elapsed = seconds(now - state.updated).count();
+  state.tokens = std::min(burst_, state.tokens + elapsed * rate_);
+  state.updated = now;
+}
+
+inline auto pacer::due_(const flow_state &state, std::size_t size,
+                        timers::timestamp now) const noexcept
+    -> timers::timestamp
+{
+  using seconds = std::chrono::duration<double>;
+  const auto need =
+      size ? std::min(static_cast<double>(size), burst_) : burst_;
+  const auto wait = seconds(std::max(need - state.tokens, 0.0) / rate_);
+  return now + std::chrono::ceil<timers::duration>(wait);
+}
+
+inline auto pacer::schedule_(flow_type flow, flow_state &state,
+                             timers::timestamp at) -> void
+{
+  state.scheduled = true;
+  releases_.push({.at = at, .flow = flow});
+  if (!releasing_)
+    arm_();
+}
+
+inline auto pacer::arm_() -> void
+{
+  if (releases_.empty())
+    return;
+
+  const auto at = releases_.top().at;
+  if (timer_ != timers::INVALID_TIMER)
+  {
+    if (armed_at_ <= at)
+      return;
+    ctx_->timers.remove(timer_);
+  }
+
+  armed_at_ = at;
+  timer_ = ctx_->timers.add(at, [this](timers::timer_id) {
+    timer_ = timers::INVALID_TIMER;
+    release_(timers::clock::now());
+  });
+}
+
+inline auto pacer::release_(timers::timestamp now) -> void
+{
+  releasing_ = true;
+  while (!releases_.empty() && releases_.top().at <= now)
+  {
+    const auto flow = releases_.top().flow;
+    releases_.pop();
+
+    auto it = flows_.find(flow);
+    if (it == flows_.end())
+      continue;
+
+    // Sends may add flows, which invalidates it but not state.
+    auto &state = it->second;
+    state.scheduled = false;
+    refill_(state, now);
+    while (state.head != NONE)
+    {
+      const auto index = state.head;
+      const auto size = pool_[index].size;
+      if (state.tokens < std::min(static_cast<double>(size), burst_))
+        break;
+
+      auto send = std::move(pool_[index].send);
+      state.head = pool_[index].next;
+      if (state.head == NONE)
+        state.tail = NONE;
+      pool_[index] = {};
+      free_.push_back(index);
+
+      state.tokens -= static_cast<double>(size);
+      send();
+    }
+
+    if (state.scheduled)
+      continue;
+
+    if (state.head != NONE)
+      schedule_(flow, state, due_(state, pool_[state.head].size, now));
+    else if (state.tokens >= burst_)
+      flows_.erase(flow);
+    else
+      schedule_(flow, state, due_(state, 0, now));
+  }
+
+  releasing_ = false;
+  arm_();
+}
+} // namespace net::service
+#endif // CPPNET_PACER_IMPL_HPP
@@ -0,0 +1,79 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file pipeline_impl.hpp
+ * @brief This file defines a compile-time middleware pipeline.
+ */
+#pragma once
+#ifndef CPPNET_PIPELINE_IMPL_HPP
+#define CPPNET_PIPELINE_IMPL_HPP
+#include "net/service/pipeline.hpp"
+
+#include <memory>
+#include <utility>
+namespace net::service {
+template <typename... Stages>
+template <std::size_t I, typename Last>
+pipeline<Stages...>::continuation<I, Last>::continuation(pipeline &self,
+                                                         Last &last) noexcept
+    : self_{std::addressof(self)}, last_{std::addressof(last)}
+{}
+
+template <typename... Stages>
+template <std::size_t I, typename Last>
+template <typename... Args>
+auto pipeline<Stages...>::continuation<I, Last>::operator()(
+    Args &&...args) const -> void
+{
+  if constexpr (I == size)
+  {
+    (*last_)(std::forward<Args>(args)...);
+  }
+  else
+  {
+    std::get<I>(self_->stages_)(continuation<I + 1, Last>(*self_, *last_),
+                                std::forward<Args>(args)...);
+  }
+}
+
+template <typename... Stages>
+pipeline<Stages...>::pipeline(Stages... stages)
+  requires(size > 0)
+    : stages_{std::move(stages)...}
+{}
+
+template <typename... Stages>
+template <typename Last, typename... Args>
+auto pipeline<Stages...>::operator()(Last &&last, Args &&...args) -> void
+{
+  continuation<0, std::remove_reference_t<Last>>(*this, last)(
+      std::forward<Args>(args)...);
+}
+
+template <typename... Stages>
+template <std::size_t I>
+auto pipeline<Stages...>::get() noexcept
+    -> std::tuple_element_t<I, stages_type> &
+{
+  return std::get<I>(stages_);
+}
+
+template <typename... Stages>
+template <typename Stage>
+auto pipeline<Stages...>::get() noexcept -> Stage &
+{
+  return std::get<Stage>(stages_);
+}
+} // namespace net::service
+#endif // CPPNET_PIPELINE_IMPL_HPP
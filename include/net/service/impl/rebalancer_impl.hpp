@@ -0,0 +1,70 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file rebalancer_impl.hpp
+ * @brief This file defines a connection rebalancer.
+ */
+#pragma once
+#ifndef CPPNET_REBALANCER_IMPL_HPP
+#define CPPNET_REBALANCER_IMPL_HPP
+#include "net/detail/with_lock.hpp"
+#include "net/service/rebalancer.hpp"
+
+#include <algorithm>
+namespace net::service {
+template <typename Service>
+rebalancer<Service>::rebalancer(double tolerance, std::size_t batch) noexcept
+    : tolerance_{tolerance}, batch_{batch}
+{}
+
+template <typename Service>
+auto rebalancer<Service>::add(async_context &ctx, Service &service) -> void
+{
+  using net::detail::with_lock;
+  with_lock(mtx_, [&] {
+    loops_.push_back({.ctx = std::addressof(ctx),
+                      .service = std::addressof(service),
+                      .reads = service.reads()});
+  });
+}
+
+template <typename Service> auto rebalancer<Service>::rebalance() -> bool
+{
+  using net::detail::with_lock;
+  return with_lock(mtx_, [&] {
+    if (loops_.size() < 2)
+      return false;
+
+    auto total = 0.0;
+    for (auto &entry : loops_)
+    {
+      auto reads = entry.service->reads();
+      entry.load = reads - std::exchange(entry.reads, reads);
+      total += static_cast<double>(entry.load);
+    }
+
+    auto [coldest, hottest] = std::ranges::minmax_element(
+        loops_, {}, [](const loop &entry) { return entry.load; });
+
+    const auto mean = total / static_cast<double>(loops_.size());
+    if (!hottest->load ||
+        static_cast<double>(hottest->load) <= tolerance_ * mean)
+      return false;
+
+    hottest->service->shed(*coldest->ctx, *coldest->service, batch_);
+    return true;
+  });
+}
+} // namespace net::service
+#endif // CPPNET_REBALANCER_IMPL_HPP
@@ -0,0 +1,119 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file request_lifecycle_impl.hpp
+ * @brief This file defines sampled request lifecycle timing.
+ */
+#pragma once
+#ifndef CPPNET_REQUEST_LIFECYCLE_IMPL_HPP
+#define CPPNET_REQUEST_LIFECYCLE_IMPL_HPP
+#include "net/service/request_lifecycle.hpp"
+namespace net::service {
+inline request_lifecycle::request_lifecycle(std::size_t sample_every) noexcept
+    : sample_every_{sample_every}
+{}
+
+inline auto request_lifecycle::accepted(stamps &stamps) noexcept -> void
+{
+  stamps.accepted = sample_(connections_) ? clock::now() : timestamp{};
+}
+
+inline auto request_lifecycle::readable(stamps &stamps) noexcept -> void
+{
+  // A sampled request keeps its stamps until its send completes, so the
+  // reads that follow it don't restart its timing.
+  if (stamps.sampled)
+    return;
+
+  const auto first = stamps.accepted != timestamp{};
+  stamps.sampled = sample_(requests_);
+  if (!stamps.sampled && !first)
+    return;
+
+  stamps.readable = clock::now();
+  if (first)
+  {
+    record_(first_byte, stamps.accepted, stamps.readable);
+    stamps.accepted = {};
+  }
+}
+
+inline auto request_lifecycle::entered(stamps &stamps) noexcept -> void
+{
+  if (!stamps.sampled)
+    return;
+
+  stamps.entered = clock::now();
+  record_(dispatch, stamps.readable, stamps.entered);
+}
+
+inline auto request_lifecycle::exited(stamps &stamps) noexcept -> void
+{
+  if (stamps.sampled)
+    record_(service, stamps.entered, clock::now());
+}
+
+inline auto request_lifecycle::submitted(stamps &stamps) noexcept -> void
+{
+  if (!stamps.sampled)
+    return;
+
+  stamps.submitted = clock::now();
+  record_(submit, stamps.readable, stamps.submitted);
+}
+
+inline auto request_lifecycle::completed(stamps &stamps) noexcept -> void
+{
+  if (!stamps.sampled)
+    return;
+
+  const auto now = clock::now();
+  record_(send, stamps.submitted, now);
+  record_(total, stamps.readable, now);
+  stamps.sampled = false;
+}
+
+inline auto request_lifecycle::histogram(phase which) const noexcept
+    -> const latency_histogram &
+{
+  return phases_[which];
+}
+
+inline auto request_lifecycle::reset() noexcept -> void
+{
+  for (auto &phase : phases_)
+    phase.reset();
+}
+
+inline auto request_lifecycle::record_(phase which, timestamp from,
+                                       timestamp to) noexcept -> void
+{
+  phases_[which].record(
+      std::chrono::duration_cast<latency_histogram::duration>(to - from));
+}
+
+inline auto request_lifecycle::sample_(std::size_t &sequence) const noexcept
+    -> bool
+{
+  if (!sample_every_)
+    return false;
+
+  if (++sequence < sample_every_)
+    return false;
+
+  sequence = 0;
+  return true;
+}
+} // namespace net::service
+#endif // CPPNET_REQUEST_LIFECYCLE_IMPL_HPP
@@ -0,0 +1,209 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file session_table_impl.hpp
+ * @brief This file defines a table of per-peer session state.
+ */
+#pragma once
+#ifndef CPPNET_SESSION_TABLE_IMPL_HPP
+#define CPPNET_SESSION_TABLE_IMPL_HPP
+#include "net/service/session_table.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+namespace net::service {
+template <typename State>
+session_table<State>::session_table(duration timeout) noexcept
+    : timeout_{timeout}
+{}
+
+template <typename State>
+auto session_table<State>::get(const socket_address &peer,
+                               timestamp now) -> State &
+{
+  const auto key = make_key(peer);
+  const auto hash = session_table::hash(key);
+  if (2 * (entries_.size() + 1) > slots_.size())
+    grow_();
+
+  auto &slot = slots_[probe_(key, hash)];
+  if (!slot.index)
+  {
+    entries_.push_back({.key = key, .last_seen = now, .state = State{}});
+    slot = {.hash = hash, .index = static_cast<std::uint32_t>(entries_.size())};
+  }
+
+  auto &session = entries_[slot.index - 1];
+  session.last_seen = now;
+  return session.state;
+}
+
+template <typename State>
+auto session_table<State>::find(const socket_address &peer) noexcept
+    -> State *
+{
+  if (slots_.empty())
+    return nullptr;
+
+  const auto key = make_key(peer);
+  const auto &slot = slots_[probe_(key, hash(key))];
+  return slot.index ? std::addressof(entries_[slot.index - 1].state)
+                    : nullptr;
+}
+
+template <typename State>
+auto session_table<State>::erase(const socket_address &peer) -> bool
+{
+  if (slots_.empty())
+    return false;
+
+  const auto key = make_key(peer);
+  const auto &slot = slots_[probe_(key, hash(key))];
+  if (!slot.index)
+    return false;
+
+  erase_(slot.index - 1);
+  return true;
+}
+
+template <typename State>
+auto session_table<State>::expire(timestamp now) -> std::size_t
+{
+  const auto before = size();
+  // Erasing moves the last session into the erased position, so walk
+  // backwards over sessions that have already been checked.
+  for (auto index = entries_.size(); index-- > 0;)
+  {
+    if (now - entries_[index].last_seen > timeout_)
+      erase_(index);
+  }
+  return before - size();
+}
+
+template <typename State>
+auto session_table<State>::size() const noexcept -> std::size_t
+{
+  return entries_.size();
+}
+
+template <typename State>
+auto session_table<State>::timeout() const noexcept -> duration
+{
+  return timeout_;
+}
+
+template <typename State>
+auto session_table<State>::make_key(const socket_address &peer) noexcept
+    -> key_type
+{
+  auto key = key_type{};
+  const auto &address = *peer;
+  if (address.sin6_family == AF_INET)
+  {
+    const auto *ipv4 = reinterpret_cast<const sockaddr_in *>(&address);
+    key.address[0] = ipv4->sin_addr.s_addr;
+    key.port_family = ipv4->sin_port;
+  }
+  else
+  {
+    std::memcpy(key.address.data(), &address.sin6_addr, sizeof(key.address));
+    key.port_family = address.sin6_port;
+  }
+
+  key.port_family |= static_cast<std::uint32_t>(address.sin6_family) << 16U;
+  return key;
+}
+
+template <typename State>
+auto session_table<State>::hash(const key_type &key) noexcept -> std::uint32_t
+{
+  // Multiply-xorshift mixing of the key words.
+  constexpr auto K0 = 0x9E3779B97F4A7C15ULL;
+  constexpr auto K1 = 0xC2B2AE3D27D4EB4FULL;
+  constexpr auto K2 = 0x165667B19E3779F9ULL;
+  const auto &[a, port_family] = key;
+
+  auto hash = ((std::uint64_t{a[0]} << 32U) | a[1]) * K0;
+  hash ^= ((std::uint64_t{a[2]} << 32U) | a[3]) * K1;
+  hash ^= std::uint64_t{port_family} * K2;
+  hash ^= hash >> 29U;
+  return static_cast<std::uint32_t>(hash ^ (hash >> 32U));
+}
+
+template <typename State>
+auto session_table<State>::probe_(const key_type &key,
+                                  std::uint32_t hash) const noexcept
+    -> std::size_t
+{
+  const auto mask = slots_.size() - 1;
+  for (auto pos = std::size_t{hash} & mask;; pos = (pos + 1) & mask)
+  {
+    const auto &slot = slots_[pos];
+    if (!slot.index ||
+        (slot.hash == hash && entries_[slot.index - 1].key == key))
+    {
+      return pos;
+    }
+  }
+}
+
+template <typename State>
+auto session_table<State>::erase_(std::size_t index) noexcept -> void
+{
+  const auto mask = slots_.size() - 1;
+  auto &session = entries_[index];
+
+  // Backward shift deletion: pull later slots of the probe sequence into
+  // the hole so that lookups never stop early.
+  auto hole = probe_(session.key, hash(session.key));
+  for (auto pos = (hole + 1) & mask; slots_[pos].index; pos = (pos + 1) & mask)
+  {
+    const auto home = std::size_t{slots_[pos].hash} & mask;
+    if (((pos - home) & mask) >= ((pos - hole) & mask))
+    {
+      slots_[hole] = slots_[pos];
+      hole = pos;
+    }
+  }
+  slots_[hole] = {};
+
+  const auto last = entries_.size() - 1;
+  if (index != last)
+  {
+    auto &moved = entries_[last];
+    slots_[probe_(moved.key, hash(moved.key))].index =
+        static_cast<std::uint32_t>(index + 1);
+    session = std::move(moved);
+  }
+  entries_.pop_back();
+}
+
+template <typename State> auto session_table<State>::grow_() -> void
+{
+  constexpr auto min_slots = 16UL;
+  auto slots = std::vector<slot>(std::max(min_slots, 2 * slots_.size()));
+  const auto mask = slots.size() - 1;
+  for (std::size_t index = 0; index < entries_.size(); ++index)
+  {
+    const auto hash = session_table::hash(entries_[index].key);
+    auto pos = std::size_t{hash} & mask;
+    while (slots[pos].index)
+      pos = (pos + 1) & mask;
+    slots[pos] = {.hash = hash, .index = static_cast<std::uint32_t>(index + 1)};
+  }
+  slots_ = std::move(slots);
+}
+} // namespace net::service
+#endif // CPPNET_SESSION_TABLE_IMPL_HPP
@@ -0,0 +1,63 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file shared_buffer_impl.hpp
+ * @brief This file defines an immutable reference-counted buffer.
+ */
+#pragma once
+#ifndef CPPNET_SHARED_BUFFER_IMPL_HPP
+#define CPPNET_SHARED_BUFFER_IMPL_HPP
+#include "net/service/shared_buffer.hpp"
+
+#include <algorithm>
+namespace net::service {
+inline shared_buffer::shared_buffer(std::span<const std::byte> bytes)
+    : size_{bytes.size()}
+{
+  auto tmp = std::make_shared_for_overwrite<std::byte[]>(size_);
+  std::ranges::copy(bytes, tmp.get());
+  bytes_ = std::move(tmp);
+}
+
+inline shared_buffer::shared_buffer(std::string_view str)
+    : shared_buffer(std::as_bytes(std::span(str)))
+{}
+
+inline auto shared_buffer::data() const noexcept -> const std::byte *
+{
+  return bytes_.get();
+}
+
+inline auto shared_buffer::size() const noexcept -> std::size_t
+{
+  return size_;
+}
+
+inline auto shared_buffer::empty() const noexcept -> bool
+{
+  return size_ == 0;
+}
+
+inline auto
+shared_buffer::span() const noexcept -> std::span<const std::byte>
+{
+  return {bytes_.get(), size_};
+}
+
+inline auto shared_buffer::use_count() const noexcept -> long
+{
+  return bytes_.use_count();
+}
+} // namespace net::service
+#endif // CPPNET_SHARED_BUFFER_IMPL_HPP
@@ -0,0 +1,201 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file shared_listener_impl.hpp
+ * @brief This file defines a listening socket shared by context threads.
+ */
+#pragma once
+#ifndef CPPNET_SHARED_LISTENER_IMPL_HPP
+#define CPPNET_SHARED_LISTENER_IMPL_HPP
+#include "net/service/shared_listener.hpp"
+
+#include <algorithm>
+
+#include <fcntl.h>
+namespace net::service {
+template <typename T>
+shared_listener::shared_listener(socket_address<T> address) noexcept
+    : address_{address}
+{}
+
+template <typename Fn>
+  requires std::is_invocable_r_v<std::error_code, Fn,
+                                 const shared_listener::socket_handle &>
+auto shared_listener::open(Fn &&initialize) -> std::error_code
+{
+  using namespace io;
+  using namespace io::socket;
+
+  auto lock = std::lock_guard{mtx_};
+  if (socket_)
+    return {};
+
+  auto sock = socket_handle(address_->sin6_family, SOCK_STREAM, 0);
+  if (auto error = std::forward<Fn>(initialize)(sock))
+    return error;
+
+  // Every participant drains the accept queue until it would block, so
+  // the socket must be non-blocking. The flag is shared by the duplicates.
+  const auto sockfd = static_cast<native_socket_type>(sock);
+  const auto flags = ::fcntl(sockfd, F_GETFL);
+  if (flags < 0 || ::fcntl(sockfd, F_SETFL, flags | O_NONBLOCK) < 0)
+    return {errno, std::system_category()};
+
+  address_ = getsockname(sock, address_);
+  socket_.emplace(std::move(sock));
+  return {};
+}
+
+inline auto shared_listener::join(const void *id, async_context &ctx,
+                                  std::function<void()> arm) -> void
+{
+  auto holder = std::optional<participant>{};
+  {
+    auto lock = std::lock_guard{mtx_};
+    participants_.push_back(
+        {.id = id, .ctx = std::addressof(ctx), .arm = std::move(arm)});
+    if (!token_)
+      holder = hand_to_(participants_.size() - 1);
+  }
+
+  if (holder)
+    holder->arm();
+}
+
+inline auto shared_listener::pass(const void *id) -> void
+{
+  auto holder = std::optional<participant>{};
+  auto handoff = std::uint64_t{};
+  async_context *from = nullptr;
+  {
+    auto lock = std::lock_guard{mtx_};
+    if (token_ != id)
+      return;
+
+    auto it = std::ranges::find(participants_, id, &participant::id);
+    auto index = std::distance(participants_.begin(), it);
+    from = it->ctx;
+    holder = hand_to_((index + 1) % participants_.size());
+    handoff = handoff_;
+  }
+
+  // A lone participant is already on the right context.
+  if (holder->id == id)
+    return holder->arm();
+
+  arm_(*holder, handoff, from);
+}
+
+inline auto shared_listener::leave(const void *id) -> void
+{
+  auto holder = std::optional<participant>{};
+  auto handoff = std::uint64_t{};
+  {
+    auto lock = std::lock_guard{mtx_};
+    auto it = std::ranges::find(participants_, id, &participant::id);
+    if (it == participants_.end())
+      return;
+
+    auto index = std::distance(participants_.begin(), it);
+    participants_.erase(it);
+    if (token_ == id)
+    {
+      token_ = nullptr;
+      if (!participants_.empty())
+        holder = hand_to_(index % participants_.size());
+      handoff = handoff_;
+    }
+  }
+
+  // The leaving context is stopping, so it can not pass the token on
+  // again if the new holder is busy.
+  if (holder)
+    arm_(*holder, handoff, nullptr);
+}
+
+inline auto shared_listener::address() const -> socket_address<sockaddr_in6>
+{
+  auto lock = std::lock_guard{mtx_};
+  return address_;
+}
+
+inline auto shared_listener::native_handle() const -> socket_type
+{
+  using namespace io::socket;
+  auto lock = std::lock_guard{mtx_};
+  return socket_ ? static_cast<socket_type>(*socket_) : INVALID_SOCKET;
+}
+
+inline auto
+shared_listener::hand_to_(std::size_t index) -> std::optional<participant>
+{
+  ++handoff_;
+  armed_ = false;
+  if (index >= participants_.size())
+  {
+    token_ = nullptr;
+    return std::nullopt;
+  }
+
+  token_ = participants_[index].id;
+  return participants_[index];
+}
+
+inline auto shared_listener::arm_(const participant &holder,
+                                  std::uint64_t handoff,
+                                  async_context *from) -> void
+{
+  // Arm the holder on its own context. The token may move on before the
+  // timer fires, so check it again.
+  holder.ctx->timers.add(
+      timers::duration::zero(),
+      [this, id = holder.id, arm = holder.arm, handoff](auto) {
+        {
+          auto lock = std::lock_guard{mtx_};
+          if (token_ != id || handoff_ != handoff)
+            return;
+          armed_ = true;
+        }
+        arm();
+      });
+
+  if (from)
+  {
+    from->timers.add(handoff_timeout, [this, id = holder.id, handoff,
+                                       from](auto) {
+      skip_(id, handoff, from);
+    });
+  }
+}
+
+inline auto shared_listener::skip_(const void *id, std::uint64_t handoff,
+                                   async_context *from) -> void
+{
+  auto holder = std::optional<participant>{};
+  auto next = std::uint64_t{};
+  {
+    auto lock = std::lock_guard{mtx_};
+    if (token_ != id || handoff_ != handoff || armed_)
+      return;
+
+    auto it = std::ranges::find(participants_, id, &participant::id);
+    auto index = std::distance(participants_.begin(), it);
+    holder = hand_to_((index + 1) % participants_.size());
+    next = handoff_;
+  }
+
+  arm_(*holder, next, from);
+}
+} // namespace net::service
+#endif // CPPNET_SHARED_LISTENER_IMPL_HPP
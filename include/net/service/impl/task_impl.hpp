@@ -0,0 +1,269 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file task_impl.hpp
+ * @brief This file defines a lazy coroutine task with pooled frames.
+ */
+#pragma once
+#ifndef CPPNET_TASK_IMPL_HPP
+#define CPPNET_TASK_IMPL_HPP
+#include "net/service/task.hpp"
+
+#include <bit>
+#include <new>
+#include <utility>
+namespace net::service {
+inline auto frame_pool::allocate(std::size_t size) -> void *
+{
+  const auto index = size_class(size);
+  if (index >= size_classes)
+    return ::operator new(size);
+
+  auto &list = local().lists[index];
+  if (auto *head = list.head)
+  {
+    list.head = head->next;
+    --list.size;
+    return head;
+  }
+
+  return ::operator new(min_block << index);
+}
+
+inline auto frame_pool::deallocate(void *ptr, std::size_t size) noexcept
+    -> void
+{
+  const auto index = size_class(size);
+  if (index >= size_classes)
+    return ::operator delete(ptr);
+
+  auto &list = local().lists[index];
+  if (list.size == max_cached)
+    return ::operator delete(ptr);
+
+  list.head = ::new (ptr) block{list.head};
+  ++list.size;
+}
+
+inline auto frame_pool::cached() noexcept -> std::size_t
+{
+  auto count = std::size_t{};
+  for (const auto &list : local().lists)
+    count += list.size;
+
+  return count;
+}
+
+inline auto frame_pool::release() noexcept -> void
+{
+  for (auto &list : local().lists)
+  {
+    while (auto *head = list.head)
+    {
+      list.head = head->next;
+      ::operator delete(head);
+    }
+    list.size = 0;
+  }
+}
+
+inline frame_pool::cache::~cache()
+{
+  for (auto &list : lists)
+  {
+    while (auto *head = list.head)
+    {
+      list.head = head->next;
+      ::operator delete(head);
+    }
+  }
+}
+
+inline auto frame_pool::size_class(std::size_t size) noexcept -> std::size_t
+{
+  if (size <= min_block)
+    return 0;
+
+  return static_cast<std::size_t>(std::bit_width((size - 1) / min_block));
+}
+
+inline auto frame_pool::local() noexcept -> cache &
+{
+  static thread_local cache instance;
+  return instance;
+}
+
+namespace detail {
+template <typename T> auto task_result<T>::return_value(T value) -> void
+{
+  result_.template emplace<1>(std::move(value));
+}
+
+template <typename T>
+auto task_result<T>::unhandled_exception() noexcept -> void
+{
+  result_.template emplace<2>(std::current_exception());
+}
+
+template <typename T> auto task_result<T>::result() -> T
+{
+  if (result_.index() == 2)
+    std::rethrow_exception(std::get<2>(result_));
+
+  return std::move(std::get<1>(result_));
+}
+
+inline auto task_result<void>::return_void() noexcept -> void {}
+
+inline auto task_result<void>::unhandled_exception() noexcept -> void
+{
+  exception_ = std::current_exception();
+}
+
+inline auto task_result<void>::result() -> void
+{
+  if (exception_)
+    std::rethrow_exception(exception_);
+}
+} // namespace detail
+
+template <typename T>
+auto task<T>::promise_type::operator new(std::size_t size) -> void *
+{
+  return frame_pool::allocate(size);
+}
+
+template <typename T>
+auto task<T>::promise_type::operator delete(void *ptr,
+                                            std::size_t size) noexcept -> void
+{
+  frame_pool::deallocate(ptr, size);
+}
+
+template <typename T>
+auto task<T>::promise_type::get_return_object() noexcept -> task
+{
+  return task(handle_type::from_promise(*this));
+}
+
+template <typename T>
+auto task<T>::promise_type::initial_suspend() noexcept -> std::suspend_always
+{
+  return {};
+}
+
+template <typename T>
+auto task<T>::promise_type::final_suspend() noexcept -> final_awaiter
+{
+  return {};
+}
+
+template <typename T>
+auto task<T>::promise_type::final_awaiter::await_ready() noexcept -> bool
+{
+  return false;
+}
+
+template <typename T>
+auto task<T>::promise_type::final_awaiter::await_suspend(
+    std::coroutine_handle<promise_type> handle) noexcept
+    -> std::coroutine_handle<>
+{
+  auto &promise = handle.promise();
+  if (promise.continuation)
+    return promise.continuation;
+
+  // The callback may destroy the coroutine, which is safe now that it is
+  // suspended.
+  if (promise.on_done)
+    promise.on_done(promise.arg);
+
+  return std::noop_coroutine();
+}
+
+template <typename T>
+auto task<T>::promise_type::final_awaiter::await_resume() noexcept -> void
+{}
+
+template <typename T>
+auto task<T>::awaiter::await_ready() const noexcept -> bool
+{
+  return !handle || handle.done();
+}
+
+template <typename T>
+auto task<T>::awaiter::await_suspend(
+    std::coroutine_handle<> continuation) noexcept -> std::coroutine_handle<>
+{
+  handle.promise().continuation = continuation;
+  return handle;
+}
+
+template <typename T> auto task<T>::awaiter::await_resume() -> T
+{
+  return handle.promise().result();
+}
+
+template <typename T>
+task<T>::task(task &&other) noexcept
+    : handle_{std::exchange(other.handle_, {})}
+{}
+
+template <typename T>
+auto task<T>::operator=(task &&other) noexcept -> task &
+{
+  if (this != &other)
+  {
+    if (handle_)
+      handle_.destroy();
+    handle_ = std::exchange(other.handle_, {});
+  }
+  return *this;
+}
+
+template <typename T> task<T>::~task()
+{
+  if (handle_)
+    handle_.destroy();
+}
+
+template <typename T> auto task<T>::operator co_await() && noexcept -> awaiter
+{
+  return {handle_};
+}
+
+template <typename T>
+auto task<T>::start(done_type on_done, void *arg) noexcept -> void
+{
+  auto &promise = handle_.promise();
+  promise.on_done = on_done;
+  promise.arg = arg;
+  handle_.resume();
+}
+
+template <typename T> auto task<T>::done() const noexcept -> bool
+{
+  return !handle_ || handle_.done();
+}
+
+template <typename T> auto task<T>::result() -> T
+{
+  return handle_.promise().result();
+}
+
+template <typename T>
+task<T>::task(handle_type handle) noexcept : handle_{handle}
+{}
+} // namespace net::service
+#endif // CPPNET_TASK_IMPL_HPP
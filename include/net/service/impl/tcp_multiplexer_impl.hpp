@@ -0,0 +1,364 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file tcp_multiplexer_impl.hpp
+ * @brief This file defines a pipelined TCP request/response client.
+ */
+#pragma once
+#ifndef CPPNET_TCP_MULTIPLEXER_IMPL_HPP
+#define CPPNET_TCP_MULTIPLEXER_IMPL_HPP
+#include "net/detail/to_error_code.hpp"
+#include "net/detail/with_lock.hpp"
+#include "net/service/tcp_multiplexer.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <new>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+namespace net::service {
+template <typename Receiver>
+tcp_multiplexer::request_state<Receiver>::request_state(
+    tcp_multiplexer *mux, std::vector<std::byte> frame, duration timeout,
+    Receiver receiver)
+    : mux{mux}, receiver{std::move(receiver)}
+{
+  this->frame = std::move(frame);
+  this->timeout = timeout;
+}
+
+template <typename Receiver>
+auto tcp_multiplexer::request_state<Receiver>::start() noexcept -> void
+{
+  constexpr auto max_payload = std::numeric_limits<std::uint32_t>::max();
+  if (frame.size() - header_size > max_payload)
+    return complete(std::make_error_code(std::errc::message_size), {});
+
+  try
+  {
+    mux->submit_(this);
+  }
+  catch (const std::bad_alloc &)
+  {
+    complete(std::make_error_code(std::errc::not_enough_memory), {});
+  }
+}
+
+template <typename Receiver>
+auto tcp_multiplexer::request_state<Receiver>::complete(
+    std::error_code error, response_type response) noexcept -> void
+{
+  if (error)
+    return stdexec::set_error(std::move(receiver), error);
+
+  stdexec::set_value(std::move(receiver), std::move(response));
+}
+
+template <typename Receiver>
+auto tcp_multiplexer::sender::connect(Receiver &&receiver)
+    -> request_state<std::decay_t<Receiver>>
+{
+  return {mux, std::move(frame), timeout, std::forward<Receiver>(receiver)};
+}
+
+template <typename T>
+tcp_multiplexer::tcp_multiplexer(async_context &ctx, socket_address<T> address,
+                                 duration timeout, std::size_t max_response)
+    : ctx_{std::addressof(ctx)}, address_{address}, timeout_{timeout},
+      max_response_{max_response}
+{}
+
+inline auto
+tcp_multiplexer::request(std::span<const std::byte> payload) -> sender
+{
+  return request(payload, timeout_);
+}
+
+inline auto tcp_multiplexer::request(std::span<const std::byte> payload,
+                                     duration timeout) -> sender
+{
+  auto frame = std::vector<std::byte>(header_size + payload.size());
+  store_(std::span(frame).first(sizeof(std::uint32_t)), payload.size());
+  std::ranges::copy(payload, frame.begin() + header_size);
+
+  return {.mux = this, .frame = std::move(frame), .timeout = timeout};
+}
+
+inline auto tcp_multiplexer::close() noexcept -> void
+{
+  using namespace io::socket;
+  auto sockfd = sockfd_.exchange(INVALID_SOCKET);
+  if (sockfd != INVALID_SOCKET)
+    shutdown(sockfd, SHUT_RDWR);
+}
+
+inline auto tcp_multiplexer::in_flight() const noexcept -> std::size_t
+{
+  return in_flight_.load(std::memory_order_relaxed);
+}
+
+inline auto tcp_multiplexer::submit_(request_base *request) -> void
+{
+  using net::detail::with_lock;
+
+  auto first = with_lock(mtx_, [&] {
+    submitted_.push_back(request);
+    return submitted_.size() == 1;
+  });
+
+  // A zero timer hands the submitted requests to the context thread.
+  if (first)
+    ctx_->timers.add(duration::zero(), [this](auto) { flush_(); });
+}
+
+inline auto tcp_multiplexer::flush_() -> void
+{
+  using net::detail::with_lock;
+
+  auto submitted =
+      with_lock(mtx_, [&] { return std::exchange(submitted_, {}); });
+  for (auto *request : submitted)
+  {
+    auto id = next_id_++;
+    auto frame = std::span(request->frame);
+    store_(frame.subspan(sizeof(std::uint32_t), sizeof(correlation_id)), id);
+    pending_.insert(pending_.end(), frame.begin(), frame.end());
+    request->frame = {};
+
+    request->timer = ctx_->timers.add(request->timeout,
+                                      [this, id](auto) { expire_(id); });
+    requests_.emplace(id, request);
+  }
+  in_flight_.store(requests_.size(), std::memory_order_relaxed);
+
+  if (state_ == connection_states::DISCONNECTED)
+    return connect_();
+
+  write_();
+}
+
+inline auto tcp_multiplexer::connect_() -> void
+{
+  using namespace stdexec;
+
+  auto address = address_;
+  if (address->sin6_family == AF_INET)
+  {
+    const auto *ptr =
+        reinterpret_cast<const struct sockaddr *>(std::addressof(*address_));
+    address = socket_address<sockaddr_in>(ptr);
+  }
+
+  state_ = connection_states::CONNECTING;
+  socket_ =
+      ctx_->poller.emplace(address_->sin6_family, SOCK_STREAM, IPPROTO_TCP);
+  sockfd_ = static_cast<socket_type>(*socket_->socket);
+
+  stdexec::sender auto connect =
+      io::connect(*socket_, address) |
+      then([this, generation = generation_](auto &&) {
+        if (generation != generation_)
+          return;
+
+        state_ = connection_states::CONNECTED;
+        recv_();
+        write_();
+      }) |
+      upon_error([this, generation = generation_](auto &&error) {
+        if (generation == generation_)
+          fail_(net::detail::to_error_code(error));
+      });
+
+  ctx_->scope.spawn(std::move(connect));
+}
+
+inline auto tcp_multiplexer::write_() -> void
+{
+  if (state_ != connection_states::CONNECTED || !writing_.empty() ||
+      pending_.empty())
+  {
+    return;
+  }
+
+  // Requests framed while this write is in flight are pipelined behind it.
+  writing_.swap(pending_);
+  send_(0);
+}
+
+inline auto tcp_multiplexer::send_(std::size_t offset) -> void
+{
+  using namespace stdexec;
+  using socket_message = io::socket::socket_message<>;
+
+  auto msg = socket_message{.buffers = std::span(writing_).subspan(offset)};
+  stdexec::sender auto sendmsg =
+      io::sendmsg(*socket_, msg, MSG_NOSIGNAL) |
+      then([this, generation = generation_, offset](auto &&len) {
+        if (generation != generation_)
+          return;
+
+        auto sent = offset + static_cast<std::size_t>(len);
+        if (sent < writing_.size())
+          return send_(sent);
+
+        writing_.clear();
+        write_();
+      }) |
+      upon_error([this, generation = generation_](auto &&error) {
+        if (generation == generation_)
+          fail_(net::detail::to_error_code(error));
+      });
+
+  ctx_->scope.spawn(std::move(sendmsg));
+}
+
+inline auto tcp_multiplexer::recv_() -> void
+{
+  using namespace stdexec;
+  using socket_message = io::socket::socket_message<>;
+  static constexpr std::size_t min_read_buffer = 64UL * 1024;
+
+  if (read_size_ == read_buffer_.size())
+    read_buffer_.resize(std::max(2 * read_buffer_.size(), min_read_buffer));
+
+  auto msg =
+      socket_message{.buffers = std::span(read_buffer_).subspan(read_size_)};
+  stdexec::sender auto recvmsg =
+      io::recvmsg(*socket_, msg, 0) |
+      then([this, generation = generation_](auto &&len) {
+        if (generation != generation_)
+          return;
+
+        if (len <= 0)
+          return fail_(std::make_error_code(std::errc::connection_reset));
+
+        read_size_ += static_cast<std::size_t>(len);
+        demultiplex_();
+        if (generation == generation_)
+          recv_();
+      }) |
+      upon_error([this, generation = generation_](auto &&error) {
+        if (generation == generation_)
+          fail_(net::detail::to_error_code(error));
+      });
+
+  ctx_->scope.spawn(std::move(recvmsg));
+}
+
+inline auto tcp_multiplexer::demultiplex_() -> void
+{
+  auto buffer = std::span(read_buffer_).first(read_size_);
+  auto offset = std::size_t{0};
+  auto needed = std::size_t{0};
+
+  while (buffer.size() - offset >= header_size)
+  {
+    auto header = buffer.subspan(offset, header_size);
+    auto length = load_(header.first(sizeof(std::uint32_t)));
+    auto id = load_(header.subspan(sizeof(std::uint32_t)));
+
+    // The length comes from the peer, so it is checked before a buffer
+    // is sized from it.
+    if (length > max_response_)
+      return fail_(std::make_error_code(std::errc::message_size));
+
+    if (buffer.size() - offset - header_size < length)
+    {
+      needed = header_size + length;
+      break;
+    }
+
+    auto payload = buffer.subspan(offset + header_size, length);
+    offset += header_size + length;
+
+    // Responses to requests that timed out are dropped.
+    auto it = requests_.find(id);
+    if (it == requests_.end())
+      continue;
+
+    auto *request = it->second;
+    requests_.erase(it);
+    ctx_->timers.remove(request->timer);
+    request->complete({}, response_type(payload.begin(), payload.end()));
+  }
+
+  if (offset)
+  {
+    std::ranges::copy(buffer.subspan(offset), read_buffer_.begin());
+    read_size_ -= offset;
+  }
+
+  // Make room for the rest of a frame larger than the read buffer. This
+  // may reallocate, so it is done only once buffer is no longer used.
+  if (needed > read_buffer_.size())
+    read_buffer_.resize(needed);
+  in_flight_.store(requests_.size(), std::memory_order_relaxed);
+}
+
+inline auto tcp_multiplexer::expire_(correlation_id id) -> void
+{
+  auto it = requests_.find(id);
+  if (it == requests_.end())
+    return;
+
+  auto *request = it->second;
+  requests_.erase(it);
+  in_flight_.store(requests_.size(), std::memory_order_relaxed);
+  request->complete(std::make_error_code(std::errc::timed_out), {});
+}
+
+inline auto tcp_multiplexer::fail_(std::error_code error) -> void
+{
+  ++generation_;
+  state_ = connection_states::DISCONNECTED;
+  sockfd_ = io::socket::INVALID_SOCKET;
+  socket_.reset();
+  pending_.clear();
+  writing_.clear();
+  read_size_ = 0;
+
+  auto requests = std::exchange(requests_, {});
+  in_flight_.store(0, std::memory_order_relaxed);
+  for (auto &[id, request] : requests)
+  {
+    ctx_->timers.remove(request->timer);
+    request->complete(error, {});
+  }
+}
+
+inline auto tcp_multiplexer::store_(std::span<std::byte> bytes,
+                                    std::uint64_t value) noexcept -> void
+{
+  for (auto &byte : bytes | std::views::reverse)
+  {
+    byte = static_cast<std::byte>(value & 0xFFU);
+    value >>= 8U;
+  }
+}
+
+inline auto tcp_multiplexer::load_(std::span<const std::byte> bytes) noexcept
+    -> std::uint64_t
+{
+  auto value = std::uint64_t{0};
+  for (auto byte : bytes)
+    value = (value << 8U) | std::to_integer<std::uint64_t>(byte);
+
+  return value;
+}
+} // namespace net::service
+#endif // CPPNET_TCP_MULTIPLEXER_IMPL_HPP
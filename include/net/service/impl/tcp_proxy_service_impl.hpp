@@ -0,0 +1,244 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file tcp_proxy_service_impl.hpp
+ * @brief This file defines a layer 4 TCP proxy service.
+ */
+#pragma once
+#ifndef CPPNET_TCP_PROXY_SERVICE_IMPL_HPP
+#define CPPNET_TCP_PROXY_SERVICE_IMPL_HPP
+#include "net/service/tcp_proxy_service.hpp"
+
+#include <cerrno>
+#include <utility>
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+namespace net::service {
+inline tcp_proxy_service::pump::pump(socket_dialog from,
+                                     socket_dialog to) noexcept
+    : from{std::move(from)}, to{std::move(to)}
+{}
+
+inline tcp_proxy_service::pump::~pump()
+{
+  for (auto fd : pipe)
+  {
+    if (fd >= 0)
+      ::close(fd);
+  }
+}
+
+template <typename T, typename U>
+tcp_proxy_service::tcp_proxy_service(socket_address<T> address,
+                                     socket_address<U> upstream) noexcept
+    : Base(address), upstream_{upstream}
+{}
+
+inline auto tcp_proxy_service::service(async_context &ctx,
+                                       const socket_dialog &socket,
+                                       std::shared_ptr<read_context> rctx,
+                                       std::span<const std::byte> buf) -> void
+{
+  using namespace stdexec;
+  if (!rctx)
+    return;
+
+  auto address = upstream_;
+  if (address->sin6_family == AF_INET)
+  {
+    const auto *ptr =
+        reinterpret_cast<const struct sockaddr *>(std::addressof(*upstream_));
+    address = socket_address<sockaddr_in>(ptr);
+  }
+
+  auto upstream =
+      ctx.poller.emplace(upstream_->sin6_family, SOCK_STREAM, IPPROTO_TCP);
+  sender auto connect =
+      io::connect(upstream, address) |
+      then([&, socket, upstream](auto &&) {
+        forward_(ctx, socket, upstream);
+      }) |
+      upon_error([this, socket](auto &&error) {
+        using namespace io::socket;
+        connect_failures_.fetch_add(1, std::memory_order_relaxed);
+        shutdown(static_cast<native_socket_type>(*socket.socket), SHUT_RDWR);
+      });
+
+  ctx.scope.spawn(std::move(connect));
+}
+
+inline auto tcp_proxy_service::stop() -> void
+{
+  using namespace io::socket;
+  for (const auto &weak : pumps_)
+  {
+    if (auto p = weak.lock())
+    {
+      shutdown(static_cast<native_socket_type>(*p->from.socket), SHUT_RD);
+      p->slot = detached;
+    }
+  }
+  pumps_.clear();
+}
+
+inline auto tcp_proxy_service::connect_failures() const noexcept
+    -> std::uint64_t
+{
+  return connect_failures_.load(std::memory_order_relaxed);
+}
+
+inline auto tcp_proxy_service::forward_(async_context &ctx,
+                                        const socket_dialog &client,
+                                        const socket_dialog &upstream) -> void
+{
+  auto pumps = std::array{std::make_shared<pump>(client, upstream),
+                          std::make_shared<pump>(upstream, client)};
+  for (auto &p : pumps)
+  {
+    if (::pipe2(p->pipe.data(), O_NONBLOCK | O_CLOEXEC))
+      return reset_(*p);
+  }
+
+  for (auto &p : pumps)
+  {
+    p->slot = pumps_.size();
+    pumps_.push_back(p);
+    poll_(ctx, std::move(p));
+  }
+}
+
+inline auto tcp_proxy_service::poll_(async_context &ctx,
+                                     std::shared_ptr<pump> p) -> void
+{
+  using namespace stdexec;
+
+  // Peeking one byte waits for the source without reading into user space.
+  sender auto peek = io::recvmsg(p->from, p->peek_msg, MSG_PEEK) |
+                     then([&, p](auto &&len) {
+                       if (len <= 0)
+                         return half_close_(*p);
+
+                       splice_(ctx, p);
+                     }) |
+                     upon_error([this, p](auto &&error) { reset_(*p); });
+
+  ctx.scope.spawn(std::move(peek));
+}
+
+inline auto tcp_proxy_service::splice_(async_context &ctx,
+                                       const std::shared_ptr<pump> &p) -> void
+{
+  using namespace io::socket;
+  constexpr auto flags = SPLICE_F_MOVE | SPLICE_F_NONBLOCK;
+  const auto from = static_cast<native_socket_type>(*p->from.socket);
+  const auto to = static_cast<native_socket_type>(*p->to.socket);
+  const auto [pipe_out, pipe_in] = p->pipe;
+
+  auto len = ::splice(from, nullptr, pipe_in, nullptr, splice_size, flags);
+  if (len == 0)
+    return half_close_(*p);
+
+  if (len < 0)
+  {
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+      return poll_(ctx, p);
+    return reset_(*p);
+  }
+
+  p->buffered += static_cast<std::size_t>(len);
+  while (p->buffered)
+  {
+    len = ::splice(pipe_out, nullptr, to, nullptr, p->buffered, flags);
+    if (len < 0)
+      break;
+    p->buffered -= static_cast<std::size_t>(len);
+  }
+
+  if (!p->buffered)
+    return poll_(ctx, p);
+
+  if (errno != EAGAIN && errno != EWOULDBLOCK)
+    return reset_(*p);
+
+  // The destination is full. Drain the pipe into the bounce buffer and
+  // send it asynchronously, which waits for the socket to be writable.
+  p->bounce.resize(p->buffered);
+  len = ::read(pipe_out, p->bounce.data(), p->bounce.size());
+  if (len < 0)
+    return reset_(*p);
+
+  p->bounce.resize(static_cast<std::size_t>(len));
+  p->buffered -= static_cast<std::size_t>(len);
+  bounce_(ctx, p, 0);
+}
+
+inline auto tcp_proxy_service::bounce_(async_context &ctx,
+                                       std::shared_ptr<pump> p,
+                                       std::size_t offset) -> void
+{
+  using namespace stdexec;
+  using socket_message = io::socket::socket_message<>;
+
+  auto msg = socket_message{.buffers = std::span(p->bounce).subspan(offset)};
+  sender auto sendmsg =
+      io::sendmsg(p->to, msg, MSG_NOSIGNAL) |
+      then([&, p, offset](auto &&len) {
+        auto sent = offset + static_cast<std::size_t>(len);
+        if (sent < p->bounce.size())
+          return bounce_(ctx, p, sent);
+
+        p->bounce.clear();
+        poll_(ctx, p);
+      }) |
+      upon_error([this, p](auto &&error) { reset_(*p); });
+
+  ctx.scope.spawn(std::move(sendmsg));
+}
+
+inline auto tcp_proxy_service::half_close_(pump &p) noexcept -> void
+{
+  using namespace io::socket;
+  shutdown(static_cast<native_socket_type>(*p.to.socket), SHUT_WR);
+  finish_(p);
+}
+
+inline auto tcp_proxy_service::reset_(pump &p) noexcept -> void
+{
+  using namespace io::socket;
+  shutdown(static_cast<native_socket_type>(*p.from.socket), SHUT_RDWR);
+  shutdown(static_cast<native_socket_type>(*p.to.socket), SHUT_RDWR);
+  finish_(p);
+}
+
+inline auto tcp_proxy_service::finish_(pump &p) noexcept -> void
+{
+  const auto slot = std::exchange(p.slot, detached);
+  if (slot == detached)
+    return;
+
+  // Move the last pump into the freed slot, so removal doesn't shift or
+  // scan the other pumps.
+  if (slot + 1 < pumps_.size())
+  {
+    pumps_[slot] = std::move(pumps_.back());
+    if (auto moved = pumps_[slot].lock())
+      moved->slot = slot;
+  }
+  pumps_.pop_back();
+}
+} // namespace net::service
+#endif // CPPNET_TCP_PROXY_SERVICE_IMPL_HPP
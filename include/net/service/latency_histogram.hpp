@@ -0,0 +1,92 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file latency_histogram.hpp
+ * @brief This file declares a lock-free latency histogram.
+ */
+#pragma once
+#ifndef CPPNET_LATENCY_HISTOGRAM_HPP
+#define CPPNET_LATENCY_HISTOGRAM_HPP
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+namespace net::service {
+/**
+ * @brief A log-linear histogram of latencies in nanoseconds.
+ * @details Each power of two range of latencies is split into eight
+ * equal buckets, so a latency is recorded with a relative error of at
+ * most 12.5%. Latencies below 8ns are recorded exactly. Buckets are
+ * atomic counters, so one thread can record while others read.
+ */
+class latency_histogram {
+public:
+  /** @brief The latency type. */
+  using duration = std::chrono::nanoseconds;
+  /** @brief The number of buckets per power of two. */
+  static constexpr std::size_t sub_buckets = 8;
+  /**
+   * @brief The number of buckets.
+   * @details The most significant bit of a latency is at most bit 62,
+   * which is the last power of two with its own sub-buckets.
+   */
+  static constexpr std::size_t buckets =
+      (std::numeric_limits<duration::rep>::digits - 2) * sub_buckets;
+
+  /**
+   * @brief Records a latency. Negative latencies are recorded as zero.
+   * @param latency The latency to record.
+   */
+  inline auto record(duration latency) noexcept -> void;
+  /** @returns The number of recorded latencies. */
+  [[nodiscard]] inline auto count() const noexcept -> std::uint64_t;
+  /**
+   * @brief Estimates a percentile of the recorded latencies.
+   * @param percentile The percentile, from 0 to 100.
+   * @returns The upper bound of the bucket that holds the percentile, or
+   * zero if no latencies were recorded.
+   */
+  [[nodiscard]] inline auto
+  percentile(double percentile) const noexcept -> duration;
+  /**
+   * @param index The bucket index.
+   * @returns The number of latencies recorded in a bucket.
+   */
+  [[nodiscard]] inline auto
+  bucket_count(std::size_t index) const noexcept -> std::uint64_t;
+  /**
+   * @param index The bucket index.
+   * @returns The largest latency that is recorded in a bucket.
+   */
+  [[nodiscard]] static inline auto
+  upper_bound(std::size_t index) noexcept -> duration;
+  /** @brief Clears every bucket. */
+  inline auto reset() noexcept -> void;
+
+private:
+  /**
+   * @param nanos A latency in nanoseconds.
+   * @returns The index of the bucket that records the latency.
+   */
+  static inline auto index_(std::uint64_t nanos) noexcept -> std::size_t;
+
+  /** @brief The bucket counters. */
+  std::array<std::atomic<std::uint64_t>, buckets> counts_{};
+};
+} // namespace net::service
+
+#include "impl/latency_histogram_impl.hpp" // IWYU pragma: export
+#endif                                     // CPPNET_LATENCY_HISTOGRAM_HPP
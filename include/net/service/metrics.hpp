@@ -0,0 +1,382 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file metrics.hpp
+ * @brief This file declares a registry of Prometheus style metrics.
+ */
+#pragma once
+#ifndef CPPNET_METRICS_HPP
+#define CPPNET_METRICS_HPP
+#include "async_context.hpp"
+#include "net/detail/immovable.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+namespace net::service {
+/**
+ * @brief A registry of counters, gauges and histograms that can be
+ * rendered in the Prometheus text exposition format.
+ * @details Counters and histograms are split into shards, and each thread
+ * updates its own shard with relaxed atomic operations, so threads that
+ * update the same metric do not contend for the same cache line. The
+ * shards are only summed when the metric is read. Registering a metric
+ * takes a lock, so metrics should be registered once, before the hot
+ * path, and the returned references kept.
+ * @code
+ * auto registry = metrics_registry();
+ * auto &requests = registry.add_counter("requests_total", "Requests.");
+ * requests.add();
+ * auto text = registry.expose();
+ * @endcode
+ */
+class metrics_registry : net::detail::immovable {
+public:
+  /** @brief The number of shards of each counter and histogram. */
+  static constexpr std::size_t shards = 16;
+
+  /** @brief A monotonically increasing count. */
+  class counter : net::detail::immovable {
+  public:
+    /**
+     * @brief Constructs a counter.
+     * @param name The metric name.
+     * @param help The metric description.
+     */
+    counter(std::string_view name, std::string_view help);
+
+    /**
+     * @brief Increments the counter.
+     * @param count The amount to add.
+     */
+    auto add(std::uint64_t count = 1) noexcept -> void;
+    /** @returns The sum of every shard. */
+    [[nodiscard]] auto value() const noexcept -> std::uint64_t;
+    /**
+     * @brief Appends the counter in the text exposition format.
+     * @param out The string to append to.
+     */
+    auto expose(std::string &out) const -> void;
+    /** @returns The metric name. */
+    [[nodiscard]] auto name() const noexcept -> std::string_view;
+
+  private:
+    /** @brief A counter shard on its own cache line. */
+    struct alignas(64) shard {
+      /** @brief The shard count. */
+      std::atomic<std::uint64_t> value{0};
+    };
+
+    /** @brief The metric name. */
+    std::string name_;
+    /** @brief The metric description. */
+    std::string help_;
+    /** @brief The counter shards. */
+    std::array<shard, shards> shards_{};
+  };
+
+  /** @brief A value that can go up and down. */
+  class gauge : net::detail::immovable {
+  public:
+    /**
+     * @brief Constructs a gauge.
+     * @param name The metric name.
+     * @param help The metric description.
+     */
+    gauge(std::string_view name, std::string_view help);
+
+    /**
+     * @brief Sets the gauge.
+     * @param value The new value.
+     */
+    auto set(double value) noexcept -> void;
+    /**
+     * @brief Adds to the gauge.
+     * @param value The amount to add. It may be negative.
+     */
+    auto add(double value) noexcept -> void;
+    /** @returns The gauge value. */
+    [[nodiscard]] auto value() const noexcept -> double;
+    /**
+     * @brief Appends the gauge in the text exposition format.
+     * @param out The string to append to.
+     */
+    auto expose(std::string &out) const -> void;
+    /** @returns The metric name. */
+    [[nodiscard]] auto name() const noexcept -> std::string_view;
+
+  private:
+    /** @brief The metric name. */
+    std::string name_;
+    /** @brief The metric description. */
+    std::string help_;
+    /** @brief The gauge value. */
+    std::atomic<double> value_{0};
+  };
+
+  /**
+   * @brief A distribution of observed values in cumulative buckets.
+   * @details An observation is counted in the first bucket whose upper
+   * bound is greater than or equal to it, or in the implicit `+Inf`
+   * bucket. Durations are observed in seconds.
+   */
+  class histogram : net::detail::immovable {
+  public:
+    /**
+     * @brief Constructs a histogram.
+     * @param name The metric name.
+     * @param help The metric description.
+     * @param bounds The bucket upper bounds, in increasing order.
+     */
+    histogram(std::string_view name, std::string_view help,
+              std::vector<double> bounds);
+
+    /**
+     * @brief Records an observation.
+     * @param value The observed value.
+     */
+    auto observe(double value) noexcept -> void;
+    /**
+     * @brief Records a duration in seconds.
+     * @param value The observed duration.
+     */
+    template <typename Rep, typename Period>
+    auto observe(std::chrono::duration<Rep, Period> value) noexcept -> void;
+    /** @returns The number of observations. */
+    [[nodiscard]] auto count() const noexcept -> std::uint64_t;
+    /** @returns The sum of the observations. */
+    [[nodiscard]] auto sum() const noexcept -> double;
+    /**
+     * @param index The bucket index. `bounds().size()` is the `+Inf`
+     * bucket.
+     * @returns The number of observations in the bucket, not including
+     * the buckets below it.
+     */
+    [[nodiscard]] auto
+    bucket_count(std::size_t index) const noexcept -> std::uint64_t;
+    /** @returns The bucket upper bounds. */
+    [[nodiscard]] auto bounds() const noexcept -> const std::vector<double> &;
+    /**
+     * @brief Appends the histogram in the text exposition format.
+     * @param out The string to append to.
+     */
+    auto expose(std::string &out) const -> void;
+    /** @returns The metric name. */
+    [[nodiscard]] auto name() const noexcept -> std::string_view;
+
+  private:
+    /** @brief A cache line of bucket counts. */
+    struct alignas(64) line {
+      /** @brief The bucket counts. */
+      std::array<std::atomic<std::uint64_t>, 8> counts{};
+    };
+    /** @brief A histogram shard on its own cache line. */
+    struct alignas(64) shard {
+      /** @brief The sum of the observations. */
+      std::atomic<double> sum{0};
+    };
+
+    /**
+     * @param shard The shard index.
+     * @param index The bucket index.
+     * @returns The bucket count of a shard.
+     */
+    [[nodiscard]] auto count_(std::size_t shard, std::size_t index)
+        const noexcept -> std::atomic<std::uint64_t> &;
+
+    /** @brief The metric name. */
+    std::string name_;
+    /** @brief The metric description. */
+    std::string help_;
+    /** @brief The bucket upper bounds. */
+    std::vector<double> bounds_;
+    /** @brief The histogram shards. */
+    std::array<shard, shards> shards_{};
+    /** @brief The number of cache lines of bucket counts per shard. */
+    std::size_t stride_ = 0;
+    /**
+     * @brief The bucket counts of every shard. Each shard starts on its
+     * own cache line, so shards never share a line.
+     */
+    std::unique_ptr<line[]> lines_;
+  };
+
+  /**
+   * @brief Registers a counter.
+   * @param name The metric name.
+   * @param help The metric description.
+   * @returns The counter. If a counter with the same name is already
+   * registered, it is returned instead.
+   * @throws std::bad_variant_access if a metric of another kind is
+   * registered with the same name.
+   */
+  auto add_counter(std::string_view name, std::string_view help) -> counter &;
+  /**
+   * @brief Registers a gauge.
+   * @param name The metric name.
+   * @param help The metric description.
+   * @returns The gauge. If a gauge with the same name is already
+   * registered, it is returned instead.
+   * @throws std::bad_variant_access if a metric of another kind is
+   * registered with the same name.
+   */
+  auto add_gauge(std::string_view name, std::string_view help) -> gauge &;
+  /**
+   * @brief Registers a histogram.
+   * @param name The metric name.
+   * @param help The metric description.
+   * @param bounds The bucket upper bounds, in increasing order.
+   * @returns The histogram. If a histogram with the same name is already
+   * registered, it is returned instead, with its original bounds.
+   * @throws std::bad_variant_access if a metric of another kind is
+   * registered with the same name.
+   */
+  auto add_histogram(std::string_view name, std::string_view help,
+                     std::vector<double> bounds = default_buckets())
+      -> histogram &;
+  /**
+   * @brief Renders every metric in the text exposition format.
+   * @details Metrics are rendered in the order they were registered.
+   * This method is thread-safe.
+   */
+  [[nodiscard]] auto expose() const -> std::string;
+
+  /** @returns Bucket bounds from 100us to 10s, in seconds. */
+  static auto default_buckets() -> std::vector<double>;
+  /**
+   * @brief Makes exponentially spaced bucket bounds.
+   * @param start The first upper bound.
+   * @param factor The ratio between successive bounds.
+   * @param count The number of bounds.
+   */
+  static auto exponential_buckets(double start, double factor,
+                                  std::size_t count) -> std::vector<double>;
+  /** @returns The shard that the calling thread updates. */
+  static auto thread_shard() noexcept -> std::size_t;
+
+private:
+  /** @brief A registered metric. */
+  using metric = std::variant<counter, gauge, histogram>;
+
+  /**
+   * @brief Finds or registers a metric.
+   * @tparam Metric The metric kind.
+   * @param name The metric name.
+   * @param args The metric constructor arguments after the name.
+   */
+  template <typename Metric, typename... Args>
+  auto add_(std::string_view name, Args &&...args) -> Metric &;
+
+  /** @brief The registered metrics. */
+  std::deque<metric> metrics_;
+  /** @brief Mutex for thread-safety. */
+  mutable std::mutex mtx_;
+};
+
+/**
+ * @brief Connection and byte counters for an async_tcp_service.
+ * @details An async_tcp_service stream handler with a `metrics` member
+ * of this type counts the connections it accepts and closes, and the
+ * bytes it reads. Services that register with the same prefix on the
+ * same registry share their counters.
+ */
+struct tcp_metrics {
+  /**
+   * @brief Registers the counters.
+   * @param registry The registry to register the counters with.
+   * @param prefix The metric name prefix.
+   */
+  explicit tcp_metrics(metrics_registry &registry,
+                       std::string_view prefix = "cppnet_tcp");
+
+  /** @brief The number of connections accepted. */
+  metrics_registry::counter &accepted;
+  /** @brief The number of connections closed by the peer or on error. */
+  metrics_registry::counter &closed;
+  /** @brief The number of bytes read. */
+  metrics_registry::counter &bytes;
+};
+
+/**
+ * @brief Samples the utilization and timer lateness of an event loop.
+ * @details A periodic timer on the async context records how late it
+ * fires in a histogram. Each time it fires, the CPU time that the
+ * context thread used since the last firing is divided by the elapsed
+ * time and stored in a gauge, which is the fraction of time the loop was
+ * busy rather than waiting for events. The probe must be stopped, or
+ * destroyed, before the async context. The probe shares its state with
+ * the sampling timer, so `start`, `stop` and the destructor must be
+ * called on the thread that runs the async context, or while it is not
+ * running.
+ */
+class loop_metrics : net::detail::immovable {
+public:
+  /**
+   * @brief Registers the metrics.
+   * @param registry The registry to register the metrics with.
+   * @param prefix The metric name prefix.
+   */
+  explicit loop_metrics(metrics_registry &registry,
+                        std::string_view prefix = "cppnet_loop");
+
+  /**
+   * @brief Starts sampling an event loop.
+   * @details `start` must be called on the thread that runs `ctx`.
+   * @param ctx The async context to sample.
+   * @param interval The sampling interval.
+   */
+  auto start(async_context &ctx,
+             timers::duration interval = std::chrono::seconds(1)) -> void;
+  /**
+   * @brief Stops sampling.
+   * @details `stop` must be called on the thread that runs the sampled
+   * async context.
+   */
+  auto stop() noexcept -> void;
+  /** @brief Stops sampling. */
+  ~loop_metrics();
+
+private:
+  /** @brief Takes a sample on the context thread. */
+  auto sample_() noexcept -> void;
+
+  /** @brief The fraction of time the loop was busy. */
+  metrics_registry::gauge &utilization_;
+  /** @brief How late the sampling timer fired, in seconds. */
+  metrics_registry::histogram &lateness_;
+  /** @brief The sampled async context. */
+  async_context *ctx_ = nullptr;
+  /** @brief The sampling timer. */
+  timers::timer_id timer_ = timers::INVALID_TIMER;
+  /** @brief The sampling interval. */
+  timers::duration interval_{};
+  /** @brief When the sampling timer is next due. */
+  timers::timestamp due_;
+  /** @brief The wall clock time of the last sample. */
+  timers::timestamp wall_;
+  /** @brief The thread CPU time of the last sample. */
+  std::chrono::nanoseconds cpu_{-1};
+};
+} // namespace net::service
+
+#include "impl/metrics_impl.hpp" // IWYU pragma: export
+#endif                           // CPPNET_METRICS_HPP
@@ -0,0 +1,101 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file metrics_exporter.hpp
+ * @brief This file declares an HTTP service that exports metrics.
+ */
+#pragma once
+#ifndef CPPNET_METRICS_EXPORTER_HPP
+#define CPPNET_METRICS_EXPORTER_HPP
+#include "async_tcp_service.hpp"
+#include "metrics.hpp"
+
+#include <string_view>
+namespace net::service {
+/**
+ * @brief Serves a metrics registry in the Prometheus text exposition
+ * format over HTTP/1.1.
+ * @details A `GET` request for `/metrics` is answered with the output of
+ * `metrics_registry::expose`. Other paths are answered with `404` and
+ * other methods with `405`. Connections are kept alive, so a scraper can
+ * reuse one connection for every scrape. Request headers are read into
+ * the connection's read buffer until the blank line that ends them, and
+ * a request whose headers do not fit is answered with `431` and its
+ * connection is closed. Request bodies are not supported.
+ *
+ * The registry is only read when a scrape arrives, so services that
+ * update metrics on other threads are not slowed down by the exporter.
+ * @code
+ * auto registry = metrics_registry();
+ * auto exporter = basic_context_thread<metrics_exporter>();
+ * exporter.start(registry, address); // e.g. port 9100
+ * @endcode
+ */
+class metrics_exporter : public async_tcp_service<metrics_exporter, 4096> {
+public:
+  /** @brief Base class type. */
+  using Base = async_tcp_service<metrics_exporter, 4096>;
+  /** @brief The path that metrics are served on. */
+  static constexpr std::string_view path = "/metrics";
+
+  /**
+   * @brief Constructs a metrics exporter.
+   * @tparam T The socket address type.
+   * @param registry The registry to export. It must outlive the service.
+   * @param address The address to serve metrics on.
+   */
+  template <typename T>
+  metrics_exporter(const metrics_registry &registry,
+                   socket_address<T> address) noexcept;
+
+  /**
+   * @brief Reads a request and answers it once its headers are complete.
+   * @param ctx The async context.
+   * @param socket The connection.
+   * @param rctx The read context of the connection.
+   * @param buf The bytes read from the connection.
+   */
+  auto service(async_context &ctx, const socket_dialog &socket,
+               std::shared_ptr<read_context> rctx,
+               std::span<const std::byte> buf) -> void;
+
+  /**
+   * @brief Makes the response to a request.
+   * @param request The request line and headers.
+   * @returns The complete HTTP response.
+   */
+  [[nodiscard]] auto respond(std::string_view request) const -> std::string;
+
+private:
+  /**
+   * @brief Sends a response from offset to the end.
+   * @param ctx The async context.
+   * @param socket The connection.
+   * @param rctx The read context of the connection, or empty to close the
+   * connection after the response.
+   * @param response The response.
+   * @param offset The number of bytes of the response already sent.
+   */
+  auto reply_(async_context &ctx, const socket_dialog &socket,
+              std::shared_ptr<read_context> rctx, shared_buffer response,
+              std::size_t offset) -> void;
+
+  /** @brief The exported registry. */
+  const metrics_registry *registry_;
+};
+
+} // namespace net::service
+
+#include "impl/metrics_exporter_impl.hpp" // IWYU pragma: export
+#endif                                    // CPPNET_METRICS_EXPORTER_HPP
@@ -0,0 +1,216 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file pacer.hpp
+ * @brief This file declares a token bucket egress pacer.
+ */
+#pragma once
+#ifndef CPPNET_PACER_HPP
+#define CPPNET_PACER_HPP
+#include "async_context.hpp"
+#include "net/detail/immovable.hpp"
+
+#include <io/io.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include <netinet/in.h>
+namespace net::service {
+/**
+ * @brief Paces sends with a token bucket per flow.
+ * @details Each flow, such as a TCP connection or a UDP destination, has
+ * a bucket that holds up to `burst` bytes of tokens and is refilled at
+ * `rate` bytes per second. A send that the bucket can cover is made
+ * immediately. Otherwise it is queued behind the earlier sends of its
+ * flow and released, in order, once the bucket has refilled. A send that
+ * is larger than `burst` is released when the bucket is full and leaves
+ * the bucket in debt.
+ *
+ * Flows that are waiting for tokens are kept in a heap ordered by the
+ * time at which they can next send, and a single timer on the async
+ * context releases every flow that is due. Queued sends are kept in one
+ * pool shared by every flow, so a flow costs one hash table entry and one
+ * heap entry. A flow is forgotten once it has nothing queued and its
+ * bucket is full again.
+ *
+ * A pacer belongs to one async context and is not thread-safe. An
+ * async_tcp_service or async_udp_service stream handler with a `pacing`
+ * member of this type paces the sends made by `broadcast` and
+ * `send_segments`. Other sends, such as UDP replies and connection
+ * writes, are not paced.
+ * @code
+ * auto pacing = pacer(125'000'000, 64 * 1024); // 1Gbit/s, 64KiB bursts.
+ * pacing.send(ctx, pacer::flow_of(peer), buf.size(), [&] { ... });
+ * @endcode
+ */
+class pacer : net::detail::immovable {
+public:
+  /** @brief The flow identifier type. */
+  using flow_type = std::uint64_t;
+  /** @brief The type of a queued send. */
+  using send_function = std::function<void()>;
+  /** @brief The peer address type. */
+  using socket_address = io::socket::socket_address<sockaddr_in6>;
+
+  /**
+   * @brief Constructs a pacer.
+   * @param rate The rate at which each flow's bucket is refilled, in
+   * bytes per second.
+   * @param burst The capacity of each flow's bucket, in bytes.
+   */
+  pacer(std::size_t rate, std::size_t burst) noexcept;
+
+  /**
+   * @brief Makes a send, or queues it until the flow has the tokens.
+   * @param ctx The async context whose timers release queued sends. It
+   * must be the same for every call.
+   * @param flow The flow to charge.
+   * @param size The number of bytes the send will write.
+   * @param send The send. It is invoked on the event loop.
+   */
+  auto send(async_context &ctx, flow_type flow, std::size_t size,
+            send_function send) -> void;
+  /**
+   * @brief Drops a flow's bucket and queued sends.
+   * @details Call this when a flow ends, such as when its connection
+   * closes, so that a later flow with the same identifier starts with a
+   * full bucket. It must not be called from one of the flow's sends.
+   * @param flow The flow to drop.
+   */
+  auto forget(flow_type flow) -> void;
+
+  /** @returns The number of queued sends. */
+  [[nodiscard]] auto pending() const noexcept -> std::size_t;
+  /** @returns The number of flows that have not yet refilled. */
+  [[nodiscard]] auto flows() const noexcept -> std::size_t;
+
+  /**
+   * @brief Identifies the flow of a peer address.
+   * @details IPv4 peers map to distinct flows. IPv6 peers are hashed, so
+   * two of them may rarely share a flow.
+   * @param peer The peer address.
+   * @returns The flow identifier.
+   */
+  [[nodiscard]] static auto
+  flow_of(const socket_address &peer) noexcept -> flow_type;
+
+  /** @brief Cancels the release timer and drops the queued sends. */
+  ~pacer();
+
+private:
+  /** @brief Marks the end of a queue in the pool. */
+  static constexpr auto NONE = static_cast<std::uint32_t>(-1);
+
+  /** @brief A queued send. */
+  struct pending_send {
+    /** @brief The number of bytes the send will write. */
+    std::size_t size = 0;
+    /** @brief The send. */
+    send_function send;
+    /** @brief The next send of the flow, or NONE. */
+    std::uint32_t next = NONE;
+  };
+
+  /** @brief A flow's bucket and send queue. */
+  struct flow_state {
+    /** @brief The bucket's tokens in bytes. Negative while in debt. */
+    double tokens = 0;
+    /** @brief The time at which tokens was last refilled. */
+    timers::timestamp updated;
+    /** @brief The first queued send, or NONE. */
+    std::uint32_t head = NONE;
+    /** @brief The last queued send, or NONE. */
+    std::uint32_t tail = NONE;
+    /** @brief Whether the flow is in the release heap. */
+    bool scheduled = false;
+  };
+
+  /** @brief A release heap entry. */
+  struct release {
+    /** @brief The time at which the flow is due. */
+    timers::timestamp at;
+    /** @brief The flow. */
+    flow_type flow = 0;
+
+    /** @brief Orders the heap by the earliest release. */
+    auto operator>(const release &other) const noexcept -> bool
+    {
+      return at > other.at;
+    }
+  };
+
+  /**
+   * @brief Adds the tokens a flow has earned since it was last refilled.
+   * @param state The flow.
+   * @param now The current time.
+   */
+  auto refill_(flow_state &state, timers::timestamp now) const noexcept
+      -> void;
+  /**
+   * @param state The flow.
+   * @param size The size of the flow's next send, or 0 for the time at
+   * which its bucket is full.
+   * @param now The current time.
+   * @returns The time at which the flow has the tokens for the send.
+   */
+  [[nodiscard]] auto
+  due_(const flow_state &state, std::size_t size,
+       timers::timestamp now) const noexcept -> timers::timestamp;
+  /**
+   * @brief Adds a flow to the release heap.
+   * @param flow The flow.
+   * @param state The flow's state.
+   * @param at The time at which the flow is due.
+   */
+  auto schedule_(flow_type flow, flow_state &state,
+                 timers::timestamp at) -> void;
+  /** @brief Arms the release timer for the earliest release. */
+  auto arm_() -> void;
+  /**
+   * @brief Releases the queued sends of every flow that is due.
+   * @param now The current time.
+   */
+  auto release_(timers::timestamp now) -> void;
+
+  /** @brief The refill rate in bytes per second. */
+  double rate_;
+  /** @brief The bucket capacity in bytes. */
+  double burst_;
+  /** @brief The async context that releases queued sends. */
+  async_context *ctx_ = nullptr;
+  /** @brief The release timer. */
+  timers::timer_id timer_ = timers::INVALID_TIMER;
+  /** @brief The time at which the release timer fires. */
+  timers::timestamp armed_at_;
+  /** @brief Whether release_ is running. */
+  bool releasing_ = false;
+  /** @brief The flows. */
+  std::unordered_map<flow_type, flow_state> flows_;
+  /** @brief The queued sends of every flow. */
+  std::vector<pending_send> pool_;
+  /** @brief The free positions in the pool. */
+  std::vector<std::uint32_t> free_;
+  /** @brief The flows waiting for tokens, earliest first. */
+  std::priority_queue<release, std::vector<release>, std::greater<>>
+      releases_;
+};
+
+} // namespace net::service
+
+#include "impl/pacer_impl.hpp" // IWYU pragma: export
+#endif                         // CPPNET_PACER_HPP
@@ -0,0 +1,161 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file pipeline.hpp
+ * @brief This file declares a compile-time middleware pipeline.
+ */
+#pragma once
+#ifndef CPPNET_PIPELINE_HPP
+#define CPPNET_PIPELINE_HPP
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+namespace net::service {
+/**
+ * @brief A chain of middleware stages that is composed at compile time.
+ * @details Each stage is a callable that is invoked with a continuation
+ * followed by the arguments of the event:
+ * @code
+ * struct strip_prefix {
+ *   auto operator()(auto &&next, auto &service, auto &ctx,
+ *                   const auto &socket, auto rctx,
+ *                   std::span<const std::byte> buf) -> void
+ *   {
+ *     // Forward the event with a transformed buffer.
+ *     if (!buf.empty())
+ *       buf = buf.subspan(1);
+ *     next(service, ctx, socket, std::move(rctx), buf);
+ *   }
+ * };
+ * @endcode
+ * A stage forwards the event to the next stage by calling `next`, with
+ * the same or with changed arguments, or short-circuits by returning
+ * without calling it. The continuation after the last stage calls the
+ * function passed to the pipeline. Every call is resolved at compile
+ * time, so the whole chain can be inlined into the caller, and nothing
+ * is type erased. The continuation refers to the pipeline and to the
+ * last function, so it must not be called after the stage returns.
+ *
+ * An async_tcp_service or async_udp_service StreamHandler that has a
+ * `middleware` member of a pipeline type passes each event through it
+ * before `service`. The stages are called with the stream handler, then
+ * the arguments that `service` takes, and `service` is called with
+ * whatever the last stage forwards. Stages also see the events that
+ * carry no read context or no data, such as accepted and closed TCP
+ * connections, and usually forward them unchanged. A stage that
+ * short-circuits an event with a read context takes over the read loop
+ * of the connection, for instance by calling `submit_recv` itself.
+ * @code
+ * struct app : public async_tcp_service<app> {
+ *   pipeline<framing, rate_limit> middleware;
+ *
+ *   auto service(async_context &ctx, const socket_dialog &socket,
+ *                std::shared_ptr<read_context> rctx,
+ *                std::span<const std::byte> frame) -> void;
+ * };
+ * @endcode
+ * @tparam Stages The stage types, in the order that they are called.
+ */
+template <typename... Stages> class pipeline {
+public:
+  /** @brief The stages type. */
+  using stages_type = std::tuple<Stages...>;
+  /** @brief The number of stages. */
+  static constexpr std::size_t size = sizeof...(Stages);
+
+  /**
+   * @brief Calls the stages from index I onwards.
+   * @tparam I The index of the next stage.
+   * @tparam Last The type of the function called after the last stage.
+   */
+  template <std::size_t I, typename Last> class continuation {
+  public:
+    /**
+     * @brief Constructs a continuation.
+     * @param self The pipeline.
+     * @param last The function called after the last stage.
+     */
+    continuation(pipeline &self, Last &last) noexcept;
+
+    /**
+     * @brief Forwards an event to the next stage.
+     * @tparam Args The argument types.
+     * @param args The arguments of the event.
+     */
+    template <typename... Args> auto operator()(Args &&...args) const -> void;
+
+  private:
+    /** @brief The pipeline. */
+    pipeline *self_;
+    /** @brief The function called after the last stage. */
+    Last *last_;
+  };
+
+  /** @brief Default constructor. */
+  pipeline() = default;
+  /**
+   * @brief Constructs a pipeline from its stages.
+   * @param stages The stages.
+   */
+  explicit pipeline(Stages... stages)
+    requires(size > 0);
+
+  /**
+   * @brief Passes an event through the stages.
+   * @tparam Last The type of the function called after the last stage.
+   * @tparam Args The argument types.
+   * @param last The function called with the arguments forwarded by the
+   * last stage.
+   * @param args The arguments of the event.
+   */
+  template <typename Last, typename... Args>
+  auto operator()(Last &&last, Args &&...args) -> void;
+
+  /**
+   * @tparam I The stage index.
+   * @returns The stage at index I.
+   */
+  template <std::size_t I>
+  [[nodiscard]] auto get() noexcept -> std::tuple_element_t<I, stages_type> &;
+  /**
+   * @tparam Stage The stage type.
+   * @returns The stage of type Stage.
+   */
+  template <typename Stage> [[nodiscard]] auto get() noexcept -> Stage &;
+
+private:
+  /** @brief The stages. */
+  stages_type stages_;
+};
+
+/**
+ * @brief Whether a type is a pipeline.
+ * @tparam T The type.
+ */
+template <typename T> struct is_pipeline : std::false_type {};
+
+/**
+ * @brief Whether a type is a pipeline.
+ * @tparam Stages The stage types.
+ */
+template <typename... Stages>
+struct is_pipeline<pipeline<Stages...>> : std::true_type {};
+
+/** @brief Whether a type is a pipeline. */
+template <typename T>
+inline constexpr bool is_pipeline_v = is_pipeline<T>::value;
+} // namespace net::service
+
+#include "impl/pipeline_impl.hpp" // IWYU pragma: export
+#endif                            // CPPNET_PIPELINE_HPP
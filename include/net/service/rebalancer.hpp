@@ -0,0 +1,99 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file rebalancer.hpp
+ * @brief This file declares a connection rebalancer.
+ */
+#pragma once
+#ifndef CPPNET_REBALANCER_HPP
+#define CPPNET_REBALANCER_HPP
+#include "async_context.hpp"
+
+#include <mutex>
+#include <vector>
+namespace net::service {
+/**
+ * @brief Rebalances connections across async contexts.
+ * @tparam Service A stream handler derived from async_tcp_service.
+ * @details The rebalancer samples the number of reads that each registered
+ * service completed since the previous call to `rebalance`, as a measure
+ * of the utilization of the event loop that serves it. When the busiest
+ * loop exceeds the mean by more than the configured tolerance, its service
+ * is asked to shed connections to the least busy loop. Connections are
+ * shed as they re-arm their reads, so the connections that read most
+ * often are the most likely to move. `rebalance` is typically driven by a
+ * periodic timer. The registered contexts and services must outlive every
+ * call to `rebalance`, so the timer that drives it must be removed before
+ * any registered context thread is stopped.
+ * @code
+ * auto balancer = rebalancer<echo_service>();
+ * balancer.add(thread0, thread0.service());
+ * balancer.add(thread1, thread1.service());
+ * thread0.timers.add(100ms, [&](auto) { balancer.rebalance(); }, 100ms);
+ * @endcode
+ */
+template <typename Service> class rebalancer {
+public:
+  /** @brief Default constructor. */
+  rebalancer() = default;
+  /**
+   * @brief Tolerance constructor.
+   * @param tolerance The ratio of the busiest loop's reads to the mean
+   * reads per loop above which connections are shed.
+   * @param batch The number of connections to shed per rebalance.
+   */
+  explicit rebalancer(double tolerance, std::size_t batch = 1) noexcept;
+
+  /**
+   * @brief Registers an event loop with the rebalancer.
+   * @param ctx The async context that runs the event loop.
+   * @param service The service that serves connections on ctx.
+   */
+  auto add(async_context &ctx, Service &service) -> void;
+
+  /**
+   * @brief Samples the registered loops and sheds connections from the
+   * busiest loop to the least busy loop if they are out of balance.
+   * @details This method is thread-safe.
+   * @returns true if connections were shed, false otherwise.
+   */
+  auto rebalance() -> bool;
+
+private:
+  /** @brief A registered event loop. */
+  struct loop {
+    /** @brief The async context that runs the loop. */
+    async_context *ctx = nullptr;
+    /** @brief The service that serves connections on the loop. */
+    Service *service = nullptr;
+    /** @brief The service reads at the previous sample. */
+    std::uint64_t reads = 0;
+    /** @brief The reads completed between the last two samples. */
+    std::uint64_t load = 0;
+  };
+
+  /** @brief The registered loops. */
+  std::vector<loop> loops_;
+  /** @brief The imbalance tolerance. */
+  double tolerance_ = 1.5;
+  /** @brief The number of connections to shed per rebalance. */
+  std::size_t batch_ = 1;
+  /** @brief Mutex for thread-safety. */
+  std::mutex mtx_;
+};
+} // namespace net::service
+
+#include "impl/rebalancer_impl.hpp" // IWYU pragma: export
+
+#endif // CPPNET_REBALANCER_HPP
@@ -0,0 +1,171 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file request_lifecycle.hpp
+ * @brief This file declares sampled request lifecycle timing.
+ */
+#pragma once
+#ifndef CPPNET_REQUEST_LIFECYCLE_HPP
+#define CPPNET_REQUEST_LIFECYCLE_HPP
+#include "latency_histogram.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+namespace net::service {
+/**
+ * @brief Times where sampled requests spend their time, phase by phase.
+ * @details Each connection carries a set of `stamps` that the service
+ * fills in as a request moves through its lifecycle: accept, first
+ * readable, stream handler entry and exit, send submitted and send
+ * completed. The time between stamps is recorded in one
+ * latency_histogram per phase, so percentiles are available for each
+ * phase of the service as a whole.
+ *
+ * Only one in `sample_every` requests, and one in `sample_every`
+ * accepted connections, are timed. An unsampled request costs a counter
+ * increment and a branch at each stamp, and reads no clocks.
+ *
+ * An async_tcp_service stream handler with a `lifecycle` member of this
+ * type has the accept, readable, entry and exit stamps taken by the
+ * service. The stream handler takes the send stamps itself, since it
+ * makes the sends, by calling `submitted` and `completed` with the
+ * stamps of the read context.
+ * @code
+ * lifecycle.submitted(rctx->stamps);
+ * // ... then, when the send completes:
+ * lifecycle.completed(rctx->stamps);
+ * auto p99 = lifecycle.histogram(request_lifecycle::total).percentile(99);
+ * @endcode
+ */
+class request_lifecycle {
+public:
+  /** @brief The clock type. */
+  using clock = std::chrono::steady_clock;
+  /** @brief The timestamp type. */
+  using timestamp = clock::time_point;
+
+  /** @brief The timed phases of a request. */
+  enum phase : std::uint8_t {
+    /** @brief From accept to the first readable data. */
+    first_byte,
+    /** @brief From readable to stream handler entry. */
+    dispatch,
+    /** @brief From stream handler entry to exit. */
+    service,
+    /** @brief From readable to the response send being submitted. */
+    submit,
+    /** @brief From send submitted to send completed. */
+    send,
+    /** @brief From readable to send completed. */
+    total,
+    /** @brief The number of phases. */
+    END
+  };
+
+  /** @brief The lifecycle timestamps of one connection. */
+  struct stamps {
+    /** @brief When the connection was accepted, if it was sampled. */
+    timestamp accepted;
+    /** @brief When the request became readable. */
+    timestamp readable;
+    /** @brief When the stream handler was entered. */
+    timestamp entered;
+    /** @brief When the response send was submitted. */
+    timestamp submitted;
+    /** @brief Whether the current request is sampled. */
+    bool sampled = false;
+  };
+
+  /**
+   * @brief Constructs a request lifecycle.
+   * @param sample_every Time one in this many requests. Zero disables
+   * sampling.
+   */
+  explicit request_lifecycle(std::size_t sample_every = 100) noexcept;
+
+  /**
+   * @brief Stamps a newly accepted connection.
+   * @param stamps The stamps of the connection.
+   */
+  auto accepted(stamps &stamps) noexcept -> void;
+  /**
+   * @brief Starts a request when its first bytes have been read.
+   * @details Decides whether the request is sampled, and records the
+   * first_byte phase if this is the first request of a sampled
+   * connection. While a sampled request is outstanding, later reads
+   * neither make a sampling decision nor restamp it.
+   * @param stamps The stamps of the connection.
+   */
+  auto readable(stamps &stamps) noexcept -> void;
+  /**
+   * @brief Stamps stream handler entry.
+   * @param stamps The stamps of the connection.
+   */
+  auto entered(stamps &stamps) noexcept -> void;
+  /**
+   * @brief Stamps stream handler exit.
+   * @param stamps The stamps of the connection.
+   */
+  auto exited(stamps &stamps) noexcept -> void;
+  /**
+   * @brief Stamps the submission of the response send.
+   * @param stamps The stamps of the connection.
+   */
+  auto submitted(stamps &stamps) noexcept -> void;
+  /**
+   * @brief Stamps the completion of the response send and ends the
+   * request.
+   * @param stamps The stamps of the connection.
+   */
+  auto completed(stamps &stamps) noexcept -> void;
+
+  /**
+   * @param which The phase.
+   * @returns The histogram of a phase.
+   */
+  [[nodiscard]] auto
+  histogram(phase which) const noexcept -> const latency_histogram &;
+  /** @brief Clears every histogram. */
+  auto reset() noexcept -> void;
+
+private:
+  /**
+   * @brief Records a phase.
+   * @param which The phase.
+   * @param from The start of the phase.
+   * @param to The end of the phase.
+   */
+  auto record_(phase which, timestamp from, timestamp to) noexcept -> void;
+  /**
+   * @brief Advances a sampling sequence.
+   * @param sequence The sequence to advance.
+   * @returns true if the next event is sampled.
+   */
+  [[nodiscard]] auto sample_(std::size_t &sequence) const noexcept -> bool;
+
+  /** @brief Time one in this many requests. */
+  std::size_t sample_every_;
+  /** @brief The number of requests seen. */
+  std::size_t requests_ = 0;
+  /** @brief The number of connections accepted. */
+  std::size_t connections_ = 0;
+  /** @brief The phase histograms. */
+  std::array<latency_histogram, END> phases_{};
+};
+} // namespace net::service
+
+#include "impl/request_lifecycle_impl.hpp" // IWYU pragma: export
+#endif                                     // CPPNET_REQUEST_LIFECYCLE_HPP
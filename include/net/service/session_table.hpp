@@ -0,0 +1,175 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file session_table.hpp
+ * @brief This file declares a table of per-peer session state.
+ */
+#pragma once
+#ifndef CPPNET_SESSION_TABLE_HPP
+#define CPPNET_SESSION_TABLE_HPP
+#include "net/timers/timers.hpp"
+
+#include <io/io.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <netinet/in.h>
+namespace net::service {
+/**
+ * @brief An open-addressing hash table of session state keyed by peer
+ * address.
+ * @details Sessions are stored contiguously, and the hash index holds
+ * only a 32-bit hash and a session index per slot, so lookups probe a
+ * dense array of 8 byte slots and touch at most one session. The index
+ * uses linear probing and is kept at most half full. Erasing a session
+ * moves the last session into its place, so erasure does not leave
+ * tombstones and iteration stays dense.
+ *
+ * Each session records when it was last looked up with `get`. `expire`
+ * erases the sessions that have been idle for longer than the timeout.
+ * Inserting or erasing sessions invalidates references to other sessions.
+ *
+ * An async_udp_service stream handler with a `sessions` member of this
+ * type receives the session of each datagram's peer, and its idle sessions
+ * are expired on the timers of the service's async context.
+ * @tparam State The per-peer session state. It must be default
+ * constructible and movable.
+ * @code
+ * struct peer_state { std::uint64_t sequence = 0; };
+ * auto sessions = session_table<peer_state>(std::chrono::seconds(30));
+ * auto &state = sessions.get(*rctx->msg.address, timers::clock::now());
+ * @endcode
+ */
+template <typename State> class session_table {
+public:
+  /** @brief The session state type. */
+  using state_type = State;
+  /** @brief The peer address type. */
+  using socket_address = io::socket::socket_address<sockaddr_in6>;
+  /** @brief The timestamp type. */
+  using timestamp = timers::timestamp;
+  /** @brief The idle timeout type. */
+  using duration = timers::duration;
+
+  /**
+   * @brief Constructs an empty table.
+   * @param timeout How long a session may be idle before it expires.
+   */
+  explicit session_table(duration timeout) noexcept;
+
+  /**
+   * @brief Finds the session of a peer, creating it if it doesn't exist.
+   * @param peer The peer address.
+   * @param now The current time. The session is marked as active at now.
+   * @returns The session state.
+   */
+  auto get(const socket_address &peer, timestamp now) -> State &;
+  /**
+   * @brief Finds the session of a peer.
+   * @param peer The peer address.
+   * @returns The session state, or nullptr if the peer has no session.
+   */
+  [[nodiscard]] auto find(const socket_address &peer) noexcept -> State *;
+  /**
+   * @brief Erases the session of a peer.
+   * @param peer The peer address.
+   * @returns true if the peer had a session.
+   */
+  auto erase(const socket_address &peer) -> bool;
+  /**
+   * @brief Erases the sessions that have been idle for longer than the
+   * timeout.
+   * @param now The current time.
+   * @returns The number of sessions erased.
+   */
+  auto expire(timestamp now) -> std::size_t;
+
+  /** @returns The number of sessions. */
+  [[nodiscard]] auto size() const noexcept -> std::size_t;
+  /** @returns The idle timeout. */
+  [[nodiscard]] auto timeout() const noexcept -> duration;
+
+private:
+  /** @brief A peer address reduced to its identifying fields. */
+  struct key_type {
+    /** @brief The IPv6 address, or the IPv4 address in the first word. */
+    std::array<std::uint32_t, 4> address{};
+    /** @brief The port in the low 16 bits and the family above them. */
+    std::uint32_t port_family = 0;
+
+    /** @brief Equality comparison. */
+    auto operator==(const key_type &) const -> bool = default;
+  };
+
+  /** @brief A session. */
+  struct entry {
+    /** @brief The peer. */
+    key_type key;
+    /** @brief The time of the last lookup. */
+    timestamp last_seen;
+    /** @brief The session state. */
+    State state;
+  };
+
+  /** @brief A hash index slot. */
+  struct slot {
+    /** @brief The hash of the session key. */
+    std::uint32_t hash = 0;
+    /** @brief The session index plus one, or 0 if the slot is empty. */
+    std::uint32_t index = 0;
+  };
+
+  /**
+   * @brief Reduces a peer address to a key.
+   * @param peer The peer address.
+   * @returns The key.
+   */
+  static auto make_key(const socket_address &peer) noexcept -> key_type;
+  /**
+   * @brief Hashes a key.
+   * @param key The key.
+   * @returns The hash.
+   */
+  static auto hash(const key_type &key) noexcept -> std::uint32_t;
+  /**
+   * @brief Finds the slot that holds a key.
+   * @param key The key.
+   * @param hash The hash of the key.
+   * @returns The position of the slot that holds the key, or of the empty
+   * slot that ends its probe sequence.
+   */
+  [[nodiscard]] auto probe_(const key_type &key,
+                            std::uint32_t hash) const noexcept -> std::size_t;
+  /**
+   * @brief Erases the session at an index.
+   * @param index The session index.
+   */
+  auto erase_(std::size_t index) noexcept -> void;
+  /** @brief Doubles the size of the hash index. */
+  auto grow_() -> void;
+
+  /** @brief The idle timeout. */
+  duration timeout_;
+  /** @brief The sessions. */
+  std::vector<entry> entries_;
+  /** @brief The hash index. Its size is zero or a power of two. */
+  std::vector<slot> slots_;
+};
+
+} // namespace net::service
+
+#include "impl/session_table_impl.hpp" // IWYU pragma: export
+#endif                                 // CPPNET_SESSION_TABLE_HPP
@@ -0,0 +1,69 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file shared_buffer.hpp
+ * @brief This file declares an immutable reference-counted buffer.
+ */
+#pragma once
+#ifndef CPPNET_SHARED_BUFFER_HPP
+#define CPPNET_SHARED_BUFFER_HPP
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string_view>
+namespace net::service {
+/**
+ * @brief An immutable, reference-counted byte buffer.
+ * @details The bytes are copied into a single allocation when the buffer
+ * is constructed. Copying a shared_buffer only copies a reference, so one
+ * payload can back any number of in-flight sends, and the allocation is
+ * released once the last send that references it completes.
+ */
+class shared_buffer {
+public:
+  /** @brief Default constructor. Constructs an empty buffer. */
+  shared_buffer() = default;
+  /**
+   * @brief Copies bytes into a new shared buffer.
+   * @param bytes The bytes to copy.
+   */
+  inline explicit shared_buffer(std::span<const std::byte> bytes);
+  /**
+   * @brief Copies a string into a new shared buffer.
+   * @param str The string to copy.
+   */
+  inline explicit shared_buffer(std::string_view str);
+
+  /** @returns A pointer to the first byte of the buffer. */
+  [[nodiscard]] inline auto data() const noexcept -> const std::byte *;
+  /** @returns The number of bytes in the buffer. */
+  [[nodiscard]] inline auto size() const noexcept -> std::size_t;
+  /** @returns true if the buffer is empty. */
+  [[nodiscard]] inline auto empty() const noexcept -> bool;
+  /** @returns A span over the bytes in the buffer. */
+  [[nodiscard]] inline auto span() const noexcept -> std::span<const std::byte>;
+  /** @returns The number of shared_buffers that reference the bytes. */
+  [[nodiscard]] inline auto use_count() const noexcept -> long;
+
+private:
+  /** @brief The shared bytes. */
+  std::shared_ptr<const std::byte[]> bytes_;
+  /** @brief The number of bytes. */
+  std::size_t size_ = 0;
+};
+} // namespace net::service
+
+#include "impl/shared_buffer_impl.hpp" // IWYU pragma: export
+
+#endif // CPPNET_SHARED_BUFFER_HPP
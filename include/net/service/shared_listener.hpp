@@ -0,0 +1,176 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file shared_listener.hpp
+ * @brief This file declares a listening socket shared by context threads.
+ */
+#pragma once
+#ifndef CPPNET_SHARED_LISTENER_HPP
+#define CPPNET_SHARED_LISTENER_HPP
+#include "async_context.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <vector>
+namespace net::service {
+/**
+ * @brief One listening socket that is shared by TCP services running on
+ * several async contexts.
+ * @details Every context that joins the listener polls its own duplicate
+ * of the listening socket, but only one context at a time waits for a
+ * connection. That context holds the accept token. When it accepts a
+ * connection it passes the token to the next context in round-robin
+ * order, which starts waiting in turn. Each incoming connection
+ * therefore wakes exactly one event loop, connections are spread evenly
+ * across the contexts, and contexts can join and leave without rebinding
+ * the port. This gives the exclusive wakeups of EPOLLEXCLUSIVE on top of
+ * the poll multiplexer.
+ *
+ * The token is handed over on the timers of the next context, so a
+ * context whose event loop is busy can not take it. If the next context
+ * has not started waiting within `handoff_timeout`, the context that
+ * passed the token passes it on again, skipping the busy one.
+ *
+ * Services use the listener by passing it to the async_tcp_service
+ * constructor. The first service to start binds and listens on the
+ * socket. The listener must outlive every context that joins it.
+ * @code
+ * auto listener = shared_listener(address);
+ * auto threads = std::array<basic_context_thread<echo_service>, 4>{};
+ * for (auto &thread : threads)
+ *   thread.start(listener);
+ * @endcode
+ */
+class shared_listener {
+public:
+  /** @brief Templated socket address type. */
+  template <typename T> using socket_address = io::socket::socket_address<T>;
+  /** @brief The async context type. */
+  using async_context = service::async_context;
+  /** @brief The socket handle type. */
+  using socket_handle = io::socket::socket_handle;
+  /** @brief The native socket type. */
+  using socket_type = io::socket::native_socket_type;
+  /** @brief The time a context has to take the accept token. */
+  static constexpr auto handoff_timeout = std::chrono::milliseconds(10);
+
+  /**
+   * @brief Constructs a shared listener.
+   * @tparam T The socket address type.
+   * @param address The address to listen on.
+   */
+  template <typename T>
+  explicit shared_listener(socket_address<T> address) noexcept;
+
+  /**
+   * @brief Creates the listening socket if it has not been created yet.
+   * @tparam Fn The socket initializer type.
+   * @param initialize Binds and listens on the new socket.
+   * @returns A default constructed error code if the socket is listening,
+   * otherwise the error that the socket failed with.
+   */
+  template <typename Fn>
+    requires std::is_invocable_r_v<std::error_code, Fn,
+                                   const socket_handle &>
+  auto open(Fn &&initialize) -> std::error_code;
+
+  /**
+   * @brief Adds a participant.
+   * @details The first participant to join receives the accept token and
+   * is armed immediately.
+   * @param id The participant.
+   * @param ctx The async context of the participant.
+   * @param arm Starts waiting for a connection. Runs on ctx.
+   */
+  auto join(const void *id, async_context &ctx,
+            std::function<void()> arm) -> void;
+  /**
+   * @brief Passes the accept token to the next participant.
+   * @details Does nothing if the participant does not hold the token.
+   * Must be called on the async context of the participant.
+   * @param id The participant.
+   */
+  auto pass(const void *id) -> void;
+  /**
+   * @brief Removes a participant, passing on the token if it is held.
+   * @param id The participant.
+   */
+  auto leave(const void *id) -> void;
+
+  /** @returns The address that the listener is bound to. */
+  [[nodiscard]] auto address() const -> socket_address<sockaddr_in6>;
+  /** @returns The native listening socket handle. */
+  [[nodiscard]] auto native_handle() const -> socket_type;
+
+private:
+  /** @brief A service that accepts on the listener. */
+  struct participant {
+    /** @brief The participant. */
+    const void *id;
+    /** @brief The async context of the participant. */
+    async_context *ctx;
+    /** @brief Starts waiting for a connection. */
+    std::function<void()> arm;
+  };
+
+  /**
+   * @brief Hands the token to the participant at index. The caller must
+   * hold the lock.
+   * @param index The participant index. Clears the token if it is out of
+   * range.
+   * @returns The participant to arm, if any.
+   */
+  auto hand_to_(std::size_t index) -> std::optional<participant>;
+  /**
+   * @brief Arms the new token holder on its async context.
+   * @param holder The new token holder.
+   * @param handoff The handoff that gave holder the token.
+   * @param from The async context that passed the token, which passes it
+   * on again if holder does not take it in time. May be null.
+   */
+  auto arm_(const participant &holder, std::uint64_t handoff,
+            async_context *from) -> void;
+  /**
+   * @brief Passes the token on from a holder that has not taken it.
+   * @param id The holder.
+   * @param handoff The handoff that gave id the token.
+   * @param from The async context that passed the token.
+   */
+  auto skip_(const void *id, std::uint64_t handoff,
+             async_context *from) -> void;
+
+  /** @brief The listening address. */
+  socket_address<sockaddr_in6> address_;
+  /** @brief The listening socket. */
+  std::optional<socket_handle> socket_;
+  /** @brief The participants, in token passing order. */
+  std::vector<participant> participants_;
+  /** @brief The participant that holds the accept token. */
+  const void *token_ = nullptr;
+  /** @brief Counts the times the token has been handed over. */
+  std::uint64_t handoff_ = 0;
+  /** @brief Whether the holder has started waiting for a connection. */
+  bool armed_ = false;
+  /** @brief Mutex for thread-safety. */
+  mutable std::mutex mtx_;
+};
+
+} // namespace net::service
+
+#include "impl/shared_listener_impl.hpp" // IWYU pragma: export
+#endif                                   // CPPNET_SHARED_LISTENER_HPP
@@ -0,0 +1,297 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file task.hpp
+ * @brief This file declares a lazy coroutine task with pooled frames.
+ */
+#pragma once
+#ifndef CPPNET_TASK_HPP
+#define CPPNET_TASK_HPP
+#include <array>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <variant>
+namespace net::service {
+/**
+ * @brief A thread local pool of coroutine frames.
+ * @details Blocks are kept in power of two size classes from `min_block`
+ * bytes up to `min_block << (size_classes - 1)` bytes, with one free list
+ * per size class on each thread. Freed blocks are cached on the thread
+ * that frees them, up to `max_cached` blocks per size class, so a thread
+ * that starts and finishes coroutines of similar sizes reuses the same
+ * blocks instead of going back to the allocator. Larger blocks are not
+ * pooled.
+ */
+class frame_pool {
+public:
+  /** @brief The smallest block size. */
+  static constexpr std::size_t min_block = 64;
+  /** @brief The number of size classes. */
+  static constexpr std::size_t size_classes = 11;
+  /** @brief The most blocks cached per size class on each thread. */
+  static constexpr std::size_t max_cached = 256;
+
+  /**
+   * @brief Allocates a block.
+   * @param size The minimum size of the block.
+   * @returns A block of at least `size` bytes.
+   * @throws std::bad_alloc if there are no cached blocks and the
+   * allocator fails.
+   */
+  [[nodiscard]] static auto allocate(std::size_t size) -> void *;
+  /**
+   * @brief Returns a block to the pool of the calling thread.
+   * @param ptr The block.
+   * @param size The size that the block was allocated with.
+   */
+  static auto deallocate(void *ptr, std::size_t size) noexcept -> void;
+  /** @returns The number of blocks cached by the calling thread. */
+  [[nodiscard]] static auto cached() noexcept -> std::size_t;
+  /** @brief Frees every block cached by the calling thread. */
+  static auto release() noexcept -> void;
+
+private:
+  /** @brief A cached block. */
+  struct block {
+    /** @brief The next cached block. */
+    block *next;
+  };
+  /** @brief The cached blocks of one size class. */
+  struct free_list {
+    /** @brief The first cached block. */
+    block *head = nullptr;
+    /** @brief The number of cached blocks. */
+    std::size_t size = 0;
+  };
+  /** @brief The free lists of one thread. */
+  struct cache {
+    /** @brief Default constructor. */
+    cache() = default;
+    /** @brief Deleted copy constructor. */
+    cache(const cache &) = delete;
+    /** @brief Deleted move constructor. */
+    cache(cache &&) = delete;
+    /** @brief Deleted copy assignment. */
+    auto operator=(const cache &) -> cache & = delete;
+    /** @brief Deleted move assignment. */
+    auto operator=(cache &&) -> cache & = delete;
+    /** @brief Frees the cached blocks. */
+    ~cache();
+
+    /** @brief The free lists, by size class. */
+    std::array<free_list, size_classes> lists{};
+  };
+
+  /**
+   * @param size A block size.
+   * @returns The size class of the block.
+   */
+  [[nodiscard]] static auto size_class(std::size_t size) noexcept
+      -> std::size_t;
+  /** @returns The cache of the calling thread. */
+  [[nodiscard]] static auto local() noexcept -> cache &;
+};
+
+/** @brief Internal net::service implementation details. */
+namespace detail {
+/**
+ * @brief Stores the result of a task.
+ * @tparam T The result type.
+ */
+template <typename T> class task_result {
+public:
+  /**
+   * @brief Stores the value returned by the coroutine.
+   * @param value The returned value.
+   */
+  auto return_value(T value) -> void;
+  /** @brief Stores the exception that escaped the coroutine. */
+  auto unhandled_exception() noexcept -> void;
+  /**
+   * @returns The returned value.
+   * @throws The exception that escaped the coroutine, if any.
+   */
+  auto result() -> T;
+
+private:
+  /** @brief The result. */
+  std::variant<std::monostate, T, std::exception_ptr> result_;
+};
+
+/** @brief Stores the result of a task that returns nothing. */
+template <> class task_result<void> {
+public:
+  /** @brief Marks the coroutine as returned. */
+  auto return_void() noexcept -> void;
+  /** @brief Stores the exception that escaped the coroutine. */
+  auto unhandled_exception() noexcept -> void;
+  /** @throws The exception that escaped the coroutine, if any. */
+  auto result() -> void;
+
+private:
+  /** @brief The exception that escaped the coroutine. */
+  std::exception_ptr exception_;
+};
+} // namespace detail
+
+/**
+ * @brief A lazily started coroutine that completes with a T.
+ * @details A task does not run until it is awaited, or until it is
+ * started with `start`. An awaiting coroutine is resumed by symmetric
+ * transfer when the task completes, so chains of tasks do not grow the
+ * stack. Task frames are allocated from the `frame_pool`.
+ * @code
+ * auto read_header(connection &conn) -> task<std::size_t>
+ * {
+ *   co_return co_await conn.read(header);
+ * }
+ *
+ * auto handle(connection &conn) -> task<void>
+ * {
+ *   auto len = co_await read_header(conn);
+ * }
+ * @endcode
+ * @tparam T The result type.
+ */
+template <typename T = void> class [[nodiscard]] task {
+public:
+  /** @brief The result type. */
+  using value_type = T;
+  /** @brief The completion callback of a started task. */
+  using done_type = void (*)(void *) noexcept;
+
+  /** @brief The coroutine promise. */
+  class promise_type : public detail::task_result<T> {
+  public:
+    /**
+     * @brief Allocates a coroutine frame from the frame pool.
+     * @param size The frame size.
+     * @returns The frame.
+     */
+    [[nodiscard]] static auto operator new(std::size_t size) -> void *;
+    /**
+     * @brief Returns a coroutine frame to the frame pool.
+     * @param ptr The frame.
+     * @param size The frame size.
+     */
+    static auto operator delete(void *ptr, std::size_t size) noexcept -> void;
+
+    /** @returns The task that owns the coroutine. */
+    auto get_return_object() noexcept -> task;
+    /** @returns An awaiter that suspends the coroutine until it is started. */
+    static auto initial_suspend() noexcept -> std::suspend_always;
+
+    /** @brief Resumes whatever waits on the task. */
+    struct final_awaiter {
+      /** @returns false. */
+      [[nodiscard]] static auto await_ready() noexcept -> bool;
+      /**
+       * @param handle The completed coroutine.
+       * @returns The awaiting coroutine, if there is one.
+       */
+      static auto await_suspend(std::coroutine_handle<promise_type> handle)
+          noexcept -> std::coroutine_handle<>;
+      /** @brief Never called. */
+      static auto await_resume() noexcept -> void;
+    };
+    /** @returns An awaiter that resumes whatever waits on the task. */
+    static auto final_suspend() noexcept -> final_awaiter;
+
+    /** @brief The coroutine awaiting the task. */
+    std::coroutine_handle<> continuation;
+    /** @brief The completion callback of a started task. */
+    done_type on_done = nullptr;
+    /** @brief The argument of the completion callback. */
+    void *arg = nullptr;
+  };
+
+  /** @brief The coroutine handle type. */
+  using handle_type = std::coroutine_handle<promise_type>;
+
+  /** @brief Awaits the completion of a task. */
+  struct awaiter {
+    /** @returns Whether the task has no coroutine to run. */
+    [[nodiscard]] auto await_ready() const noexcept -> bool;
+    /**
+     * @brief Starts the task.
+     * @param continuation The awaiting coroutine.
+     * @returns The coroutine of the task.
+     */
+    auto await_suspend(std::coroutine_handle<> continuation) noexcept
+        -> std::coroutine_handle<>;
+    /**
+     * @returns The result of the task.
+     * @throws The exception that escaped the task, if any.
+     */
+    auto await_resume() -> T;
+
+    /** @brief The coroutine of the task. */
+    handle_type handle;
+  };
+
+  /** @brief Default constructor. */
+  task() noexcept = default;
+  /**
+   * @brief Move constructor.
+   * @param other The task to move from.
+   */
+  task(task &&other) noexcept;
+  /**
+   * @brief Move assignment.
+   * @param other The task to move from.
+   * @returns A reference to this task.
+   */
+  auto operator=(task &&other) noexcept -> task &;
+  /** @brief Deleted copy constructor. */
+  task(const task &) = delete;
+  /** @brief Deleted copy assignment. */
+  auto operator=(const task &) -> task & = delete;
+  /** @brief Destroys the coroutine, if there is one. */
+  ~task();
+
+  /** @returns An awaiter that runs the task to completion. */
+  auto operator co_await() && noexcept -> awaiter;
+  /**
+   * @brief Runs the task without awaiting it.
+   * @details The task runs until its first suspension before `start`
+   * returns. `on_done` is called with `arg` when the coroutine completes,
+   * and it may destroy the task.
+   * @param on_done The completion callback, or nullptr.
+   * @param arg The argument of the completion callback.
+   */
+  auto start(done_type on_done = nullptr,
+             void *arg = nullptr) noexcept -> void;
+  /** @returns Whether the coroutine has completed. */
+  [[nodiscard]] auto done() const noexcept -> bool;
+  /**
+   * @returns The result of a completed task.
+   * @throws The exception that escaped the task, if any.
+   */
+  auto result() -> T;
+
+private:
+  /**
+   * @brief Takes ownership of a coroutine.
+   * @param handle The coroutine.
+   */
+  explicit task(handle_type handle) noexcept;
+
+  /** @brief The coroutine. */
+  handle_type handle_;
+};
+} // namespace net::service
+
+#include "impl/task_impl.hpp" // IWYU pragma: export
+#endif                        // CPPNET_TASK_HPP
@@ -0,0 +1,298 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file tcp_multiplexer.hpp
+ * @brief This file declares a pipelined TCP request/response client.
+ */
+#pragma once
+#ifndef CPPNET_TCP_MULTIPLEXER_HPP
+#define CPPNET_TCP_MULTIPLEXER_HPP
+#include "async_context.hpp"
+#include "net/detail/immovable.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+namespace net::service {
+/**
+ * @brief A client that multiplexes many outstanding requests over a single
+ * TCP connection.
+ * @details Every request is sent as a frame that consists of a 4 byte
+ * payload length and an 8 byte correlation ID, both in network byte
+ * order, followed by the payload. The peer answers each request with a
+ * frame in the same format that carries the correlation ID of the
+ * request. Responses may arrive in any order, so a slow request does not
+ * hold back the responses queued behind it.
+ *
+ * Requests are senders that complete with the response payload, or with an
+ * error code if the request timed out or the connection failed. Requests
+ * may be started from any thread. They are framed and written on the
+ * thread that runs the async context, and every request that is submitted
+ * in one event loop iteration is written with a single send. The
+ * connection is established when the first request is sent, and it is
+ * re-established by the first request after it fails. The multiplexer must
+ * outlive all of its requests, and it must not be destroyed while its
+ * connection is open on a running async context. Call `close` and wait for
+ * the context to stop first.
+ * @code
+ * auto client = tcp_multiplexer(ctx, address);
+ * auto [response] = *stdexec::sync_wait(client.request(payload));
+ * @endcode
+ */
+class tcp_multiplexer {
+public:
+  /** @brief Templated socket address type. */
+  template <typename T> using socket_address = io::socket::socket_address<T>;
+  /** @brief The async context type. */
+  using async_context = service::async_context;
+  /** @brief The socket dialog type. */
+  using socket_dialog = async_context::socket_dialog;
+  /** @brief The correlation ID type. */
+  using correlation_id = std::uint64_t;
+  /** @brief The response payload type. */
+  using response_type = std::vector<std::byte>;
+  /** @brief The request timeout type. */
+  using duration = timers::duration;
+
+  /** @brief The size of a frame header. */
+  static constexpr std::size_t header_size =
+      sizeof(std::uint32_t) + sizeof(correlation_id);
+  /** @brief The default maximum response payload size. (16MiB). */
+  static constexpr std::size_t default_max_response = 16UL * 1024 * 1024;
+
+  /** @brief An outstanding request. */
+  struct request_base : net::detail::immovable {
+    /** @brief The request frame. The correlation ID is set on submit. */
+    std::vector<std::byte> frame;
+    /** @brief The time to wait for a response. */
+    duration timeout{};
+    /** @brief The timeout timer. */
+    timers::timer_id timer = timers::INVALID_TIMER;
+
+    /**
+     * @brief Completes the request.
+     * @param error The error the request failed with, if any.
+     * @param response The response payload.
+     */
+    virtual auto complete(std::error_code error,
+                          response_type response) noexcept -> void = 0;
+
+  protected:
+    /** @brief Default destructor. */
+    ~request_base() = default;
+  };
+
+  /**
+   * @brief The operation state of a request.
+   * @tparam Receiver The receiver of the response.
+   */
+  template <typename Receiver> struct request_state : request_base {
+    /**
+     * @brief Constructs a request that is not yet submitted.
+     * @param mux The multiplexer to submit the request to.
+     * @param frame The request frame.
+     * @param timeout The time to wait for a response.
+     * @param receiver The receiver of the response.
+     */
+    request_state(tcp_multiplexer *mux, std::vector<std::byte> frame,
+                  duration timeout, Receiver receiver);
+
+    /** @brief Submits the request to the multiplexer. */
+    auto start() noexcept -> void;
+
+    /**
+     * @brief Completes the receiver.
+     * @param error The error the request failed with, if any.
+     * @param response The response payload.
+     */
+    auto complete(std::error_code error,
+                  response_type response) noexcept -> void override;
+
+    /** @brief The multiplexer. */
+    tcp_multiplexer *mux;
+    /** @brief The receiver of the response. */
+    Receiver receiver;
+  };
+
+  /** @brief The sender for a request. */
+  struct sender {
+    /** @brief The sender concept. */
+    using sender_concept = stdexec::sender_t;
+    /** @brief The completion signatures. */
+    using completion_signatures =
+        stdexec::completion_signatures<stdexec::set_value_t(response_type),
+                                       stdexec::set_error_t(std::error_code)>;
+
+    /**
+     * @brief Connects the request to a receiver.
+     * @tparam Receiver The receiver type.
+     * @param receiver The receiver of the response.
+     * @returns The operation state of the request.
+     */
+    template <typename Receiver>
+    auto
+    connect(Receiver &&receiver) -> request_state<std::decay_t<Receiver>>;
+
+    /** @brief The multiplexer. */
+    tcp_multiplexer *mux;
+    /** @brief The request frame. */
+    std::vector<std::byte> frame;
+    /** @brief The time to wait for a response. */
+    duration timeout;
+  };
+
+  /**
+   * @brief Constructs a multiplexer for a server address.
+   * @tparam T The socket address type.
+   * @param ctx The async context that runs the connection.
+   * @param address The server address.
+   * @param timeout The default time to wait for a response.
+   * @param max_response The largest response payload to accept. A larger
+   * response header fails the connection with `std::errc::message_size`
+   * before any memory is reserved for the payload.
+   */
+  template <typename T>
+  tcp_multiplexer(async_context &ctx, socket_address<T> address,
+                  duration timeout = std::chrono::seconds(1),
+                  std::size_t max_response = default_max_response);
+
+  /**
+   * @brief Makes a request with the default timeout.
+   * @param payload The request payload.
+   * @returns A sender that completes with the response payload.
+   */
+  auto request(std::span<const std::byte> payload) -> sender;
+  /**
+   * @brief Makes a request.
+   * @param payload The request payload.
+   * @param timeout The time to wait for a response.
+   * @returns A sender that completes with the response payload.
+   */
+  auto request(std::span<const std::byte> payload,
+               duration timeout) -> sender;
+
+  /**
+   * @brief Shuts down the connection. Thread-safe.
+   * @details Requests that are waiting for a response fail once the
+   * shutdown is observed by the async context.
+   */
+  auto close() noexcept -> void;
+
+  /** @returns The number of requests that are waiting for a response. */
+  [[nodiscard]] auto in_flight() const noexcept -> std::size_t;
+
+private:
+  /** @brief The native socket type. */
+  using socket_type = io::socket::native_socket_type;
+
+  /** @brief The connection states. */
+  enum class connection_states : std::uint8_t {
+    DISCONNECTED,
+    CONNECTING,
+    CONNECTED
+  };
+
+  /**
+   * @brief Submits a started request. Thread-safe.
+   * @param request The request to submit.
+   */
+  auto submit_(request_base *request) -> void;
+  /** @brief Frames the submitted requests and writes them. */
+  auto flush_() -> void;
+  /** @brief Connects to the server. */
+  auto connect_() -> void;
+  /** @brief Writes the framed requests if no write is in flight. */
+  auto write_() -> void;
+  /**
+   * @brief Writes the remainder of the in-flight write buffer.
+   * @param offset The number of bytes already written.
+   */
+  auto send_(std::size_t offset) -> void;
+  /** @brief Reads responses off the connection. */
+  auto recv_() -> void;
+  /** @brief Completes every request that has a whole response frame. */
+  auto demultiplex_() -> void;
+  /**
+   * @brief Times out a request.
+   * @param id The correlation ID of the request.
+   */
+  auto expire_(correlation_id id) -> void;
+  /**
+   * @brief Fails every outstanding request and closes the connection.
+   * @param error The error to fail the requests with.
+   */
+  auto fail_(std::error_code error) -> void;
+
+  /**
+   * @brief Stores an unsigned integer in network byte order.
+   * @param bytes The bytes to store the integer in.
+   * @param value The integer to store.
+   */
+  static auto store_(std::span<std::byte> bytes,
+                     std::uint64_t value) noexcept -> void;
+  /**
+   * @brief Loads an unsigned integer stored in network byte order.
+   * @param bytes The bytes to load the integer from.
+   * @returns The integer.
+   */
+  static auto
+  load_(std::span<const std::byte> bytes) noexcept -> std::uint64_t;
+
+  /** @brief The async context. */
+  async_context *ctx_;
+  /** @brief The server address. */
+  socket_address<sockaddr_in6> address_;
+  /** @brief The default request timeout. */
+  duration timeout_;
+  /** @brief The largest response payload to accept. */
+  std::size_t max_response_;
+  /** @brief The connection, if any. */
+  std::optional<socket_dialog> socket_;
+  /** @brief The native connection socket handle. */
+  std::atomic<socket_type> sockfd_ = io::socket::INVALID_SOCKET;
+  /** @brief The connection state. */
+  connection_states state_ = connection_states::DISCONNECTED;
+  /** @brief Incremented when a connection fails to ignore stale I/O. */
+  std::uint64_t generation_ = 0;
+  /** @brief The next correlation ID. */
+  correlation_id next_id_ = 0;
+  /** @brief Requests waiting for a response, by correlation ID. */
+  std::unordered_map<correlation_id, request_base *> requests_;
+  /** @brief Frames waiting to be written. */
+  std::vector<std::byte> pending_;
+  /** @brief Frames being written. */
+  std::vector<std::byte> writing_;
+  /** @brief Response bytes that have not been demultiplexed. */
+  std::vector<std::byte> read_buffer_;
+  /** @brief The number of valid bytes in the read buffer. */
+  std::size_t read_size_ = 0;
+  /** @brief Requests started since the last flush. */
+  std::vector<request_base *> submitted_;
+  /** @brief The number of requests waiting for a response. */
+  std::atomic<std::size_t> in_flight_{0};
+  /** @brief Mutex for thread-safety. */
+  std::mutex mtx_;
+};
+
+} // namespace net::service
+
+#include "impl/tcp_multiplexer_impl.hpp" // IWYU pragma: export
+#endif                                   // CPPNET_TCP_MULTIPLEXER_HPP
@@ -0,0 +1,181 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/**
+ * @file tcp_proxy_service.hpp
+ * @brief This file declares a layer 4 TCP proxy service.
+ */
+#pragma once
+#ifndef CPPNET_TCP_PROXY_SERVICE_HPP
+#define CPPNET_TCP_PROXY_SERVICE_HPP
+#include "async_tcp_service.hpp"
+#include "net/detail/immovable.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+namespace net::service {
+/**
+ * @brief A layer 4 TCP proxy that forwards every accepted connection to an
+ * upstream server.
+ * @details Each accepted connection is paired with a new connection to
+ * the upstream address. Bytes are moved between the two sockets in kernel
+ * space with `splice(2)` through a pipe for each direction, so they are
+ * never copied to user space while the destination socket keeps up.
+ *
+ * A direction only reads from its source socket once the bytes that were
+ * previously read have been written to its destination socket, so a slow
+ * receiver applies backpressure all the way to the sender. If the
+ * destination socket is full, the bytes held in the pipe are written with
+ * an asynchronous send that waits for the socket to become writable.
+ *
+ * When one side shuts down its write direction, the proxy shuts down the
+ * write direction of the other side once the pipe is drained, and keeps
+ * forwarding in the opposite direction. An error on either socket resets
+ * both directions. If the upstream connection fails, the accepted
+ * connection is reset and the failure is counted in `connect_failures()`.
+ * @code
+ * auto proxy = basic_context_thread<tcp_proxy_service>();
+ * proxy.start(listen_address, upstream_address);
+ * @endcode
+ */
+class tcp_proxy_service : public async_tcp_service<tcp_proxy_service, 0> {
+public:
+  /** @brief Base class type. */
+  using Base = async_tcp_service<tcp_proxy_service, 0>;
+  /** @brief The maximum number of bytes moved by one splice. */
+  static constexpr std::size_t splice_size = 64UL * 1024;
+
+  /**
+   * @brief Constructs a proxy service.
+   * @tparam T The listening socket address type.
+   * @tparam U The upstream socket address type.
+   * @param address The address to accept connections on.
+   * @param upstream The address to forward connections to.
+   */
+  template <typename T, typename U>
+  tcp_proxy_service(socket_address<T> address,
+                    socket_address<U> upstream) noexcept;
+
+  /**
+   * @brief Connects each accepted connection to the upstream server.
+   * @param ctx The async context.
+   * @param socket The accepted connection.
+   * @param rctx The read context of the connection.
+   * @param buf Unused. The proxy does not read into user space.
+   */
+  auto service(async_context &ctx, const socket_dialog &socket,
+               std::shared_ptr<read_context> rctx,
+               std::span<const std::byte> buf) -> void;
+
+  /** @brief Stops reading from every proxied connection. */
+  auto stop() -> void;
+
+  /**
+   * @brief The number of upstream connections that failed.
+   * @details This method is thread-safe.
+   */
+  [[nodiscard]] auto connect_failures() const noexcept -> std::uint64_t;
+
+private:
+  /** @brief The slot of a pump that isn't in `pumps_`. */
+  static constexpr auto detached = std::numeric_limits<std::size_t>::max();
+  /** @brief Moves bytes in one direction through a pipe. */
+  struct pump : net::detail::immovable {
+    /**
+     * @brief Constructs a pump.
+     * @param from The socket to read from.
+     * @param to The socket to write to.
+     */
+    pump(socket_dialog from, socket_dialog to) noexcept;
+    /** @brief Closes the pipe. */
+    ~pump();
+
+    /** @brief The socket to read from. */
+    socket_dialog from;
+    /** @brief The socket to write to. */
+    socket_dialog to;
+    /** @brief The read and write ends of the pipe. */
+    std::array<int, 2> pipe{-1, -1};
+    /** @brief The number of bytes held in the pipe. */
+    std::size_t buffered = 0;
+    /** @brief Bytes drained from the pipe while the destination is full. */
+    std::vector<std::byte> bounce;
+    /** @brief The buffer that the source socket is peeked into. */
+    std::array<std::byte, 1> peek_buffer{};
+    /** @brief The socket message the source socket is peeked into. */
+    io::socket::socket_message<> peek_msg{.buffers = peek_buffer};
+    /** @brief The index of the pump in `pumps_`, or `detached`. */
+    std::size_t slot = detached;
+  };
+
+  /**
+   * @brief Starts forwarding between a connection and its upstream.
+   * @param ctx The async context.
+   * @param client The accepted connection.
+   * @param upstream The connection to the upstream server.
+   */
+  auto forward_(async_context &ctx, const socket_dialog &client,
+                const socket_dialog &upstream) -> void;
+  /**
+   * @brief Waits for the source socket of a pump to become readable.
+   * @param ctx The async context.
+   * @param p The pump.
+   */
+  auto poll_(async_context &ctx, std::shared_ptr<pump> p) -> void;
+  /**
+   * @brief Splices readable bytes from the source socket to the
+   * destination socket.
+   * @param ctx The async context.
+   * @param p The pump.
+   */
+  auto splice_(async_context &ctx, const std::shared_ptr<pump> &p) -> void;
+  /**
+   * @brief Sends the bounce buffer from offset to the destination socket.
+   * @param ctx The async context.
+   * @param p The pump.
+   * @param offset The number of bounced bytes already sent.
+   */
+  auto bounce_(async_context &ctx, std::shared_ptr<pump> p,
+               std::size_t offset) -> void;
+  /**
+   * @brief Shuts down the write direction of the destination socket.
+   * @param p The pump.
+   */
+  auto half_close_(pump &p) noexcept -> void;
+  /**
+   * @brief Shuts down both sockets of a pump in both directions.
+   * @param p The pump.
+   */
+  auto reset_(pump &p) noexcept -> void;
+  /**
+   * @brief Removes a finished pump from `pumps_`.
+   * @param p The pump.
+   */
+  auto finish_(pump &p) noexcept -> void;
+
+  /** @brief The upstream server address. */
+  socket_address<sockaddr_in6> upstream_;
+  /** @brief The pumps of the proxied connections. */
+  std::vector<std::weak_ptr<pump>> pumps_;
+  /** @brief The number of upstream connections that failed. */
+  std::atomic<std::uint64_t> connect_failures_{0};
+};
+
+} // namespace net::service
+
+#include "impl/tcp_proxy_service_impl.hpp" // IWYU pragma: export
+#endif                                     // CPPNET_TCP_PROXY_SERVICE_HPP
@@ -0,0 +1,155 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// NOLINTBEGIN
+/**
+ * @file test_alloc_tracker.hpp
+ * @brief Replaces the global allocation functions to count heap
+ * allocations per thread.
+ * @details The replacement operator new and operator delete are not
+ * inline, so this header must be included by exactly one translation
+ * unit of a test executable.
+ */
+#pragma once
+#ifndef CPPNET_TEST_ALLOC_TRACKER_HPP
+#define CPPNET_TEST_ALLOC_TRACKER_HPP
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+/** @brief Heap allocation counters. */
+struct alloc_counts {
+  /** @brief The number of calls to operator new. */
+  std::size_t allocations = 0;
+  /** @brief The number of calls to operator delete. */
+  std::size_t deallocations = 0;
+  /** @brief The number of bytes requested from operator new. */
+  std::size_t bytes = 0;
+};
+
+/** @brief The allocation counters of the calling thread. */
+inline constinit thread_local alloc_counts thread_alloc_counts{};
+
+/**
+ * @brief Counts the allocations made by the calling thread while it is
+ * in scope.
+ * @details Allocations made on other threads are not counted, so an
+ * event loop that is driven from the test thread can be measured while
+ * helper threads keep running.
+ */
+class alloc_tracker {
+public:
+  /** @brief Starts counting from now. */
+  alloc_tracker() noexcept : start_{thread_alloc_counts} {}
+
+  /** @brief The number of allocations since the tracker started. */
+  [[nodiscard]] auto allocations() const noexcept -> std::size_t
+  {
+    return thread_alloc_counts.allocations - start_.allocations;
+  }
+
+  /** @brief The number of deallocations since the tracker started. */
+  [[nodiscard]] auto deallocations() const noexcept -> std::size_t
+  {
+    return thread_alloc_counts.deallocations - start_.deallocations;
+  }
+
+  /** @brief The number of bytes allocated since the tracker started. */
+  [[nodiscard]] auto bytes() const noexcept -> std::size_t
+  {
+    return thread_alloc_counts.bytes - start_.bytes;
+  }
+
+  /** @brief Restarts counting from now. */
+  auto reset() noexcept -> void { start_ = thread_alloc_counts; }
+
+private:
+  alloc_counts start_;
+};
+
+/** @brief Counts and performs an allocation. */
+static auto tracked_allocate(std::size_t size, std::size_t align) -> void *
+{
+  ++thread_alloc_counts.allocations;
+  thread_alloc_counts.bytes += size;
+
+  size = size ? size : 1;
+  void *ptr = nullptr;
+  if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+    ptr = std::aligned_alloc(align, (size + align - 1) / align * align);
+  else
+    ptr = std::malloc(size);
+
+  if (!ptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+/** @brief Counts and performs a deallocation. */
+static auto tracked_deallocate(void *ptr) noexcept -> void
+{
+  if (!ptr)
+    return;
+
+  ++thread_alloc_counts.deallocations;
+  std::free(ptr);
+}
+
+// The default nothrow forms forward to these replacements.
+auto operator new(std::size_t size) -> void *
+{
+  return tracked_allocate(size, 0);
+}
+auto operator new[](std::size_t size) -> void *
+{
+  return tracked_allocate(size, 0);
+}
+auto operator new(std::size_t size, std::align_val_t align) -> void *
+{
+  return tracked_allocate(size, static_cast<std::size_t>(align));
+}
+auto operator new[](std::size_t size, std::align_val_t align) -> void *
+{
+  return tracked_allocate(size, static_cast<std::size_t>(align));
+}
+
+auto operator delete(void *ptr) noexcept -> void { tracked_deallocate(ptr); }
+auto operator delete[](void *ptr) noexcept -> void { tracked_deallocate(ptr); }
+auto operator delete(void *ptr, std::size_t) noexcept -> void
+{
+  tracked_deallocate(ptr);
+}
+auto operator delete[](void *ptr, std::size_t) noexcept -> void
+{
+  tracked_deallocate(ptr);
+}
+auto operator delete(void *ptr, std::align_val_t) noexcept -> void
+{
+  tracked_deallocate(ptr);
+}
+auto operator delete[](void *ptr, std::align_val_t) noexcept -> void
+{
+  tracked_deallocate(ptr);
+}
+auto operator delete(void *ptr, std::size_t, std::align_val_t) noexcept
+    -> void
+{
+  tracked_deallocate(ptr);
+}
+auto operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept
+    -> void
+{
+  tracked_deallocate(ptr);
+}
+#endif // CPPNET_TEST_ALLOC_TRACKER_HPP
+// NOLINTEND
@@ -0,0 +1,176 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// NOLINTBEGIN
+#include "test_alloc_tracker.hpp"
+#include "test_tcp_fixture.hpp"
+#include "test_udp_fixture.hpp"
+
+#include <chrono>
+#include <span>
+#include <vector>
+
+// Allocation budgets for one event on each hot path. The service paths
+// are ceilings: lower them when an allocation is removed. Every path
+// must also allocate the same amount on every steady state iteration.
+static constexpr auto ACCEPT_BUDGET = 16UL;
+static constexpr auto ECHO_BUDGET = 8UL;
+static constexpr auto DATAGRAM_BUDGET = 8UL;
+// The only allocation is the scratch vector of expired timers.
+static constexpr auto TIMER_FIRE_ALLOCATIONS = 1UL;
+
+static constexpr auto WARMUP = 8UL;
+static constexpr auto ROUNDS = 32UL;
+
+/** @brief Checks that every measured round allocated the same amount. */
+static auto expect_steady(const std::vector<std::size_t> &rounds,
+                          std::size_t budget) -> void
+{
+  ASSERT_EQ(rounds.size(), WARMUP + ROUNDS);
+  const auto steady = rounds.back();
+  for (auto count : std::span(rounds).subspan(WARMUP))
+    EXPECT_EQ(count, steady);
+  EXPECT_LE(steady, budget);
+}
+
+TEST(AllocTrackerTest, CountTest)
+{
+  auto tracker = alloc_tracker();
+  auto *ptr = new int(1);
+  auto *array = new int[4];
+  EXPECT_EQ(tracker.allocations(), 2);
+  EXPECT_GE(tracker.bytes(), sizeof(int) * 5);
+  EXPECT_EQ(tracker.deallocations(), 0);
+
+  delete ptr;
+  delete[] array;
+  EXPECT_EQ(tracker.deallocations(), 2);
+
+  tracker.reset();
+  EXPECT_EQ(tracker.allocations(), 0);
+  EXPECT_EQ(tracker.deallocations(), 0);
+}
+
+TEST(AllocTrackerTest, ThreadTest)
+{
+  auto tracker = alloc_tracker();
+  std::thread([] { delete new int(1); }).join();
+  // Starting the thread allocates its state on this thread only.
+  const auto allocations = tracker.allocations();
+
+  std::thread([] {
+    for (int i = 0; i < 16; ++i)
+      delete new int(i);
+  }).join();
+  EXPECT_EQ(tracker.allocations(), allocations * 2);
+}
+
+TEST_F(AsyncTcpServiceTest, AcceptAllocations)
+{
+  using namespace io::socket;
+  service_v4->start(*ctx);
+
+  auto rounds = std::vector<std::size_t>();
+  rounds.reserve(WARMUP + ROUNDS);
+  for (auto i = 0UL; i < WARMUP + ROUNDS; ++i)
+  {
+    {
+      auto sock = socket_handle(AF_INET, SOCK_STREAM, 0);
+      ASSERT_EQ(io::connect(sock, addr_v4), 0);
+
+      auto tracker = alloc_tracker();
+      auto n = ctx->poller.wait_for(2000);
+      rounds.push_back(tracker.allocations());
+      ASSERT_GT(n, 0);
+    }
+    // Let the service release the closed connection.
+    ctx->poller.wait_for(50);
+  }
+  expect_steady(rounds, ACCEPT_BUDGET);
+}
+
+TEST_F(AsyncTcpServiceTest, EchoAllocations)
+{
+  using namespace io::socket;
+  service_v4->start(*ctx);
+
+  auto sock = socket_handle(AF_INET, SOCK_STREAM, 0);
+  ASSERT_EQ(io::connect(sock, addr_v4), 0);
+  ASSERT_GT(ctx->poller.wait_for(2000), 0);
+
+  auto buf = std::array<char, 1>{'x'};
+  auto msg = socket_message{.buffers = buf};
+  auto rounds = std::vector<std::size_t>();
+  rounds.reserve(WARMUP + ROUNDS);
+  for (auto i = 0UL; i < WARMUP + ROUNDS; ++i)
+  {
+    ASSERT_EQ(io::sendmsg(sock, msg, 0), 1);
+
+    auto tracker = alloc_tracker();
+    auto n = ctx->poller.wait_for(50);
+    rounds.push_back(tracker.allocations());
+    ASSERT_GT(n, 0);
+    ASSERT_EQ(io::recvmsg(sock, msg, 0), 1);
+  }
+  expect_steady(rounds, ECHO_BUDGET);
+}
+
+TEST_F(AsyncUDPServiceTest, DatagramAllocations)
+{
+  using namespace io::socket;
+  service_v4->start(*ctx);
+
+  auto sock = socket_handle(AF_INET, SOCK_DGRAM, 0);
+  auto buf = std::array<char, 1>{'x'};
+  auto request = socket_message<sockaddr_in>{.address = {addr_v4},
+                                             .buffers = buf};
+  auto reply = socket_message{.buffers = buf};
+  auto rounds = std::vector<std::size_t>();
+  rounds.reserve(WARMUP + ROUNDS);
+  for (auto i = 0UL; i < WARMUP + ROUNDS; ++i)
+  {
+    ASSERT_EQ(io::sendmsg(sock, request, 0), 1);
+
+    auto tracker = alloc_tracker();
+    auto n = ctx->poller.wait_for(50);
+    rounds.push_back(tracker.allocations());
+    ASSERT_GT(n, 0);
+    ASSERT_EQ(io::recvmsg(sock, reply, 0), 1);
+  }
+  expect_steady(rounds, DATAGRAM_BUDGET);
+}
+
+TEST(TimerAllocationTest, TimerFireAllocations)
+{
+  using namespace net::timers;
+  auto timers = net::timers::timers<socketpair_interrupt_source_t>();
+
+  // A periodic timer that starts in the past fires on every resolve.
+  auto fired = 0UL;
+  timers.add(clock::now() - std::chrono::hours(1),
+             [&](timer_id) { ++fired; }, duration(1));
+
+  auto rounds = std::vector<std::size_t>();
+  rounds.reserve(WARMUP + ROUNDS);
+  for (auto i = 0UL; i < WARMUP + ROUNDS; ++i)
+  {
+    auto tracker = alloc_tracker();
+    timers.resolve();
+    rounds.push_back(tracker.allocations());
+  }
+  EXPECT_EQ(fired, WARMUP + ROUNDS);
+  expect_steady(rounds, TIMER_FIRE_ALLOCATIONS);
+  EXPECT_EQ(rounds.back(), TIMER_FIRE_ALLOCATIONS);
+}
+// NOLINTEND
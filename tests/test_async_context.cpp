@@ -19,6 +19,7 @@
 
 #include <condition_variable>
 #include <mutex>
+#include <vector>
 
 using namespace net::service;
 
@@ -39,6 +40,26 @@ TEST_F(AsyncContextTest, SignalTest)
   EXPECT_EQ(len, 1);
 }
 
+TEST_F(AsyncContextTest, DeferTest)
+{
+  auto ctx = async_context{};
+  auto order = std::vector<int>{};
+
+  EXPECT_FALSE(ctx.run_deferred());
+  ctx.defer([&] {
+    order.push_back(1);
+    // Routines deferred while running are deferred to the next run.
+    ctx.defer([&] { order.push_back(3); });
+  });
+  ctx.defer([&] { order.push_back(2); });
+
+  EXPECT_TRUE(ctx.run_deferred());
+  EXPECT_EQ(order, (std::vector<int>{1, 2}));
+  EXPECT_TRUE(ctx.run_deferred());
+  EXPECT_EQ(order, (std::vector<int>{1, 2, 3}));
+  EXPECT_FALSE(ctx.run_deferred());
+}
+
 std::mutex test_mtx;
 std::condition_variable test_cv;
 static int test_signal = 0;
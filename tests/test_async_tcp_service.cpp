@@ -13,10 +13,53 @@
 // limitations under the License.
 
 // NOLINTBEGIN
+#include "net/service/rebalancer.hpp"
 #include "test_tcp_fixture.hpp"
 #include <atomic>
+#include <cstring>
+#include <optional>
+#include <set>
+#include <thread>
 using namespace net::service;
 
+struct tcp_arena_service : public async_tcp_service<tcp_arena_service, 0> {
+  using Base = async_tcp_service<tcp_arena_service, 0>;
+
+  template <typename T>
+  explicit tcp_arena_service(socket_address<T> address) : Base(address)
+  {}
+
+  std::array<std::byte, 64> arena{};
+  std::size_t offset = 0;
+  bool in_arena = true;
+  std::error_code error;
+  std::optional<socket_dialog> parked;
+  std::shared_ptr<read_context> parked_rctx;
+
+  auto service(async_context &ctx, const socket_dialog &socket,
+               std::shared_ptr<read_context> rctx,
+               std::span<const std::byte> buf) -> void
+  {
+    if (!rctx)
+      return;
+
+    if (!buf.empty())
+    {
+      in_arena = in_arena && buf.data() == arena.data() + offset;
+      offset += buf.size();
+    }
+
+    // Keep the connection while the arena is full.
+    parked_rctx = rctx;
+    error = submit_recv(ctx, socket, std::move(rctx),
+                        std::span(arena).subspan(offset));
+    if (error)
+      parked = socket;
+    else
+      parked_rctx.reset();
+  }
+};
+
 TEST_F(AsyncTcpServiceTest, StartTest)
 {
   service_v4->start(*ctx);
@@ -86,6 +129,636 @@ TEST_F(AsyncTcpServiceTest, EchoTest)
   ASSERT_GT(n, 0);
 }
 
+TEST_F(AsyncTcpServiceTest, HandlerOwnedBufferTest)
+{
+  using namespace io;
+  using namespace io::socket;
+
+  const char *alphabet = "abcdefghijklmnopqrstuvwxyz";
+  auto service = tcp_arena_service(addr_v4);
+  ASSERT_FALSE(service.start(*ctx));
+
+  {
+    auto sock = socket_handle(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(io::connect(sock, addr_v4), 0);
+    auto n = ctx->poller.wait_for(2000);
+    ASSERT_GT(n, 0);
+
+    auto *end = alphabet + 26;
+    for (auto *it = alphabet; it != end; ++it)
+    {
+      auto msg = socket_message<sockaddr_in>{.buffers = std::span(it, 1)};
+      auto len = sendmsg(sock, msg, 0);
+      ASSERT_EQ(len, 1);
+
+      n = ctx->poller.wait_for(50);
+      ASSERT_GT(n, 0);
+    }
+  }
+
+  EXPECT_EQ(service.offset, 26);
+  EXPECT_TRUE(service.in_arena);
+  EXPECT_EQ(std::memcmp(service.arena.data(), alphabet, 26), 0);
+
+  service.signal_handler(ctx->terminate);
+  auto n = 0UL;
+  while (ctx->poller.wait_for(50))
+  {
+    ASSERT_LE(n++, 4);
+  }
+}
+
+TEST_F(AsyncTcpServiceTest, FullBufferTest)
+{
+  using namespace io;
+  using namespace io::socket;
+
+  auto service = tcp_arena_service(addr_v4);
+  service.offset = service.arena.size() - 3;
+  ASSERT_FALSE(service.start(*ctx));
+
+  auto sock = socket_handle(AF_INET, SOCK_STREAM, 0);
+  ASSERT_EQ(io::connect(sock, addr_v4), 0);
+  ASSERT_GT(ctx->poller.wait_for(2000), 0);
+
+  auto text = std::string_view("abc");
+  auto msg = socket_message{.buffers = std::span(text.data(), text.size())};
+  ASSERT_EQ(sendmsg(sock, msg, 0), 3);
+  while (ctx->poller.wait_for(50));
+
+  // A full arena is rejected instead of reading as end of stream.
+  EXPECT_EQ(service.error, std::errc::no_buffer_space);
+  ASSERT_TRUE(service.parked);
+  auto buf = std::array<char, 1>();
+  auto reply = socket_message{.buffers = buf};
+  EXPECT_EQ(recvmsg(sock, reply, MSG_DONTWAIT), -1);
+
+  // The connection can be resumed once there is room again.
+  service.offset = 0;
+  EXPECT_FALSE(service.submit_recv(*ctx, *service.parked,
+                                   std::move(service.parked_rctx),
+                                   std::span(service.arena)));
+  text = "d";
+  msg = socket_message{.buffers = std::span(text.data(), text.size())};
+  ASSERT_EQ(sendmsg(sock, msg, 0), 1);
+  while (ctx->poller.wait_for(50));
+  EXPECT_EQ(service.arena[0], std::byte{'d'});
+  EXPECT_EQ(service.offset, 1);
+
+  service.parked.reset();
+  service.signal_handler(ctx->terminate);
+  while (ctx->poller.wait_for(50));
+}
+
+struct tcp_ring_service : public async_tcp_service<tcp_ring_service> {
+  using Base = async_tcp_service<tcp_ring_service>;
+  using socket_message = io::socket::socket_message<>;
+
+  static constexpr std::size_t accept_batch = 8;
+  static constexpr std::size_t provided_buffers = 2;
+
+  template <typename T>
+  explicit tcp_ring_service(socket_address<T> address) : Base(address)
+  {}
+
+  std::size_t accepted = 0;
+  std::set<const read_context *> ring;
+  std::size_t ring_reads = 0;
+
+  auto service(async_context &ctx, const socket_dialog &socket,
+               std::shared_ptr<read_context> rctx,
+               std::span<const std::byte> buf) -> void
+  {
+    using namespace stdexec;
+    if (!rctx)
+      return;
+
+    // Every connection is accepted with a read context from the ring.
+    if (buf.empty())
+    {
+      accepted++;
+      ring.insert(rctx.get());
+      return submit_recv(ctx, socket, std::move(rctx));
+    }
+
+    if (ring.contains(rctx.get()))
+      ring_reads++;
+
+    sender auto sendmsg =
+        io::sendmsg(socket, socket_message{.buffers = buf}, 0) |
+        then([&, socket, rctx](auto &&len) { submit_recv(ctx, socket, rctx); }) |
+        upon_error([](auto &&error) {});
+
+    ctx.scope.spawn(std::move(sendmsg));
+  }
+};
+
+TEST_F(AsyncTcpServiceTest, ProvidedBuffersTest)
+{
+  using namespace io;
+  using namespace io::socket;
+
+  auto service = tcp_ring_service(addr_v4);
+  ASSERT_FALSE(service.start(*ctx));
+
+  {
+    constexpr auto NUM_CLIENTS = 4;
+    auto clients = std::vector<socket_handle>();
+    for (int i = 0; i < NUM_CLIENTS; ++i)
+    {
+      auto &sock = clients.emplace_back(AF_INET, SOCK_STREAM, 0);
+      ASSERT_EQ(io::connect(sock, addr_v4), 0);
+    }
+
+    // The queued connections are accepted on one readiness notification.
+    ASSERT_GT(ctx->poller.wait_for(2000), 0);
+    EXPECT_EQ(service.accepted, NUM_CLIENTS);
+    while (service.accepted < NUM_CLIENTS)
+      ASSERT_GT(ctx->poller.wait_for(2000), 0);
+    EXPECT_EQ(service.ring.size(), tcp_ring_service::provided_buffers);
+
+    auto buf = std::array<char, 1>{};
+    auto msg = socket_message{.buffers = buf};
+
+    const char *alphabet = "abcdefghijklmnopqrstuvwxyz";
+    auto *end = alphabet + 26;
+    for (auto *it = alphabet; it != end; ++it)
+    {
+      auto msg_ = socket_message<sockaddr_in>{.buffers = std::span(it, 1)};
+      for (auto &sock : clients)
+        ASSERT_EQ(sendmsg(sock, msg_, 0), 1);
+
+      for (auto &sock : clients)
+      {
+        while (recvmsg(sock, msg, MSG_DONTWAIT) != 1)
+          ASSERT_GT(ctx->poller.wait_for(50), 0);
+        EXPECT_EQ(buf[0], *it);
+      }
+    }
+  }
+
+  // A ring read context serves one read at a time, so more reads than
+  // ring entries means that read contexts were returned and reused.
+  EXPECT_GT(service.ring_reads, tcp_ring_service::provided_buffers);
+
+  service.signal_handler(ctx->terminate);
+  auto n = 0UL;
+  while (ctx->poller.wait_for(50))
+  {
+    ASSERT_LE(n++, 8);
+  }
+}
+
+TEST_F(AsyncTcpServiceTest, RebalanceTest)
+{
+  using namespace io;
+  using namespace io::socket;
+
+  auto target_ctx = async_context();
+  auto target = tcp_echo_service(addr_v6);
+  auto balancer = rebalancer<tcp_echo_service>();
+  balancer.add(*ctx, *service_v4);
+  EXPECT_FALSE(balancer.rebalance());
+  balancer.add(target_ctx, target);
+
+  service_v4->start(*ctx);
+  {
+    auto sock = socket_handle(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(io::connect(sock, addr_v4), 0);
+    ASSERT_GT(ctx->poller.wait_for(2000), 0);
+
+    auto buf = std::array<char, 1>{};
+    auto msg = socket_message{.buffers = buf};
+    auto echo = [&](const char *chr, auto &poller) {
+      auto msg_ = socket_message<sockaddr_in>{.buffers = std::span(chr, 1)};
+      ASSERT_EQ(sendmsg(sock, msg_, 0), 1);
+      while (recvmsg(sock, msg, MSG_DONTWAIT) != 1)
+        ASSERT_GT(poller.wait_for(50), 0);
+      EXPECT_EQ(buf[0], *chr);
+    };
+
+    echo("a", ctx->poller);
+    EXPECT_EQ(service_v4->reads(), 1);
+    EXPECT_TRUE(balancer.rebalance());
+
+    // The next re-armed read on ctx migrates to target_ctx.
+    echo("b", ctx->poller);
+    while (ctx->poller.wait_for(50));
+    target_ctx.timers.resolve();
+
+    echo("c", target_ctx.poller);
+    EXPECT_EQ(service_v4->reads(), 2);
+    EXPECT_EQ(target.reads(), 1);
+    EXPECT_FALSE(balancer.rebalance());
+  }
+
+  auto n = 0UL;
+  while (target_ctx.poller.wait_for(50))
+  {
+    ASSERT_LE(n++, 4);
+  }
+
+  ctx->signal(ctx->terminate);
+  n = 0UL;
+  while (ctx->poller.wait_for(50))
+  {
+    ASSERT_LE(n++, 4);
+  }
+}
+
+struct tcp_fanout_service : public async_tcp_service<tcp_fanout_service> {
+  using Base = async_tcp_service<tcp_fanout_service>;
+
+  template <typename T>
+  explicit tcp_fanout_service(socket_address<T> address) : Base(address)
+  {}
+
+  std::vector<socket_dialog> connections;
+  int sndbuf = 0;
+
+  auto service(async_context &ctx, const socket_dialog &socket,
+               std::shared_ptr<read_context> rctx,
+               std::span<const std::byte> buf) -> void
+  {
+    using namespace io::socket;
+    if (!rctx)
+      return;
+
+    if (sndbuf)
+    {
+      const auto sockfd = static_cast<native_socket_type>(*socket.socket);
+      ::setsockopt(sockfd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+    }
+    connections.push_back(socket);
+    submit_recv(ctx, socket, std::move(rctx));
+  }
+};
+
+TEST_F(AsyncTcpServiceTest, BroadcastTest)
+{
+  using namespace io;
+  using namespace io::socket;
+
+  auto service = tcp_fanout_service(addr_v4);
+  ASSERT_FALSE(service.start(*ctx));
+
+  {
+    constexpr auto NUM_CLIENTS = 3;
+    auto clients = std::vector<socket_handle>();
+    for (int i = 0; i < NUM_CLIENTS; ++i)
+    {
+      auto &sock = clients.emplace_back(AF_INET, SOCK_STREAM, 0);
+      ASSERT_EQ(io::connect(sock, addr_v4), 0);
+    }
+
+    while (service.connections.size() < NUM_CLIENTS)
+      ASSERT_GT(ctx->poller.wait_for(2000), 0);
+
+    auto message = net::service::shared_buffer("Hello, world!");
+    service.broadcast(*ctx, service.connections, message);
+    while (ctx->poller.wait_for(50));
+    EXPECT_EQ(message.use_count(), 1);
+
+    auto buf = std::array<char, 13>{};
+    auto msg = socket_message{.buffers = buf};
+    for (auto &sock : clients)
+    {
+      ASSERT_EQ(recvmsg(sock, msg, 0), 13);
+      EXPECT_EQ(std::string_view(buf.data(), buf.size()), "Hello, world!");
+    }
+    service.connections.clear();
+  }
+
+  service.signal_handler(ctx->terminate);
+  auto n = 0UL;
+  while (ctx->poller.wait_for(50))
+  {
+    ASSERT_LE(n++, 8);
+  }
+}
+
+TEST_F(AsyncTcpServiceTest, OrderedBroadcastTest)
+{
+  using namespace io;
+  using namespace io::socket;
+  using namespace std::chrono;
+
+  auto service = tcp_fanout_service(addr_v4);
+  service.sndbuf = 4096;
+  ASSERT_FALSE(service.start(*ctx));
+
+  {
+    auto sock = socket_handle(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(io::connect(sock, addr_v4), 0);
+    while (service.connections.empty())
+      ASSERT_GT(ctx->poller.wait_for(2000), 0);
+
+    // Each message is far larger than the send buffer, so every one of
+    // them is written in several parts.
+    constexpr auto NUM_MESSAGES = 4;
+    constexpr auto MESSAGE_SIZE = 256 * 1024UL;
+    auto expected = std::string();
+    for (int i = 0; i < NUM_MESSAGES; ++i)
+    {
+      auto message = std::string(MESSAGE_SIZE, static_cast<char>('a' + i));
+      expected += message;
+      service.broadcast(*ctx, service.connections, shared_buffer(message));
+    }
+
+    auto received = std::string();
+    auto buf = std::array<char, 64 * 1024>{};
+    const auto deadline = steady_clock::now() + seconds(10);
+    while (received.size() < expected.size() &&
+           steady_clock::now() < deadline)
+    {
+      ctx->poller.wait_for(1);
+      auto msg = socket_message{.buffers = buf};
+      auto len = recvmsg(sock, msg, MSG_DONTWAIT);
+      if (len > 0)
+        received.append(buf.data(), static_cast<std::size_t>(len));
+    }
+
+    ASSERT_EQ(received.size(), expected.size());
+    EXPECT_TRUE(received == expected);
+    service.connections.clear();
+  }
+
+  service.signal_handler(ctx->terminate);
+  while (ctx->poller.wait_for(50));
+}
+
+struct tcp_paced_service : public async_tcp_service<tcp_paced_service> {
+  using Base = async_tcp_service<tcp_paced_service>;
+
+  template <typename T>
+  explicit tcp_paced_service(socket_address<T> address) : Base(address)
+  {}
+
+  // One 13 byte message per connection every 13ms.
+  pacer pacing{1000, 13};
+  std::vector<socket_dialog> connections;
+
+  auto service(async_context &ctx, const socket_dialog &socket,
+               std::shared_ptr<read_context> rctx,
+               std::span<const std::byte> buf) -> void
+  {
+    if (!rctx)
+      return;
+
+    connections.push_back(socket);
+    submit_recv(ctx, socket, std::move(rctx));
+  }
+};
+
+TEST_F(AsyncTcpServiceTest, PacedBroadcastTest)
+{
+  using namespace io;
+  using namespace io::socket;
+
+  auto service = tcp_paced_service(addr_v4);
+  ASSERT_FALSE(service.start(*ctx));
+
+  {
+    constexpr auto NUM_CLIENTS = 2;
+    auto clients = std::vector<socket_handle>();
+    for (int i = 0; i < NUM_CLIENTS; ++i)
+    {
+      auto &sock = clients.emplace_back(AF_INET, SOCK_STREAM, 0);
+      ASSERT_EQ(io::connect(sock, addr_v4), 0);
+    }
+
+    while (service.connections.size() < NUM_CLIENTS)
+      ASSERT_GT(ctx->poller.wait_for(2000), 0);
+
+    auto message = net::service::shared_buffer("Hello, world!");
+    service.broadcast(*ctx, service.connections, message);
+    service.broadcast(*ctx, service.connections, message);
+    while (ctx->poller.wait_for(50));
+
+    // Each connection gets its burst, and the second message waits.
+    EXPECT_EQ(service.pacing.pending(), NUM_CLIENTS);
+    auto buf = std::array<char, 26>{};
+    auto msg = socket_message{.buffers = buf};
+    for (auto &sock : clients)
+      ASSERT_EQ(recvmsg(sock, msg, 0), 13);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ctx->timers.resolve();
+    while (ctx->poller.wait_for(50));
+    EXPECT_EQ(service.pacing.pending(), 0);
+    EXPECT_EQ(message.use_count(), 1);
+    for (auto &sock : clients)
+      EXPECT_EQ(recvmsg(sock, msg, 0), 13);
+    service.connections.clear();
+  }
+
+  service.signal_handler(ctx->terminate);
+  auto n = 0UL;
+  while (ctx->poller.wait_for(50))
+  {
+    ASSERT_LE(n++, 8);
+  }
+}
+
+TEST_F(AsyncTcpServiceTest, PacedCloseTest)
+{
+  using namespace io;
+  using namespace io::socket;
+
+  auto service = tcp_paced_service(addr_v4);
+  ASSERT_FALSE(service.start(*ctx));
+
+  auto message = net::service::shared_buffer("Hello, world!");
+  {
+    auto sock = socket_handle(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(io::connect(sock, addr_v4), 0);
+    while (service.connections.empty())
+      ASSERT_GT(ctx->poller.wait_for(2000), 0);
+
+    service.broadcast(*ctx, service.connections, message);
+    service.broadcast(*ctx, service.connections, message);
+    while (ctx->poller.wait_for(50));
+    EXPECT_EQ(service.pacing.pending(), 1);
+    EXPECT_EQ(service.pacing.flows(), 1);
+  }
+
+  // Closing the connection drops its flow and the send still queued on
+  // it, so a connection that reuses the descriptor starts afresh.
+  while (service.pacing.flows())
+    ASSERT_GT(ctx->poller.wait_for(2000), 0);
+  EXPECT_EQ(service.pacing.pending(), 0);
+  service.connections.clear();
+  EXPECT_EQ(message.use_count(), 1);
+
+  service.signal_handler(ctx->terminate);
+  auto n = 0UL;
+  while (ctx->poller.wait_for(50))
+  {
+    ASSERT_LE(n++, 8);
+  }
+}
+
+struct tcp_batch_service : public async_tcp_service<tcp_batch_service> {
+  using Base = async_tcp_service<tcp_batch_service>;
+  using socket_message = io::socket::socket_message<>;
+
+  template <typename T>
+  explicit tcp_batch_service(socket_address<T> address) : Base(address)
+  {}
+
+  std::size_t accepted = 0;
+  std::size_t largest_batch = 0;
+
+  auto service_batch(async_context &ctx, std::span<read_event> events) -> void
+  {
+    using namespace stdexec;
+    largest_batch = std::max(largest_batch, events.size());
+
+    for (auto &[socket, rctx, buf] : events)
+    {
+      if (!rctx)
+        continue;
+
+      if (buf.empty())
+      {
+        accepted++;
+        submit_recv(ctx, socket, std::move(rctx));
+        continue;
+      }
+
+      sender auto sendmsg =
+          io::sendmsg(socket, socket_message{.buffers = buf}, 0) |
+          then([&, socket, rctx](auto &&len) {
+            submit_recv(ctx, socket, rctx);
+          }) |
+          upon_error([](auto &&error) {});
+
+      ctx.scope.spawn(std::move(sendmsg));
+    }
+  }
+};
+
+TEST_F(AsyncTcpServiceTest, BatchTest)
+{
+  using namespace io;
+  using namespace io::socket;
+
+  auto service = tcp_batch_service(addr_v4);
+  ASSERT_FALSE(service.start(*ctx));
+
+  {
+    auto clients = std::array{socket_handle(AF_INET, SOCK_STREAM, 0),
+                              socket_handle(AF_INET, SOCK_STREAM, 0)};
+    for (auto &sock : clients)
+      ASSERT_EQ(io::connect(sock, addr_v4), 0);
+
+    while (service.accepted < clients.size())
+    {
+      ASSERT_GT(ctx->poller.wait_for(2000), 0);
+      ctx->run_deferred();
+    }
+
+    // Both reads complete in the same loop iteration.
+    const char *chr = "a";
+    auto msg_ = socket_message<sockaddr_in>{.buffers = std::span(chr, 1)};
+    for (auto &sock : clients)
+      ASSERT_EQ(sendmsg(sock, msg_, 0), 1);
+
+    ASSERT_GT(ctx->poller.wait_for(2000), 0);
+    EXPECT_TRUE(ctx->run_deferred());
+    EXPECT_EQ(service.largest_batch, 2);
+
+    auto buf = std::array<char, 1>{};
+    auto msg = socket_message{.buffers = buf};
+    for (auto &sock : clients)
+    {
+      while (recvmsg(sock, msg, MSG_DONTWAIT) != 1)
+        ASSERT_GT(ctx->poller.wait_for(50), 0);
+      EXPECT_EQ(buf[0], 'a');
+    }
+  }
+
+  service.signal_handler(ctx->terminate);
+  auto n = 0UL;
+  while (ctx->poller.wait_for(50) || ctx->run_deferred())
+  {
+    ASSERT_LE(n++, 8);
+  }
+}
+
+struct tcp_timed_service : public async_tcp_service<tcp_timed_service> {
+  using Base = async_tcp_service<tcp_timed_service>;
+  using socket_message = io::socket::socket_message<>;
+
+  template <typename T>
+  explicit tcp_timed_service(socket_address<T> address) : Base(address)
+  {}
+
+  request_lifecycle lifecycle{1};
+
+  auto service(async_context &ctx, const socket_dialog &socket,
+               std::shared_ptr<read_context> rctx,
+               std::span<const std::byte> buf) -> void
+  {
+    using namespace stdexec;
+    if (!rctx)
+      return;
+
+    if (buf.empty())
+      return submit_recv(ctx, socket, std::move(rctx));
+
+    lifecycle.submitted(rctx->stamps);
+    sender auto sendmsg =
+        io::sendmsg(socket, socket_message{.buffers = buf}, 0) |
+        then([&, socket, rctx](auto &&len) {
+          lifecycle.completed(rctx->stamps);
+          submit_recv(ctx, socket, rctx);
+        }) |
+        upon_error([](auto &&error) {});
+
+    ctx.scope.spawn(std::move(sendmsg));
+  }
+};
+
+TEST_F(AsyncTcpServiceTest, LifecycleTest)
+{
+  using namespace io;
+  using namespace io::socket;
+  using phase = request_lifecycle::phase;
+
+  auto service = tcp_timed_service(addr_v4);
+  ASSERT_FALSE(service.start(*ctx));
+
+  constexpr auto REQUESTS = 10;
+  {
+    auto sock = socket_handle(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(io::connect(sock, addr_v4), 0);
+    ASSERT_GT(ctx->poller.wait_for(2000), 0);
+
+    auto buf = std::array<char, 1>{'x'};
+    auto msg = socket_message{.buffers = buf};
+    for (int i = 0; i < REQUESTS; ++i)
+    {
+      ASSERT_EQ(sendmsg(sock, msg, 0), 1);
+      while (recvmsg(sock, msg, MSG_DONTWAIT) != 1)
+        ASSERT_GT(ctx->poller.wait_for(50), 0);
+    }
+  }
+
+  const auto &lifecycle = service.lifecycle;
+  EXPECT_EQ(lifecycle.histogram(phase::first_byte).count(), 1);
+  for (auto which : {phase::dispatch, phase::service, phase::submit})
+    EXPECT_EQ(lifecycle.histogram(which).count(), REQUESTS);
+
+  // The last send may complete after the last reply was read.
+  while (lifecycle.histogram(phase::total).count() < REQUESTS)
+    ASSERT_GT(ctx->poller.wait_for(50), 0);
+  EXPECT_EQ(lifecycle.histogram(phase::send).count(), REQUESTS);
+
+  service.signal_handler(ctx->terminate);
+  while (ctx->poller.wait_for(50));
+}
+
 TEST_F(AsyncTcpServiceTest, InitializeError)
 {
   using namespace io::socket;
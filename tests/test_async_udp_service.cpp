@@ -15,6 +15,12 @@
 // NOLINTBEGIN
 #include "test_udp_fixture.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#include <netinet/udp.h>
+
 TEST_F(AsyncUDPServiceTest, StartTest)
 {
   service_v4->start(*ctx);
@@ -82,6 +88,753 @@ TEST_F(AsyncUDPServiceTest, EchoTest)
   ASSERT_GT(n, 0);
 }
 
+struct udp_fanout_service : public async_udp_service<udp_fanout_service> {
+  using Base = async_udp_service<udp_fanout_service>;
+
+  template <typename T>
+  explicit udp_fanout_service(socket_address<T> address) : Base(address)
+  {}
+
+  std::vector<read_context::socket_address> peers;
+  net::service::shared_buffer message{std::string_view("Hello, world!")};
+
+  auto service(async_context &ctx, const socket_dialog &socket,
+               std::shared_ptr<read_context> rctx,
+               std::span<const std::byte> buf) -> void
+  {
+    if (!rctx || buf.empty())
+      return;
+
+    peers.push_back(*rctx->msg.address);
+    if (peers.size() == 2)
+      broadcast(ctx, socket, peers, message);
+
+    submit_recv(ctx, socket, std::move(rctx));
+  }
+};
+
+TEST_F(AsyncUDPServiceTest, BroadcastTest)
+{
+  using namespace io;
+  using namespace io::socket;
+
+  auto service = udp_fanout_service(addr_v4);
+  ASSERT_FALSE(service.start(*ctx));
+
+  {
+    auto clients = std::array{socket_handle(AF_INET, SOCK_DGRAM, 0),
+                              socket_handle(AF_INET, SOCK_DGRAM, 0)};
+
+    const char *subscribe = "s";
+    for (auto &sock : clients)
+    {
+      auto len = sendmsg(sock,
+                         socket_message<sockaddr_in>{
+                             .address = {addr_v4},
+                             .buffers = std::span(subscribe, 1)},
+                         0);
+      ASSERT_EQ(len, 1);
+      ASSERT_GT(ctx->poller.wait_for(50), 0);
+    }
+    while (ctx->poller.wait_for(50));
+    EXPECT_EQ(service.message.use_count(), 1);
+
+    auto buf = std::array<char, 13>{};
+    auto msg = socket_message{.buffers = buf};
+    for (auto &sock : clients)
+    {
+      ASSERT_EQ(recvmsg(sock, msg, 0), 13);
+      EXPECT_EQ(std::string_view(buf.data(), buf.size()), "Hello, world!");
+    }
+  }
+
+  service.signal_handler(ctx->terminate);
+  auto n = 0UL;
+  while (ctx->poller.wait_for(50))
+  {
+    ASSERT_LE(n++, 4);
+  }
+}
+
+struct udp_paced_service : public async_udp_service<udp_paced_service> {
+  using Base = async_udp_service<udp_paced_service>;
+
+  template <typename T>
+  explicit udp_paced_service(socket_address<T> address) : Base(address)
+  {}
+
+  // One 13 byte message per destination every 13ms.
+  pacer pacing{1000, 13};
+  std::vector<read_context::socket_address> peers;
+  net::service::shared_buffer message{std::string_view("Hello, world!")};
+
+  auto service(async_context &ctx, const socket_dialog &socket,
+               std::shared_ptr<read_context> rctx,
+               std::span<const std::byte> buf) -> void
+  {
+    if (!rctx || buf.empty())
+      return;
+
+    peers.push_back(*rctx->msg.address);
+    if (peers.size() == 2)
+    {
+      broadcast(ctx, socket, peers, message);
+      broadcast(ctx, socket, peers, message);
+    }
+
+    submit_recv(ctx, socket, std::move(rctx));
+  }
+};
+
+TEST_F(AsyncUDPServiceTest, PacedBroadcastTest)
+{
+  using namespace io;
+  using namespace io::socket;
+
+  auto service = udp_paced_service(addr_v4);
+  ASSERT_FALSE(service.start(*ctx));
+
+  {
+    auto clients = std::array{socket_handle(AF_INET, SOCK_DGRAM, 0),
+                              socket_handle(AF_INET, SOCK_DGRAM, 0)};
+
+    const char *subscribe = "s";
+    for (auto &sock : clients)
+    {
+      auto len = sendmsg(sock,
+                         socket_message<sockaddr_in>{
+                             .address = {addr_v4},
+                             .buffers = std::span(subscribe, 1)},
+                         0);
+      ASSERT_EQ(len, 1);
+      ASSERT_GT(ctx->poller.wait_for(50), 0);
+    }
+    while (ctx->poller.wait_for(50));
+
+    // Each destination gets its burst, and the second message waits.
+    EXPECT_EQ(service.pacing.pending(), 2);
+    auto buf = std::array<char, 13>{};
+    auto msg = socket_message{.buffers = buf};
+    for (auto &sock : clients)
+    {
+      ASSERT_EQ(recvmsg(sock, msg, 0), 13);
+      EXPECT_LT(recvmsg(sock, msg, MSG_DONTWAIT), 0);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ctx->timers.resolve();
+    while (ctx->poller.wait_for(50));
+    EXPECT_EQ(service.pacing.pending(), 0);
+    for (auto &sock : clients)
+      EXPECT_EQ(recvmsg(sock, msg, 0), 13);
+  }
+
+  service.signal_handler(ctx->terminate);
+  auto n = 0UL;
+  while (ctx->poller.wait_for(50))
+  {
+    ASSERT_LE(n++, 4);
+  }
+}
+
+struct udp_batch_service : public async_udp_service<udp_batch_service> {
+  using Base = async_udp_service<udp_batch_service>;
+
+  template <typename T>
+  explicit udp_batch_service(socket_address<T> address) : Base(address)
+  {}
+
+  std::vector<std::size_t> batches;
+  std::string received;
+
+  auto service_batch(async_context &ctx, std::span<read_event> events) -> void
+  {
+    batches.push_back(events.size());
+    for (auto &[socket, rctx, buf] : events)
+    {
+      if (!rctx || buf.empty())
+        continue;
+
+      received.append(reinterpret_cast<const char *>(buf.data()), buf.size());
+      submit_recv(ctx, socket, std::move(rctx));
+    }
+  }
+};
+
+TEST_F(AsyncUDPServiceTest, BatchTest)
+{
+  using namespace io;
+  using namespace io::socket;
+
+  auto service = udp_batch_service(addr_v4);
+  ASSERT_FALSE(service.start(*ctx));
+
+  {
+    auto sock = socket_handle(AF_INET, SOCK_DGRAM, 0);
+    for (const char *chr : {"a", "b"})
+    {
+      auto len = sendmsg(sock,
+                         socket_message<sockaddr_in>{
+                             .address = {addr_v4},
+                             .buffers = std::span(chr, 1)},
+                         0);
+      ASSERT_EQ(len, 1);
+    }
+
+    while (service.received.size() < 2)
+    {
+      ASSERT_GT(ctx->poller.wait_for(2000), 0);
+      ctx->run_deferred();
+    }
+    EXPECT_EQ(service.received, "ab");
+    EXPECT_FALSE(service.batches.empty());
+    EXPECT_FALSE(ctx->run_deferred());
+  }
+
+  service.signal_handler(ctx->terminate);
+  auto n = 0UL;
+  while (ctx->poller.wait_for(50) || ctx->run_deferred())
+  {
+    ASSERT_LE(n++, 4);
+  }
+}
+
+struct udp_recvmmsg_service
+    : public async_udp_service<udp_recvmmsg_service, 2048> {
+  using Base = async_udp_service<udp_recvmmsg_service, 2048>;
+
+  template <typename T>
+  explicit udp_recvmmsg_service(socket_address<T> address) : Base(address)
+  {}
+
+  static constexpr std::size_t recv_batch = 8;
+
+  std::vector<std::size_t> batches;
+  std::vector<std::pair<char, in_port_t>> received;
+
+  auto service_batch(async_context &ctx, std::span<read_event> events) -> void
+  {
+    batches.push_back(events.size());
+    for (auto &[socket, rctx, buf] : events)
+    {
+      if (!rctx || buf.empty())
+        continue;
+
+      auto address = *rctx->msg.address;
+      received.emplace_back(static_cast<char>(buf[0]), address->sin6_port);
+      submit_recv(ctx, socket, std::move(rctx));
+    }
+  }
+};
+
+TEST_F(AsyncUDPServiceTest, RecvBatchTest)
+{
+  using namespace io;
+  using namespace io::socket;
+
+  auto service = udp_recvmmsg_service(addr_v4);
+  ASSERT_FALSE(service.start(*ctx));
+
+  {
+    auto socks = std::array<socket_handle, 2>{
+        socket_handle(AF_INET, SOCK_DGRAM, 0),
+        socket_handle(AF_INET, SOCK_DGRAM, 0)};
+    auto ports = std::array<in_port_t, 2>{};
+    for (auto i = 0; const char *chr : {"a", "b", "c", "d", "e"})
+    {
+      auto &sock = socks[i++ % 2];
+      auto len = sendmsg(sock,
+                         socket_message<sockaddr_in>{
+                             .address = {addr_v4},
+                             .buffers = std::span(chr, 1)},
+                         0);
+      ASSERT_EQ(len, 1);
+    }
+    for (auto i = 0; i < 2; ++i)
+    {
+      auto addr = sockaddr_in{};
+      auto len = socklen_t{sizeof(addr)};
+      ASSERT_EQ(::getsockname(static_cast<native_socket_type>(socks[i]),
+                              reinterpret_cast<sockaddr *>(&addr), &len),
+                0);
+      ports[i] = addr.sin_port;
+    }
+
+    while (service.received.size() < 5)
+    {
+      ASSERT_GT(ctx->poller.wait_for(2000), 0);
+      ctx->run_deferred();
+    }
+
+    // Every queued datagram is read by one recvmmsg.
+    ASSERT_EQ(service.batches.size(), 1);
+    EXPECT_EQ(service.batches[0], 5);
+    for (auto i = 0; auto [chr, port] : service.received)
+    {
+      EXPECT_EQ(chr, "abcde"[i]);
+      EXPECT_EQ(port, ports[i++ % 2]);
+    }
+  }
+
+  service.signal_handler(ctx->terminate);
+  auto n = 0UL;
+  while (ctx->poller.wait_for(50) || ctx->run_deferred())
+  {
+    ASSERT_LE(n++, 4);
+  }
+}
+
+struct udp_reply_service
+    : public async_udp_service<udp_reply_service, 2048> {
+  using Base = async_udp_service<udp_reply_service, 2048>;
+
+  template <typename T>
+  explicit udp_reply_service(socket_address<T> address) : Base(address)
+  {}
+
+  static constexpr std::size_t recv_batch = 4;
+
+  auto service(async_context &ctx, const socket_dialog &socket,
+               std::shared_ptr<read_context> rctx,
+               std::span<const std::byte> buf) -> void
+  {
+    if (!rctx || buf.empty())
+      return;
+
+    reply(ctx, socket, std::move(rctx), buf);
+  }
+};
+
+TEST_F(AsyncUDPServiceTest, ReplyTest)
+{
+  using namespace io;
+  using namespace io::socket;
+
+  auto service = udp_reply_service(addr_v4);
+  ASSERT_FALSE(service.start(*ctx));
+
+  {
+    auto sock = socket_handle(AF_INET, SOCK_DGRAM, 0);
+    // More requests than slots, so replies must free slots to continue.
+    const auto *requests = "abcdef";
+    for (const auto *chr = requests; *chr; ++chr)
+    {
+      auto len = sendmsg(sock,
+                         socket_message<sockaddr_in>{
+                             .address = {addr_v4},
+                             .buffers = std::span(chr, 1)},
+                         0);
+      ASSERT_EQ(len, 1);
+    }
+
+    auto buf = std::array<char, 1>{};
+    auto msg = socket_message{.buffers = buf};
+    for (const auto *chr = requests; *chr; ++chr)
+    {
+      while (recvmsg(sock, msg, MSG_DONTWAIT) != 1)
+      {
+        if (!ctx->run_deferred())
+        {
+          ASSERT_GT(ctx->poller.wait_for(2000), 0);
+        }
+      }
+      EXPECT_EQ(buf[0], *chr);
+    }
+  }
+
+  service.signal_handler(ctx->terminate);
+  auto n = 0UL;
+  while (ctx->poller.wait_for(50) || ctx->run_deferred())
+  {
+    ASSERT_LE(n++, 4);
+  }
+}
+
+auto send_segmented(int sockfd, std::span<char> payload,
+                    std::uint16_t segment_size) -> ssize_t
+{
+  struct alignas(cmsghdr) control_buffer {
+    std::array<char, CMSG_SPACE(sizeof(std::uint16_t))> data;
+  };
+
+  auto iov = iovec{.iov_base = payload.data(), .iov_len = payload.size()};
+  auto control = control_buffer{};
+  auto msg = msghdr{.msg_iov = &iov,
+                    .msg_iovlen = 1,
+                    .msg_control = control.data.data(),
+                    .msg_controllen = control.data.size()};
+  auto *cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_UDP;
+  cmsg->cmsg_type = UDP_SEGMENT;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(std::uint16_t));
+  std::memcpy(CMSG_DATA(cmsg), &segment_size, sizeof(segment_size));
+  return ::sendmsg(sockfd, &msg, 0);
+}
+
+struct udp_gro_service : public async_udp_service<udp_gro_service> {
+  using Base = async_udp_service<udp_gro_service>;
+
+  template <typename T>
+  explicit udp_gro_service(socket_address<T> address) : Base(address)
+  {}
+
+  static constexpr bool udp_gro = true;
+
+  std::vector<std::size_t> segments;
+  net::service::shared_buffer reply_buffer{std::string(250, 'x')};
+  // The kernel rejects segmented sends from a socket without checksums.
+  bool checksums = true;
+
+  auto service(async_context &ctx, const socket_dialog &socket,
+               std::shared_ptr<read_context> rctx,
+               std::span<const std::byte> buf) -> void
+  {
+    if (!rctx || buf.empty())
+      return;
+
+    if (buf.size() == 1)
+    {
+      if (!checksums)
+      {
+        const auto sockfd =
+            static_cast<io::socket::native_socket_type>(*socket.socket);
+        auto disabled = 1;
+        ::setsockopt(sockfd, SOL_SOCKET, SO_NO_CHECK, &disabled,
+                     sizeof(disabled));
+      }
+      send_segments(ctx, socket, *rctx->msg.address, reply_buffer, 100);
+    }
+    else
+    {
+      auto size = rctx->segment_size ? rctx->segment_size : buf.size();
+      for (auto offset = 0UL; offset < buf.size(); offset += size)
+        segments.push_back(std::min(size, buf.size() - offset));
+    }
+    submit_recv(ctx, socket, std::move(rctx));
+  }
+};
+
+TEST_F(AsyncUDPServiceTest, SegmentationOffloadTest)
+{
+  using namespace io;
+  using namespace io::socket;
+
+  auto service = udp_gro_service(addr_v4);
+  ASSERT_FALSE(service.start(*ctx));
+
+  {
+    auto sock = socket_handle(AF_INET, SOCK_DGRAM, 0);
+    const auto sockfd = static_cast<native_socket_type>(sock);
+    ASSERT_EQ(io::connect(sock, addr_v4), 0);
+
+    // Three 100 byte datagrams in one segmented send. They arrive either
+    // coalesced or one at a time, but always as three segments.
+    auto payload = std::array<char, 300>{};
+    ASSERT_EQ(send_segmented(sockfd, payload, 100), 300);
+
+    while (service.segments.size() < 3)
+      ASSERT_GT(ctx->poller.wait_for(2000), 0);
+    EXPECT_EQ(service.segments, (std::vector<std::size_t>{100, 100, 100}));
+
+    // The reply is split into 100 byte datagrams by the kernel.
+    ASSERT_EQ(::send(sockfd, "?", 1, 0), 1);
+    auto buf = std::array<char, 512>{};
+    for (auto expected : {100, 100, 50})
+    {
+      auto len = ssize_t{};
+      while ((len = ::recv(sockfd, buf.data(), buf.size(), MSG_DONTWAIT)) < 0)
+        ASSERT_GT(ctx->poller.wait_for(2000), 0);
+      EXPECT_EQ(len, expected);
+    }
+  }
+
+  service.signal_handler(ctx->terminate);
+  auto n = 0UL;
+  while (ctx->poller.wait_for(50))
+  {
+    ASSERT_LE(n++, 4);
+  }
+}
+
+TEST_F(AsyncUDPServiceTest, SegmentationFallbackTest)
+{
+  using namespace io;
+  using namespace io::socket;
+
+  auto service = udp_gro_service(addr_v4);
+  service.checksums = false;
+  ASSERT_FALSE(service.start(*ctx));
+
+  {
+    auto sock = socket_handle(AF_INET, SOCK_DGRAM, 0);
+    const auto sockfd = static_cast<native_socket_type>(sock);
+    ASSERT_EQ(io::connect(sock, addr_v4), 0);
+
+    // Without checksums the segmented send fails...
+    auto disabled = 1;
+    ASSERT_EQ(::setsockopt(sockfd, SOL_SOCKET, SO_NO_CHECK, &disabled,
+                           sizeof(disabled)),
+              0);
+    auto payload = std::array<char, 300>{};
+    ASSERT_LT(send_segmented(sockfd, payload, 100), 0);
+
+    // ...so the reply is sent one datagram at a time instead.
+    ASSERT_EQ(::send(sockfd, "?", 1, 0), 1);
+    auto buf = std::array<char, 512>{};
+    for (auto expected : {100, 100, 50})
+    {
+      auto len = ssize_t{};
+      while ((len = ::recv(sockfd, buf.data(), buf.size(), MSG_DONTWAIT)) < 0)
+        ASSERT_GT(ctx->poller.wait_for(2000), 0);
+      EXPECT_EQ(len, expected);
+    }
+  }
+
+  service.signal_handler(ctx->terminate);
+  auto n = 0UL;
+  while (ctx->poller.wait_for(50))
+  {
+    ASSERT_LE(n++, 4);
+  }
+}
+
+struct udp_pool_service
+    : public async_udp_service<udp_pool_service, 2048> {
+  using Base = async_udp_service<udp_pool_service, 2048>;
+
+  template <typename T>
+  explicit udp_pool_service(socket_address<T> address) : Base(address)
+  {}
+
+  static constexpr std::size_t provided_buffers = 4;
+
+  std::vector<std::shared_ptr<read_context>> held;
+  std::vector<const read_context *> received;
+
+  auto service(async_context &ctx, const socket_dialog &socket,
+               std::shared_ptr<read_context> rctx,
+               std::span<const std::byte> buf) -> void
+  {
+    if (!rctx || buf.empty())
+      return;
+
+    // Hold on to the datagram without re-arming the socket.
+    received.push_back(rctx.get());
+    held.push_back(std::move(rctx));
+  }
+};
+
+TEST_F(AsyncUDPServiceTest, ProvidedBuffersTest)
+{
+  using namespace io;
+  using namespace io::socket;
+
+  auto service = udp_pool_service(addr_v4);
+  ASSERT_FALSE(service.start(*ctx));
+
+  {
+    auto sock = socket_handle(AF_INET, SOCK_DGRAM, 0);
+    auto send = [&](const char *chr) {
+      auto len = sendmsg(sock,
+                         socket_message<sockaddr_in>{
+                             .address = {addr_v4},
+                             .buffers = std::span(chr, 1)},
+                         0);
+      ASSERT_EQ(len, 1);
+    };
+
+    // The socket keeps draining while every datagram is held.
+    for (const char *chr : {"a", "b", "c"})
+      send(chr);
+    while (service.received.size() < 3)
+      ASSERT_GT(ctx->poller.wait_for(2000), 0);
+
+    auto first = std::vector(service.received.begin(),
+                             service.received.end());
+    std::ranges::sort(first);
+    EXPECT_EQ(std::ranges::unique(first).size(), 0);
+
+    // Released read contexts return to the ring.
+    service.held.clear();
+    for (const char *chr : {"d", "e"})
+      send(chr);
+    while (service.received.size() < 5)
+      ASSERT_GT(ctx->poller.wait_for(2000), 0);
+    EXPECT_TRUE(std::ranges::binary_search(first, service.received[4]));
+  }
+
+  service.signal_handler(ctx->terminate);
+  auto n = 0UL;
+  while (ctx->poller.wait_for(50))
+  {
+    ASSERT_LE(n++, 4);
+  }
+}
+
+struct udp_session_service : public async_udp_service<udp_session_service> {
+  using Base = async_udp_service<udp_session_service>;
+
+  template <typename T>
+  explicit udp_session_service(socket_address<T> address) : Base(address)
+  {}
+
+  struct peer_state {
+    std::string received;
+  };
+
+  session_table<peer_state> sessions{std::chrono::milliseconds(50)};
+
+  auto service(async_context &ctx, const socket_dialog &socket,
+               std::shared_ptr<read_context> rctx,
+               std::span<const std::byte> buf, peer_state *session) -> void
+  {
+    if (!rctx || buf.empty())
+      return;
+
+    session->received.append(reinterpret_cast<const char *>(buf.data()),
+                             buf.size());
+    submit_recv(ctx, socket, std::move(rctx));
+  }
+};
+
+TEST_F(AsyncUDPServiceTest, SessionTest)
+{
+  using namespace io;
+  using namespace io::socket;
+
+  auto service = udp_session_service(addr_v4);
+  ASSERT_FALSE(service.start(*ctx));
+
+  {
+    auto socks = std::array<socket_handle, 2>{
+        socket_handle(AF_INET, SOCK_DGRAM, 0),
+        socket_handle(AF_INET, SOCK_DGRAM, 0)};
+    auto peers = std::array<socket_address<sockaddr_in6>, 2>{};
+    for (auto i = 0; i < 2; ++i)
+    {
+      const auto sockfd = static_cast<native_socket_type>(socks[i]);
+      ASSERT_EQ(io::connect(socks[i], addr_v4), 0);
+      auto len = socklen_t{sizeof(sockaddr_in6)};
+      ASSERT_EQ(::getsockname(sockfd,
+                              reinterpret_cast<sockaddr *>(&(*peers[i])),
+                              &len),
+                0);
+    }
+
+    for (auto i = 0; const char *chr : {"a", "b", "c", "d"})
+    {
+      const auto sockfd = static_cast<native_socket_type>(socks[i++ % 2]);
+      ASSERT_EQ(::send(sockfd, chr, 1, 0), 1);
+    }
+
+    auto received = [&](const auto &peer) -> std::string {
+      auto *session = service.sessions.find(peer);
+      return session ? session->received : "";
+    };
+    while (received(peers[0]).size() + received(peers[1]).size() < 4)
+      ASSERT_GT(ctx->poller.wait_for(2000), 0);
+
+    // Each peer's datagrams are delivered with its own session.
+    EXPECT_EQ(service.sessions.size(), 2);
+    EXPECT_EQ(received(peers[0]), "ac");
+    EXPECT_EQ(received(peers[1]), "bd");
+
+    // Idle sessions expire on the context timers.
+    std::this_thread::sleep_for(std::chrono::milliseconds(120));
+    ctx->timers.resolve();
+    EXPECT_EQ(service.sessions.size(), 0);
+  }
+
+  service.signal_handler(ctx->terminate);
+  auto n = 0UL;
+  while (ctx->poller.wait_for(50))
+  {
+    ASSERT_LE(n++, 4);
+  }
+}
+
+struct udp_stats_service : public async_udp_service<udp_stats_service> {
+  using Base = async_udp_service<udp_stats_service>;
+
+  template <typename T>
+  explicit udp_stats_service(socket_address<T> address) : Base(address)
+  {}
+
+  static constexpr bool rxq_overflow = true;
+  static constexpr bool rx_timestamps = true;
+
+  std::size_t received = 0;
+
+  auto initialize(const socket_handle &socket) -> std::error_code
+  {
+    using namespace io;
+    using namespace io::socket;
+    // Small enough that a burst of datagrams overflows it.
+    if (auto size = socket_option<int>(2048);
+        setsockopt(socket, SOL_SOCKET, SO_RCVBUF, size))
+    {
+      return {errno, std::system_category()};
+    }
+    return {};
+  }
+
+  auto service(async_context &ctx, const socket_dialog &socket,
+               std::shared_ptr<read_context> rctx,
+               std::span<const std::byte> buf) -> void
+  {
+    if (!rctx || buf.empty())
+      return;
+
+    EXPECT_NE(rctx->timestamp.time_since_epoch().count(), 0);
+    ++received;
+    submit_recv(ctx, socket, std::move(rctx));
+  }
+};
+
+TEST_F(AsyncUDPServiceTest, StatisticsTest)
+{
+  using namespace io;
+  using namespace io::socket;
+
+  auto service = udp_stats_service(addr_v4);
+  ASSERT_FALSE(service.start(*ctx));
+
+  {
+    auto sock = socket_handle(AF_INET, SOCK_DGRAM, 0);
+    const auto sockfd = static_cast<native_socket_type>(sock);
+    ASSERT_EQ(io::connect(sock, addr_v4), 0);
+
+    // Overflow the receive buffer before the service gets to read.
+    auto payload = std::array<char, 1024>{};
+    for (auto i = 0; i < 64; ++i)
+      ASSERT_EQ(::send(sockfd, payload.data(), payload.size(), 0), 1024);
+    while (ctx->poller.wait_for(50) > 0)
+    {
+    }
+
+    // The drop count arrives with the next datagram that is queued.
+    const auto before = service.received;
+    ASSERT_GT(before, 0);
+    ASSERT_LT(before, 64);
+    ASSERT_EQ(::send(sockfd, payload.data(), 1, 0), 1);
+    while (service.received == before)
+      ASSERT_GT(ctx->poller.wait_for(2000), 0);
+
+    const auto &stats = service.statistics();
+    EXPECT_EQ(stats.datagrams.load(), service.received);
+    EXPECT_EQ(stats.drops.load(), 64 - before);
+    EXPECT_EQ(stats.latency.count(), service.received);
+    EXPECT_GT(stats.latency.percentile(100), std::chrono::nanoseconds(0));
+  }
+
+  service.signal_handler(ctx->terminate);
+  auto n = 0UL;
+  while (ctx->poller.wait_for(50))
+  {
+    ASSERT_LE(n++, 4);
+  }
+}
+
 TEST_F(AsyncUDPServiceTest, InitializeError)
 {
   using namespace io::socket;
@@ -0,0 +1,107 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// NOLINTBEGIN
+#include "net/service/buffer_tuner.hpp"
+#include "test_tcp_fixture.hpp"
+
+struct tcp_tuned_service : public async_tcp_service<tcp_tuned_service> {
+  using Base = async_tcp_service<tcp_tuned_service>;
+
+  template <typename T>
+  explicit tcp_tuned_service(socket_address<T> address) : Base(address)
+  {}
+
+  buffer_tuner *tuner = nullptr;
+  std::vector<socket_dialog> connections;
+
+  auto service(async_context &ctx, const socket_dialog &socket,
+               std::shared_ptr<read_context> rctx,
+               std::span<const std::byte> buf) -> void
+  {
+    if (!rctx)
+      return;
+
+    if (buf.empty())
+    {
+      tuner->add(socket);
+      connections.push_back(socket);
+    }
+    submit_recv(ctx, socket, std::move(rctx));
+  }
+};
+
+class BufferTunerTest : public AsyncTcpServiceTest {};
+
+TEST_F(BufferTunerTest, BdpTest)
+{
+  auto info = net::detail::tcp_info_ext{};
+  info.info.tcpi_rtt = 10'000;
+  info.info.tcpi_snd_cwnd = 10;
+  info.info.tcpi_snd_mss = 1448;
+  info.tcpi_delivery_rate = 1'000'000;
+
+  // 1MB/s over a 10ms RTT.
+  EXPECT_EQ(buffer_tuner::bdp(info, sizeof(info)), 10'000);
+  // Kernels without a delivery rate fall back to the congestion window.
+  EXPECT_EQ(buffer_tuner::bdp(info, sizeof(info.info)), 14'480);
+}
+
+TEST_F(BufferTunerTest, TuneTest)
+{
+  using namespace io::socket;
+  constexpr auto MIN_BUFFER = 256UL * 1024;
+  constexpr auto MAX_BUFFER = 512UL * 1024;
+
+  auto tuner = buffer_tuner(
+      *ctx, {.min_buffer = MIN_BUFFER, .max_buffer = MAX_BUFFER});
+  auto service = tcp_tuned_service(addr_v4);
+  service.tuner = &tuner;
+  ASSERT_FALSE(service.start(*ctx));
+
+  {
+    auto sock = socket_handle(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(io::connect(sock, addr_v4), 0);
+    while (service.connections.empty())
+      ASSERT_GT(ctx->poller.wait_for(2000), 0);
+    EXPECT_EQ(tuner.size(), 1);
+
+    tuner.tune();
+    const auto sockfd =
+        static_cast<native_socket_type>(*service.connections[0].socket);
+    for (auto option : {SO_SNDBUF, SO_RCVBUF})
+    {
+      auto size = 0;
+      auto len = socklen_t{sizeof(size)};
+      ASSERT_EQ(::getsockopt(sockfd, SOL_SOCKET, option, &size, &len), 0);
+      // Linux doubles the requested size for bookkeeping overhead.
+      EXPECT_GE(size, MIN_BUFFER);
+      EXPECT_LE(size, 2 * MAX_BUFFER);
+    }
+  }
+
+  // Closed connections are released on the next sample.
+  service.connections.clear();
+  while (ctx->poller.wait_for(50));
+  tuner.tune();
+  EXPECT_EQ(tuner.size(), 0);
+
+  service.signal_handler(ctx->terminate);
+  auto n = 0UL;
+  while (ctx->poller.wait_for(50))
+  {
+    ASSERT_LE(n++, 4);
+  }
+}
+// NOLINTEND
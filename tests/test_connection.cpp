@@ -0,0 +1,389 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// NOLINTBEGIN
+#include "net/service/connection.hpp"
+#include "test_tcp_fixture.hpp"
+
+#include <stdexcept>
+#include <string>
+
+using namespace net::service;
+using namespace std::chrono;
+
+static auto answer() -> task<int> { co_return 42; }
+
+static auto add_answer(int &result) -> task<void>
+{
+  result += co_await answer();
+}
+
+static auto throws() -> task<int>
+{
+  throw std::runtime_error("test");
+  co_return 0;
+}
+
+TEST(TaskTest, AwaitTest)
+{
+  auto result = 0;
+  auto outer = add_answer(result);
+  EXPECT_FALSE(outer.done());
+  EXPECT_EQ(result, 0);
+
+  outer.start();
+  EXPECT_TRUE(outer.done());
+  EXPECT_EQ(result, 42);
+}
+
+TEST(TaskTest, ExceptionTest)
+{
+  auto inner = throws();
+  inner.start();
+  ASSERT_TRUE(inner.done());
+  EXPECT_THROW(inner.result(), std::runtime_error);
+}
+
+TEST(TaskTest, DoneTest)
+{
+  static auto count = 0;
+  auto *result = new task<int>(answer());
+  result->start(
+      [](void *arg) noexcept {
+        ++count;
+        delete static_cast<task<int> *>(arg);
+      },
+      result);
+  EXPECT_EQ(count, 1);
+}
+
+TEST(FramePoolTest, ReuseTest)
+{
+  frame_pool::release();
+  ASSERT_EQ(frame_pool::cached(), 0);
+
+  auto *block = frame_pool::allocate(100);
+  frame_pool::deallocate(block, 100);
+  EXPECT_EQ(frame_pool::cached(), 1);
+
+  // Sizes in the same size class share blocks.
+  EXPECT_EQ(frame_pool::allocate(128), block);
+  EXPECT_EQ(frame_pool::cached(), 0);
+  frame_pool::deallocate(block, 128);
+
+  // Frames are returned to the pool when the coroutine is destroyed.
+  {
+    auto result = 0;
+    add_answer(result).start();
+  }
+  const auto cached = frame_pool::cached();
+  EXPECT_GT(cached, 1);
+  {
+    auto result = 0;
+    add_answer(result).start();
+  }
+  EXPECT_EQ(frame_pool::cached(), cached);
+
+  // Blocks larger than the largest size class are not pooled.
+  constexpr auto large = frame_pool::min_block << frame_pool::size_classes;
+  frame_pool::deallocate(frame_pool::allocate(large), large);
+  EXPECT_EQ(frame_pool::cached(), cached);
+
+  frame_pool::release();
+  EXPECT_EQ(frame_pool::cached(), 0);
+}
+
+struct tcp_coroutine_service
+    : public async_tcp_service<tcp_coroutine_service> {
+  using Base = async_tcp_service<tcp_coroutine_service>;
+
+  template <typename T>
+  explicit tcp_coroutine_service(socket_address<T> address) : Base(address)
+  {}
+
+  milliseconds delay{0};
+  int closed = 0;
+
+  auto handle(connection &conn) -> task<void>
+  {
+    auto buf = std::array<std::byte, 1024>{};
+    while (auto len = co_await conn.read(buf))
+    {
+      co_await conn.sleep(delay);
+      if (conn.error() ||
+          co_await conn.write(std::span(buf).first(len)) < len)
+        break;
+    }
+    ++closed;
+  }
+};
+
+class ConnectionTest : public AsyncTcpServiceTest {
+protected:
+  /** @brief Runs the poller and the timers for a while. */
+  auto run_for(milliseconds duration) -> void
+  {
+    const auto deadline = steady_clock::now() + duration;
+    while (steady_clock::now() < deadline)
+    {
+      ctx->timers.resolve();
+      ctx->poller.wait_for(1);
+    }
+  }
+
+  /** @brief Sends a message. */
+  static auto send(const io::socket::socket_handle &sock,
+                   std::string_view text) -> void
+  {
+    using namespace io::socket;
+    auto msg = socket_message{.buffers = std::span(text.data(), text.size())};
+    EXPECT_EQ(io::sendmsg(sock, msg, 0), static_cast<long>(text.size()));
+  }
+
+  /** @brief Receives whatever has arrived without blocking. */
+  static auto receive(const io::socket::socket_handle &sock) -> std::string
+  {
+    using namespace io::socket;
+    auto buf = std::array<char, 1024>();
+    auto msg = socket_message{.buffers = buf};
+    auto len = io::recvmsg(sock, msg, MSG_DONTWAIT);
+    if (len <= 0)
+      return {};
+    return {buf.data(), static_cast<std::size_t>(len)};
+  }
+
+  /** @brief Sends a message and receives the echo. */
+  auto echo(const io::socket::socket_handle &sock,
+            std::string_view text) -> std::string
+  {
+    send(sock, text);
+    run_for(milliseconds(50));
+    return receive(sock);
+  }
+};
+
+TEST_F(ConnectionTest, EchoTest)
+{
+  using namespace io::socket;
+  auto service = tcp_coroutine_service(addr_v4);
+  ASSERT_FALSE(service.start(*ctx));
+
+  auto cached = std::size_t{};
+  for (int i = 0; i < 2; ++i)
+  {
+    {
+      auto sock = socket_handle(AF_INET, SOCK_STREAM, 0);
+      ASSERT_EQ(io::connect(sock, addr_v4), 0);
+      EXPECT_EQ(echo(sock, "hello"), "hello");
+      EXPECT_EQ(echo(sock, "world"), "world");
+    }
+    run_for(milliseconds(50));
+    ASSERT_EQ(service.closed, i + 1);
+
+    // The second connection reuses the blocks of the first.
+    if (i == 0)
+      cached = frame_pool::cached();
+    EXPECT_GT(frame_pool::cached(), 0);
+    EXPECT_EQ(frame_pool::cached(), cached);
+  }
+
+  service.signal_handler(ctx->terminate);
+  while (ctx->poller.wait_for(50));
+}
+
+TEST_F(ConnectionTest, SleepTest)
+{
+  using namespace io::socket;
+  auto service = tcp_coroutine_service(addr_v4);
+  service.delay = milliseconds(20);
+  ASSERT_FALSE(service.start(*ctx));
+
+  {
+    auto sock = socket_handle(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(io::connect(sock, addr_v4), 0);
+
+    // The echo is held back until the coroutine wakes up.
+    send(sock, "hello");
+    run_for(milliseconds(5));
+    EXPECT_EQ(receive(sock), "");
+    run_for(milliseconds(50));
+    EXPECT_EQ(receive(sock), "hello");
+  }
+  run_for(milliseconds(50));
+  EXPECT_EQ(service.closed, 1);
+
+  service.signal_handler(ctx->terminate);
+  while (ctx->poller.wait_for(50));
+}
+
+TEST_F(ConnectionTest, TerminateReadTest)
+{
+  using namespace io::socket;
+  auto service = tcp_coroutine_service(addr_v4);
+  ASSERT_FALSE(service.start(*ctx));
+
+  auto sock = socket_handle(AF_INET, SOCK_STREAM, 0);
+  ASSERT_EQ(io::connect(sock, addr_v4), 0);
+  EXPECT_EQ(echo(sock, "hello"), "hello");
+
+  // Stopping the scope cancels the read the coroutine is parked in.
+  service.signal_handler(ctx->terminate);
+  ctx->signal(ctx->terminate);
+  while (ctx->poller.wait_for(50));
+  EXPECT_EQ(service.closed, 1);
+}
+
+TEST_F(ConnectionTest, TerminateSleepTest)
+{
+  using namespace io::socket;
+  auto service = tcp_coroutine_service(addr_v4);
+  service.delay = seconds(60);
+  ASSERT_FALSE(service.start(*ctx));
+
+  auto sock = socket_handle(AF_INET, SOCK_STREAM, 0);
+  ASSERT_EQ(io::connect(sock, addr_v4), 0);
+  send(sock, "hello");
+  run_for(milliseconds(50));
+  EXPECT_EQ(service.closed, 0);
+
+  // Stopping the scope wakes the coroutine from its sleep, so its frame
+  // and connection are freed even though the timer never fires.
+  service.signal_handler(ctx->terminate);
+  ctx->signal(ctx->terminate);
+  while (ctx->poller.wait_for(50));
+  EXPECT_EQ(service.closed, 1);
+  EXPECT_EQ(receive(sock), "");
+}
+
+struct tcp_byte_service : public async_tcp_service<tcp_byte_service> {
+  using Base = async_tcp_service<tcp_byte_service>;
+
+  template <typename T>
+  explicit tcp_byte_service(socket_address<T> address) : Base(address)
+  {}
+
+  std::size_t reads = 0;
+
+  auto handle(connection &conn) -> task<void>
+  {
+    auto buf = std::array<std::byte, 1>{};
+    while (co_await conn.read(buf))
+    {
+      ++reads;
+      if (co_await conn.write(buf) < buf.size())
+        break;
+    }
+  }
+};
+
+TEST_F(ConnectionTest, ReadyLoopTest)
+{
+  using namespace io::socket;
+  auto service = tcp_byte_service(addr_v4);
+  ASSERT_FALSE(service.start(*ctx));
+
+  {
+    auto sock = socket_handle(AF_INET, SOCK_STREAM, 0);
+    const auto sockfd = static_cast<native_socket_type>(sock);
+    ASSERT_EQ(io::connect(sock, addr_v4), 0);
+
+    // Echoing one byte at a time keeps the socket readable, so most reads
+    // and writes complete as soon as they start. They must continue the
+    // coroutine without nesting, or the stack would overflow.
+    auto payload = std::string(256UL * 1024, '\0');
+    for (std::size_t i = 0; i < payload.size(); ++i)
+      payload[i] = static_cast<char>('a' + i % 26);
+
+    auto sent = std::size_t{0};
+    auto received = std::string();
+    const auto deadline = steady_clock::now() + seconds(10);
+    while (received.size() < payload.size() &&
+           steady_clock::now() < deadline)
+    {
+      if (sent < payload.size())
+      {
+        auto len = ::send(sockfd, payload.data() + sent,
+                          payload.size() - sent, MSG_DONTWAIT);
+        if (len > 0)
+          sent += static_cast<std::size_t>(len);
+      }
+      run_for(milliseconds(1));
+      for (auto chunk = receive(sock); !chunk.empty(); chunk = receive(sock))
+        received += chunk;
+    }
+    EXPECT_EQ(service.reads, payload.size());
+    EXPECT_TRUE(received == payload);
+  }
+
+  service.signal_handler(ctx->terminate);
+  while (ctx->poller.wait_for(50));
+}
+
+struct tcp_bulk_service : public async_tcp_service<tcp_bulk_service> {
+  using Base = async_tcp_service<tcp_bulk_service>;
+
+  template <typename T>
+  explicit tcp_bulk_service(socket_address<T> address) : Base(address)
+  {}
+
+  std::string payload = std::string(1UL << 20, 'x');
+  std::size_t written = 0;
+
+  auto handle(connection &conn) -> task<void>
+  {
+    using namespace io::socket;
+
+    // A small send buffer makes the kernel take the payload in pieces.
+    const auto sockfd = static_cast<native_socket_type>(*conn.socket().socket);
+    auto size = 4096;
+    ::setsockopt(sockfd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+
+    auto buf = std::array<std::byte, 16>{};
+    if (co_await conn.read(buf))
+      written = co_await conn.write(std::as_bytes(std::span(payload)));
+  }
+};
+
+TEST_F(ConnectionTest, PartialWriteTest)
+{
+  using namespace io::socket;
+  auto service = tcp_bulk_service(addr_v4);
+  for (std::size_t i = 0; i < service.payload.size(); ++i)
+    service.payload[i] = static_cast<char>('a' + i % 26);
+  ASSERT_FALSE(service.start(*ctx));
+
+  {
+    auto sock = socket_handle(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(io::connect(sock, addr_v4), 0);
+    send(sock, "go");
+
+    // The loop is driven by hand and never runs deferred routines, so
+    // each partial send must be resent as soon as it completes.
+    auto received = std::string();
+    const auto deadline = steady_clock::now() + seconds(5);
+    while (received.size() < service.payload.size() &&
+           steady_clock::now() < deadline)
+    {
+      run_for(milliseconds(1));
+      for (auto chunk = receive(sock); !chunk.empty(); chunk = receive(sock))
+        received += chunk;
+    }
+    EXPECT_EQ(service.written, service.payload.size());
+    EXPECT_TRUE(received == service.payload);
+  }
+
+  service.signal_handler(ctx->terminate);
+  while (ctx->poller.wait_for(50));
+}
+// NOLINTEND
@@ -0,0 +1,69 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// NOLINTBEGIN
+#include "net/service/latency_histogram.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace net::service;
+using namespace std::chrono;
+
+TEST(LatencyHistogramTest, EmptyTest)
+{
+  auto histogram = latency_histogram();
+  EXPECT_EQ(histogram.count(), 0);
+  EXPECT_EQ(histogram.percentile(50), nanoseconds(0));
+}
+
+TEST(LatencyHistogramTest, BucketTest)
+{
+  auto histogram = latency_histogram();
+
+  // Small latencies are exact, and larger ones land in a bucket whose
+  // upper bound is within 12.5% of them.
+  for (auto nanos : {0L, 1L, 7L, 8L, 15L, 16L, 1000L, 123456789L})
+  {
+    histogram.reset();
+    histogram.record(nanoseconds(nanos));
+    auto bound = histogram.percentile(100);
+    EXPECT_GE(bound.count(), nanos);
+    EXPECT_LE(bound.count(), nanos + nanos / 8);
+  }
+
+  histogram.reset();
+  histogram.record(nanoseconds(-5));
+  EXPECT_EQ(histogram.bucket_count(0), 1);
+  histogram.record(nanoseconds::max());
+  EXPECT_EQ(histogram.bucket_count(latency_histogram::buckets - 1), 1);
+  EXPECT_EQ(latency_histogram::upper_bound(latency_histogram::buckets - 1),
+            nanoseconds::max());
+}
+
+TEST(LatencyHistogramTest, PercentileTest)
+{
+  auto histogram = latency_histogram();
+  for (auto i = 1; i <= 100; ++i)
+    histogram.record(microseconds(i));
+
+  EXPECT_EQ(histogram.count(), 100);
+  auto p50 = histogram.percentile(50);
+  EXPECT_GE(p50, microseconds(50));
+  EXPECT_LE(p50, microseconds(57));
+  auto p99 = histogram.percentile(99);
+  EXPECT_GE(p99, microseconds(99));
+  EXPECT_LE(p99, microseconds(112));
+  EXPECT_LE(histogram.percentile(0), microseconds(1));
+}
+// NOLINTEND
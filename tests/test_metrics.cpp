@@ -0,0 +1,265 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// NOLINTBEGIN
+#include "net/service/metrics.hpp"
+#include "net/service/metrics_exporter.hpp"
+#include "test_tcp_fixture.hpp"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace net::service;
+using namespace std::chrono;
+
+TEST(MetricsTest, CounterTest)
+{
+  auto registry = metrics_registry();
+  auto &counter = registry.add_counter("test_total", "Test.");
+
+  auto threads = std::vector<std::thread>();
+  for (int i = 0; i < 8; ++i)
+  {
+    threads.emplace_back([&] {
+      for (int j = 0; j < 1000; ++j)
+        counter.add();
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  EXPECT_EQ(counter.value(), 8000);
+  counter.add(5);
+  EXPECT_EQ(counter.value(), 8005);
+}
+
+TEST(MetricsTest, GaugeTest)
+{
+  auto registry = metrics_registry();
+  auto &gauge = registry.add_gauge("test", "Test.");
+  gauge.set(2.5);
+  gauge.add(-1);
+  EXPECT_EQ(gauge.value(), 1.5);
+}
+
+TEST(MetricsTest, HistogramTest)
+{
+  auto registry = metrics_registry();
+  auto &histogram = registry.add_histogram("test_seconds", "Test.", {1, 2, 4});
+  histogram.observe(0.5);
+  histogram.observe(1.0);
+  histogram.observe(3.0);
+  histogram.observe(10.0);
+  histogram.observe(milliseconds(500));
+
+  EXPECT_EQ(histogram.bucket_count(0), 3);
+  EXPECT_EQ(histogram.bucket_count(1), 0);
+  EXPECT_EQ(histogram.bucket_count(2), 1);
+  EXPECT_EQ(histogram.bucket_count(3), 1);
+  EXPECT_EQ(histogram.count(), 5);
+  EXPECT_EQ(histogram.sum(), 15.0);
+}
+
+TEST(MetricsTest, RegistryTest)
+{
+  auto registry = metrics_registry();
+  auto &counter = registry.add_counter("test_total", "Test.");
+  EXPECT_EQ(&registry.add_counter("test_total", "Other."), &counter);
+  EXPECT_THROW(registry.add_gauge("test_total", "Test."),
+               std::bad_variant_access);
+
+  auto bounds = metrics_registry::exponential_buckets(1, 2, 4);
+  EXPECT_EQ(bounds, (std::vector<double>{1, 2, 4, 8}));
+}
+
+TEST(MetricsTest, ExposeTest)
+{
+  auto registry = metrics_registry();
+  registry.add_counter("test_total", "A counter.").add(3);
+  registry.add_gauge("test_gauge", "A\\gauge\n.").set(0.5);
+  auto &histogram = registry.add_histogram("test_seconds", "A histogram.",
+                                           {0.25, 1});
+  histogram.observe(0.1);
+  histogram.observe(2.0);
+
+  EXPECT_EQ(registry.expose(), "# HELP test_total A counter.\n"
+                               "# TYPE test_total counter\n"
+                               "test_total 3\n"
+                               "# HELP test_gauge A\\\\gauge\\n.\n"
+                               "# TYPE test_gauge gauge\n"
+                               "test_gauge 0.5\n"
+                               "# HELP test_seconds A histogram.\n"
+                               "# TYPE test_seconds histogram\n"
+                               "test_seconds_bucket{le=\"0.25\"} 1\n"
+                               "test_seconds_bucket{le=\"1\"} 1\n"
+                               "test_seconds_bucket{le=\"+Inf\"} 2\n"
+                               "test_seconds_sum 2.1\n"
+                               "test_seconds_count 2\n");
+}
+
+TEST(MetricsTest, LoopMetricsTest)
+{
+  auto ctx = async_context();
+  auto registry = metrics_registry();
+  auto loop = loop_metrics(registry, "test_loop");
+  loop.start(ctx, milliseconds(1));
+
+  auto &lateness = registry.add_histogram("test_loop_timer_lateness_seconds",
+                                          "");
+  auto &utilization = registry.add_gauge("test_loop_utilization", "");
+
+  // Spin the loop so that it is busy between samples.
+  const auto deadline = steady_clock::now() + seconds(2);
+  while (lateness.count() < 5 && steady_clock::now() < deadline)
+    ctx.timers.resolve();
+  loop.stop();
+
+  EXPECT_GE(lateness.count(), 5);
+  EXPECT_GT(utilization.value(), 0.0);
+  EXPECT_LE(utilization.value(), 1.0);
+}
+
+struct tcp_counted_service : public async_tcp_service<tcp_counted_service> {
+  using Base = async_tcp_service<tcp_counted_service>;
+
+  template <typename T>
+  tcp_counted_service(metrics_registry &registry, socket_address<T> address)
+      : Base(address), metrics{registry}
+  {}
+
+  tcp_metrics metrics;
+
+  auto service(async_context &ctx, const socket_dialog &socket,
+               std::shared_ptr<read_context> rctx,
+               std::span<const std::byte> buf) -> void
+  {
+    if (rctx)
+      submit_recv(ctx, socket, std::move(rctx));
+  }
+};
+
+/** @brief Reads one HTTP response with a Content-Length. */
+static auto read_response(const io::socket::socket_handle &sock) -> std::string
+{
+  using namespace io::socket;
+  auto response = std::string();
+  auto buf = std::array<char, 1024>();
+  auto msg = socket_message{.buffers = buf};
+  while (true)
+  {
+    auto end = response.find("\r\n\r\n");
+    if (end != std::string::npos)
+    {
+      auto at = response.find("Content-Length: ");
+      auto length = std::stoul(response.substr(at + 16));
+      if (response.size() >= end + 4 + length)
+        return response;
+    }
+
+    auto len = io::recvmsg(sock, msg, 0);
+    if (len <= 0)
+      return response;
+    response.append(buf.data(), static_cast<std::size_t>(len));
+  }
+}
+
+TEST_F(AsyncTcpServiceTest, TcpMetricsTest)
+{
+  using namespace io::socket;
+  auto registry = metrics_registry();
+  auto service = tcp_counted_service(registry, addr_v4);
+  ASSERT_FALSE(service.start(*ctx));
+
+  {
+    auto sock = socket_handle(AF_INET, SOCK_STREAM, 0);
+    ASSERT_EQ(io::connect(sock, addr_v4), 0);
+    ASSERT_GT(ctx->poller.wait_for(2000), 0);
+
+    auto buf = std::array<char, 5>{'h', 'e', 'l', 'l', 'o'};
+    ASSERT_EQ(io::sendmsg(sock, socket_message{.buffers = buf}, 0), 5);
+    ASSERT_GT(ctx->poller.wait_for(2000), 0);
+  }
+  while (!service.metrics.closed.value())
+    ASSERT_GT(ctx->poller.wait_for(2000), 0);
+
+  EXPECT_EQ(service.metrics.accepted.value(), 1);
+  EXPECT_EQ(service.metrics.closed.value(), 1);
+  EXPECT_EQ(service.metrics.bytes.value(), 5);
+  EXPECT_NE(registry.expose().find("cppnet_tcp_received_bytes_total 5\n"),
+            std::string::npos);
+
+  service.signal_handler(ctx->terminate);
+  while (ctx->poller.wait_for(50));
+}
+
+TEST_F(AsyncTcpServiceTest, ExporterTest)
+{
+  using namespace io::socket;
+  auto registry = metrics_registry();
+  registry.add_counter("test_total", "Test.").add(7);
+  auto exporter = metrics_exporter(registry, addr_v4);
+  ASSERT_FALSE(exporter.start(*ctx));
+
+  auto sock = socket_handle(AF_INET, SOCK_STREAM, 0);
+  ASSERT_EQ(io::connect(sock, addr_v4), 0);
+  ASSERT_GT(ctx->poller.wait_for(2000), 0);
+
+  auto request = [&](std::string_view text) {
+    auto msg = socket_message{.buffers = std::span(text.data(), text.size())};
+    EXPECT_EQ(io::sendmsg(sock, msg, 0), static_cast<long>(text.size()));
+    while (ctx->poller.wait_for(50));
+    return read_response(sock);
+  };
+
+  // Headers that arrive in pieces are reassembled.
+  auto first = std::string_view("GET /metrics HTTP/1.1\r\n");
+  auto msg = socket_message{.buffers = std::span(first.data(), first.size())};
+  ASSERT_EQ(io::sendmsg(sock, msg, 0), static_cast<long>(first.size()));
+  ASSERT_GT(ctx->poller.wait_for(2000), 0);
+
+  auto response = request("Host: localhost\r\n\r\n");
+  EXPECT_TRUE(response.starts_with("HTTP/1.1 200 OK\r\n"));
+  EXPECT_NE(response.find("Content-Type: text/plain; version=0.0.4"),
+            std::string::npos);
+  EXPECT_TRUE(response.ends_with("\r\n\r\n" + registry.expose()));
+
+  // The connection is kept alive for the next scrape.
+  response = request("GET /metrics?x=1 HTTP/1.1\r\n\r\n");
+  EXPECT_TRUE(response.ends_with("test_total 7\n"));
+
+  response = request("GET / HTTP/1.1\r\n\r\n");
+  EXPECT_TRUE(response.starts_with("HTTP/1.1 404 Not Found\r\n"));
+
+  response = request("POST /metrics HTTP/1.1\r\n\r\n");
+  EXPECT_TRUE(response.starts_with("HTTP/1.1 405 Method Not Allowed\r\n"));
+
+  exporter.signal_handler(ctx->terminate);
+  while (ctx->poller.wait_for(50));
+}
+
+TEST(MetricsExporterTest, RespondTest)
+{
+  auto registry = metrics_registry();
+  auto address = io::socket::socket_address<sockaddr_in>();
+  const auto exporter = metrics_exporter(registry, address);
+
+  EXPECT_EQ(exporter.respond("GET /metrics HTTP/1.1\r\n\r\n"),
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+            "Content-Length: 0\r\n\r\n");
+  EXPECT_TRUE(exporter.respond("GET\r\n\r\n").starts_with("HTTP/1.1 404"));
+  EXPECT_TRUE(exporter.respond("").starts_with("HTTP/1.1 405"));
+}
+// NOLINTEND
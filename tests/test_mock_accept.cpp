@@ -16,8 +16,17 @@
 #include "test_tcp_fixture.hpp"
 
 static int error = 0;
+static int passed = 0;
 int accept(int __fd, struct sockaddr *addr, socklen_t *len)
 {
+  if (passed > 0)
+  {
+    auto accepted = ::accept4(__fd, addr, len, 0);
+    if (accepted != -1)
+      --passed;
+    return accepted;
+  }
+
   errno = static_cast<int>(std::errc::bad_file_descriptor);
   error = errno;
   return -1;
@@ -38,4 +47,46 @@ TEST_F(AsyncTcpServiceTest, AcceptError)
   }
   EXPECT_GT(n, 0);
 }
+
+struct tcp_batch_service : public async_tcp_service<tcp_batch_service> {
+  using Base = async_tcp_service<tcp_batch_service>;
+
+  static constexpr std::size_t accept_batch = 4;
+
+  template <typename T>
+  explicit tcp_batch_service(socket_address<T> address) : Base(address)
+  {}
+
+  int accepted = 0;
+
+  auto service(async_context &ctx, const socket_dialog &socket,
+               std::shared_ptr<read_context> rctx,
+               std::span<const std::byte> buf) -> void
+  {
+    if (rctx && buf.empty())
+      ++accepted;
+  }
+};
+
+TEST_F(AsyncTcpServiceTest, BatchAcceptError)
+{
+  using namespace io::socket;
+  auto service = tcp_batch_service(addr_v4);
+  error = 0;
+  passed = 1;
+  ASSERT_FALSE(service.start(*ctx));
+
+  auto first = socket_handle(AF_INET, SOCK_STREAM, 0);
+  auto second = socket_handle(AF_INET, SOCK_STREAM, 0);
+  ASSERT_EQ(io::connect(first, addr_v4), 0);
+  ASSERT_EQ(io::connect(second, addr_v4), 0);
+
+  // The first accept succeeds and the batched accept after it fails.
+  while (ctx->poller.wait_for(50));
+  EXPECT_EQ(service.accepted, 1);
+  EXPECT_EQ(error, static_cast<int>(std::errc::bad_file_descriptor));
+
+  service.signal_handler(ctx->terminate);
+  while (ctx->poller.wait_for(50));
+}
 // NOLINTEND
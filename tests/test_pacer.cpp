@@ -0,0 +1,143 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// NOLINTBEGIN
+#include "net/service/pacer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+
+#include <thread>
+#include <vector>
+
+using namespace net::service;
+using namespace std::chrono;
+
+class PacerTest : public ::testing::Test {
+protected:
+  // 100KB/s with 1KB bursts: one 1KB send every 10ms.
+  static constexpr std::size_t RATE = 100'000;
+  static constexpr std::size_t BURST = 1000;
+
+  auto run_until(const auto &done) -> void
+  {
+    const auto deadline = steady_clock::now() + seconds(2);
+    while (!done() && steady_clock::now() < deadline)
+    {
+      auto next = ctx.timers.resolve();
+      std::this_thread::sleep_for(
+          std::min(duration_cast<microseconds>(next), microseconds(1000)));
+    }
+  }
+
+  async_context ctx;
+};
+
+TEST_F(PacerTest, BurstTest)
+{
+  auto pacing = pacer(RATE, BURST);
+  auto sent = std::vector<int>();
+  for (auto i = 0; i < 3; ++i)
+    pacing.send(ctx, 1, BURST, [&, i] { sent.push_back(i); });
+
+  // Only the burst is sent immediately. The rest is queued, not dropped.
+  EXPECT_EQ(sent, std::vector<int>{0});
+  EXPECT_EQ(pacing.pending(), 2);
+
+  const auto start = steady_clock::now();
+  run_until([&] { return sent.size() == 3; });
+  EXPECT_EQ(sent, (std::vector<int>{0, 1, 2}));
+  EXPECT_GE(steady_clock::now() - start, milliseconds(19));
+  EXPECT_EQ(pacing.pending(), 0);
+}
+
+TEST_F(PacerTest, FlowTest)
+{
+  auto pacing = pacer(RATE, BURST);
+  auto sent = std::vector<int>();
+  pacing.send(ctx, 1, BURST, [&] { sent.push_back(1); });
+  pacing.send(ctx, 1, BURST, [&] { sent.push_back(2); });
+
+  // Each flow has its own bucket.
+  pacing.send(ctx, 2, BURST, [&] { sent.push_back(3); });
+  EXPECT_EQ(sent, (std::vector<int>{1, 3}));
+  EXPECT_EQ(pacing.flows(), 2);
+
+  run_until([&] { return sent.size() == 3; });
+  EXPECT_EQ(sent, (std::vector<int>{1, 3, 2}));
+
+  // Flows are forgotten once their buckets refill.
+  run_until([&] { return pacing.flows() == 0; });
+  EXPECT_EQ(pacing.flows(), 0);
+}
+
+TEST_F(PacerTest, ForgetTest)
+{
+  auto pacing = pacer(RATE, BURST);
+  auto sent = std::vector<int>();
+  pacing.send(ctx, 1, BURST, [&] { sent.push_back(1); });
+  pacing.send(ctx, 1, BURST, [&] { sent.push_back(2); });
+
+  // A forgotten flow's queued sends are dropped...
+  pacing.forget(1);
+  EXPECT_EQ(pacing.pending(), 0);
+  EXPECT_EQ(pacing.flows(), 0);
+
+  // ...and a new flow with the same identifier starts with a full bucket.
+  pacing.send(ctx, 1, BURST, [&] { sent.push_back(3); });
+  EXPECT_EQ(sent, (std::vector<int>{1, 3}));
+
+  run_until([&] { return pacing.flows() == 0; });
+  EXPECT_EQ(sent, (std::vector<int>{1, 3}));
+}
+
+TEST_F(PacerTest, LargeSendTest)
+{
+  auto pacing = pacer(RATE, BURST);
+  auto sent = 0;
+  pacing.send(ctx, 1, BURST / 2, [&] { ++sent; });
+
+  // A send larger than the burst waits for a full bucket, then goes into
+  // debt, so the next send waits for the debt to be repaid.
+  pacing.send(ctx, 1, 2 * BURST, [&] { ++sent; });
+  pacing.send(ctx, 1, 1, [&] { ++sent; });
+  EXPECT_EQ(sent, 1);
+
+  const auto start = steady_clock::now();
+  run_until([&] { return sent == 3; });
+  EXPECT_EQ(sent, 3);
+  EXPECT_GE(steady_clock::now() - start, milliseconds(14));
+}
+
+TEST_F(PacerTest, FlowOfTest)
+{
+  using socket_address = pacer::socket_address;
+  auto ipv4 = [](std::uint32_t host, std::uint16_t port) {
+    auto addr = socket_address();
+    auto *ipv4 = reinterpret_cast<sockaddr_in *>(&(*addr));
+    ipv4->sin_family = AF_INET;
+    ipv4->sin_addr.s_addr = htonl(host);
+    ipv4->sin_port = htons(port);
+    return addr;
+  };
+
+  EXPECT_EQ(pacer::flow_of(ipv4(INADDR_LOOPBACK, 1)),
+            pacer::flow_of(ipv4(INADDR_LOOPBACK, 1)));
+  EXPECT_NE(pacer::flow_of(ipv4(INADDR_LOOPBACK, 1)),
+            pacer::flow_of(ipv4(INADDR_LOOPBACK, 2)));
+  EXPECT_NE(pacer::flow_of(ipv4(INADDR_LOOPBACK, 1)),
+            pacer::flow_of(ipv4(INADDR_LOOPBACK + 1, 1)));
+}
+// NOLINTEND
@@ -0,0 +1,237 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// NOLINTBEGIN
+#include "net/service/pipeline.hpp"
+#include "test_tcp_fixture.hpp"
+#include "test_udp_fixture.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace net::service;
+
+/** @brief Records that it was called, then forwards. */
+struct trace {
+  char name;
+  std::string *calls;
+
+  auto operator()(auto &&next, auto &&...args) -> void
+  {
+    calls->push_back(name);
+    next(std::forward<decltype(args)>(args)...);
+  }
+};
+
+/** @brief Doubles the value. */
+struct twice {
+  auto operator()(auto &&next, int value) -> void { next(value * 2); }
+};
+
+/** @brief Short-circuits negative values. */
+struct positive {
+  auto operator()(auto &&next, int value) -> void
+  {
+    if (value >= 0)
+      next(value);
+  }
+};
+
+TEST(PipelineTest, OrderTest)
+{
+  auto calls = std::string();
+  auto chain = pipeline<trace, trace, trace>(trace{'a', &calls},
+                                             trace{'b', &calls},
+                                             trace{'c', &calls});
+  auto last = 0;
+  chain([&](int value, int other) { last = value + other; }, 1, 2);
+
+  EXPECT_EQ(calls, "abc");
+  EXPECT_EQ(last, 3);
+  EXPECT_EQ(chain.get<1>().name, 'b');
+}
+
+TEST(PipelineTest, TransformTest)
+{
+  auto chain = pipeline<twice, positive, twice>();
+  auto values = std::vector<int>();
+  auto last = [&](int value) { values.push_back(value); };
+
+  chain(last, 3);
+  chain(last, -1);
+  chain(last, 0);
+
+  EXPECT_EQ(values, (std::vector<int>{12, 0}));
+}
+
+TEST(PipelineTest, EmptyTest)
+{
+  auto chain = pipeline<>();
+  auto last = 0;
+  chain([&](int value) { last = value; }, 7);
+  EXPECT_EQ(last, 7);
+
+  static_assert(is_pipeline_v<pipeline<twice>>);
+  static_assert(!is_pipeline_v<twice>);
+}
+
+/** @brief Strips a one byte prefix from every read. */
+struct strip_prefix {
+  auto operator()(auto &&next, auto &service, auto &ctx, const auto &socket,
+                  auto rctx, std::span<const std::byte> buf) -> void
+  {
+    if (!buf.empty())
+      buf = buf.subspan(1);
+    next(service, ctx, socket, std::move(rctx), buf);
+  }
+};
+
+/** @brief Drops reads that start with '#', and keeps reading. */
+struct drop_comments {
+  int dropped = 0;
+
+  auto operator()(auto &&next, auto &service, auto &ctx, const auto &socket,
+                  auto rctx, std::span<const std::byte> buf) -> void
+  {
+    if (rctx && !buf.empty() && buf.front() == std::byte{'#'})
+    {
+      ++dropped;
+      return service.submit_recv(ctx, socket, std::move(rctx));
+    }
+    next(service, ctx, socket, std::move(rctx), buf);
+  }
+};
+
+struct tcp_piped_service : public async_tcp_service<tcp_piped_service> {
+  using Base = async_tcp_service<tcp_piped_service>;
+
+  template <typename T>
+  explicit tcp_piped_service(socket_address<T> address) : Base(address)
+  {}
+
+  pipeline<drop_comments, strip_prefix> middleware;
+
+  auto service(async_context &ctx, const socket_dialog &socket,
+               std::shared_ptr<read_context> rctx,
+               std::span<const std::byte> buf) -> void
+  {
+    using namespace stdexec;
+    if (!rctx)
+      return;
+
+    auto msg = io::socket::socket_message<>{.buffers = buf};
+    sender auto sendmsg = io::sendmsg(socket, msg, 0) |
+                          then([&, socket, rctx](auto &&len) {
+                            submit_recv(ctx, socket, rctx);
+                          }) |
+                          upon_error([](auto &&error) {});
+    ctx.scope.spawn(std::move(sendmsg));
+  }
+};
+
+TEST_F(AsyncTcpServiceTest, PipelineTest)
+{
+  using namespace io::socket;
+  auto service = tcp_piped_service(addr_v4);
+  ASSERT_FALSE(service.start(*ctx));
+
+  auto sock = socket_handle(AF_INET, SOCK_STREAM, 0);
+  ASSERT_EQ(io::connect(sock, addr_v4), 0);
+  ASSERT_GT(ctx->poller.wait_for(2000), 0);
+
+  auto request = [&](std::string_view text) {
+    auto msg = socket_message{.buffers = std::span(text.data(), text.size())};
+    EXPECT_EQ(io::sendmsg(sock, msg, 0), static_cast<long>(text.size()));
+    while (ctx->poller.wait_for(50));
+
+    auto buf = std::array<char, 64>();
+    auto reply = socket_message{.buffers = buf};
+    auto len = io::recvmsg(sock, reply, MSG_DONTWAIT);
+    return len > 0 ? std::string(buf.data(), static_cast<std::size_t>(len))
+                   : std::string();
+  };
+
+  EXPECT_EQ(request(">hello"), "hello");
+  EXPECT_EQ(request("#comment"), "");
+  EXPECT_EQ(request(">world"), "world");
+  EXPECT_EQ(service.middleware.get<drop_comments>().dropped, 1);
+
+  service.signal_handler(ctx->terminate);
+  while (ctx->poller.wait_for(50));
+}
+
+struct udp_piped_service : public async_udp_service<udp_piped_service> {
+  using Base = async_udp_service<udp_piped_service>;
+
+  template <typename T>
+  explicit udp_piped_service(socket_address<T> address) : Base(address)
+  {}
+
+  pipeline<drop_comments, strip_prefix> middleware;
+
+  auto service(async_context &ctx, const socket_dialog &socket,
+               std::shared_ptr<read_context> rctx,
+               std::span<const std::byte> buf) -> void
+  {
+    using namespace io::socket;
+    using namespace stdexec;
+    if (!rctx)
+      return;
+
+    auto address = *rctx->msg.address;
+    if (address->sin6_family == AF_INET)
+    {
+      const auto *ptr =
+          reinterpret_cast<struct sockaddr *>(std::addressof(*address));
+      address = socket_address<sockaddr_in>(ptr);
+    }
+    auto msg = socket_message<>{.address = address, .buffers = buf};
+    sender auto sendmsg = io::sendmsg(socket, msg, 0) |
+                          then([&, socket, rctx](auto &&len) {
+                            submit_recv(ctx, socket, rctx);
+                          }) |
+                          upon_error([](auto &&error) {});
+    ctx.scope.spawn(std::move(sendmsg));
+  }
+};
+
+TEST_F(AsyncUDPServiceTest, PipelineTest)
+{
+  using namespace io::socket;
+  auto service = udp_piped_service(addr_v4);
+  ASSERT_FALSE(service.start(*ctx));
+
+  auto sock = socket_handle(AF_INET, SOCK_DGRAM, 0);
+  auto request = [&](std::string_view text) {
+    auto msg = socket_message<sockaddr_in>{
+        .address = {addr_v4}, .buffers = std::span(text.data(), text.size())};
+    EXPECT_EQ(io::sendmsg(sock, msg, 0), static_cast<long>(text.size()));
+    while (ctx->poller.wait_for(50));
+
+    auto buf = std::array<char, 64>();
+    auto reply = socket_message{.buffers = buf};
+    auto len = io::recvmsg(sock, reply, MSG_DONTWAIT);
+    return len > 0 ? std::string(buf.data(), static_cast<std::size_t>(len))
+                   : std::string();
+  };
+
+  EXPECT_EQ(request(">hello"), "hello");
+  EXPECT_EQ(request("#comment"), "");
+  EXPECT_EQ(request(">world"), "world");
+  EXPECT_EQ(service.middleware.get<drop_comments>().dropped, 1);
+
+  service.signal_handler(ctx->terminate);
+  while (ctx->poller.wait_for(50));
+}
+// NOLINTEND
@@ -0,0 +1,116 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// NOLINTBEGIN
+#include "net/service/request_lifecycle.hpp"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+using namespace net::service;
+using namespace std::chrono;
+
+/** @brief Runs one request through every stamp. */
+static auto run_request(request_lifecycle &lifecycle,
+                        request_lifecycle::stamps &stamps,
+                        milliseconds service = {}) -> void
+{
+  lifecycle.readable(stamps);
+  lifecycle.entered(stamps);
+  std::this_thread::sleep_for(service);
+  lifecycle.submitted(stamps);
+  lifecycle.exited(stamps);
+  lifecycle.completed(stamps);
+}
+
+TEST(RequestLifecycleTest, PhaseTest)
+{
+  using enum request_lifecycle::phase;
+  auto lifecycle = request_lifecycle(1);
+  auto stamps = request_lifecycle::stamps{};
+
+  lifecycle.accepted(stamps);
+  std::this_thread::sleep_for(milliseconds(2));
+  run_request(lifecycle, stamps, milliseconds(2));
+
+  for (auto phase : {first_byte, dispatch, service, submit, send, total})
+    EXPECT_EQ(lifecycle.histogram(phase).count(), 1);
+
+  EXPECT_GE(lifecycle.histogram(first_byte).percentile(100), milliseconds(2));
+  EXPECT_GE(lifecycle.histogram(service).percentile(100), milliseconds(2));
+  EXPECT_GE(lifecycle.histogram(total).percentile(100), milliseconds(2));
+  EXPECT_FALSE(stamps.sampled);
+
+  // Only the first request of a connection times first_byte.
+  run_request(lifecycle, stamps);
+  EXPECT_EQ(lifecycle.histogram(first_byte).count(), 1);
+  EXPECT_EQ(lifecycle.histogram(total).count(), 2);
+
+  lifecycle.reset();
+  EXPECT_EQ(lifecycle.histogram(total).count(), 0);
+}
+
+TEST(RequestLifecycleTest, SampleTest)
+{
+  using enum request_lifecycle::phase;
+  auto lifecycle = request_lifecycle(10);
+  auto stamps = request_lifecycle::stamps{};
+
+  for (int i = 0; i < 100; ++i)
+  {
+    lifecycle.accepted(stamps);
+    run_request(lifecycle, stamps);
+  }
+
+  EXPECT_EQ(lifecycle.histogram(first_byte).count(), 10);
+  EXPECT_EQ(lifecycle.histogram(service).count(), 10);
+  EXPECT_EQ(lifecycle.histogram(total).count(), 10);
+}
+
+TEST(RequestLifecycleTest, OutstandingTest)
+{
+  using enum request_lifecycle::phase;
+  auto lifecycle = request_lifecycle(1);
+  auto stamps = request_lifecycle::stamps{};
+
+  lifecycle.readable(stamps);
+  const auto readable = stamps.readable;
+  std::this_thread::sleep_for(milliseconds(2));
+
+  // A read before the sampled request completes keeps its stamps.
+  lifecycle.readable(stamps);
+  EXPECT_TRUE(stamps.sampled);
+  EXPECT_EQ(stamps.readable, readable);
+
+  lifecycle.entered(stamps);
+  lifecycle.submitted(stamps);
+  lifecycle.exited(stamps);
+  lifecycle.completed(stamps);
+  EXPECT_EQ(lifecycle.histogram(total).count(), 1);
+  EXPECT_GE(lifecycle.histogram(total).percentile(100), milliseconds(2));
+}
+
+TEST(RequestLifecycleTest, DisabledTest)
+{
+  using enum request_lifecycle::phase;
+  auto lifecycle = request_lifecycle(0);
+  auto stamps = request_lifecycle::stamps{};
+
+  lifecycle.accepted(stamps);
+  run_request(lifecycle, stamps);
+  EXPECT_EQ(lifecycle.histogram(first_byte).count(), 0);
+  EXPECT_EQ(lifecycle.histogram(total).count(), 0);
+}
+// NOLINTEND
@@ -0,0 +1,122 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// NOLINTBEGIN
+#include "net/service/session_table.hpp"
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+
+using namespace net::service;
+using namespace std::chrono;
+
+class SessionTableTest : public ::testing::Test {
+protected:
+  using table_type = session_table<int>;
+  using socket_address = table_type::socket_address;
+
+  static auto ipv4(std::uint32_t host, std::uint16_t port) -> socket_address
+  {
+    // Received IPv4 peers are stored in sockaddr_in6 sized addresses.
+    auto addr = socket_address();
+    auto *ipv4 = reinterpret_cast<sockaddr_in *>(&(*addr));
+    ipv4->sin_family = AF_INET;
+    ipv4->sin_addr.s_addr = htonl(host);
+    ipv4->sin_port = htons(port);
+    return addr;
+  }
+
+  static auto ipv6(std::uint16_t port) -> socket_address
+  {
+    auto addr = socket_address();
+    addr->sin6_family = AF_INET6;
+    addr->sin6_addr = in6addr_loopback;
+    addr->sin6_port = htons(port);
+    return addr;
+  }
+
+  table_type::timestamp now = net::timers::clock::now();
+};
+
+TEST_F(SessionTableTest, GetTest)
+{
+  auto sessions = table_type(seconds(1));
+  EXPECT_EQ(sessions.find(ipv4(INADDR_LOOPBACK, 1)), nullptr);
+
+  sessions.get(ipv4(INADDR_LOOPBACK, 1), now) = 1;
+  sessions.get(ipv4(INADDR_LOOPBACK, 2), now) = 2;
+  sessions.get(ipv6(1), now) = 3;
+  EXPECT_EQ(sessions.size(), 3);
+
+  // Peers are keyed by address, port and family.
+  EXPECT_EQ(sessions.get(ipv4(INADDR_LOOPBACK, 1), now), 1);
+  ASSERT_NE(sessions.find(ipv4(INADDR_LOOPBACK, 2)), nullptr);
+  EXPECT_EQ(*sessions.find(ipv4(INADDR_LOOPBACK, 2)), 2);
+  EXPECT_EQ(*sessions.find(ipv6(1)), 3);
+  EXPECT_EQ(sessions.size(), 3);
+}
+
+TEST_F(SessionTableTest, EraseTest)
+{
+  constexpr auto PEERS = 10'000U;
+  auto sessions = table_type(seconds(1));
+  for (auto i = 0U; i < PEERS; ++i)
+    sessions.get(ipv4(i, 1), now) = static_cast<int>(i);
+
+  for (auto i = 0U; i < PEERS; i += 2)
+    EXPECT_TRUE(sessions.erase(ipv4(i, 1)));
+  EXPECT_FALSE(sessions.erase(ipv4(0, 1)));
+  EXPECT_EQ(sessions.size(), PEERS / 2);
+
+  // Erasing must not break the probe sequences of the other peers.
+  for (auto i = 0U; i < PEERS; ++i)
+  {
+    auto *state = sessions.find(ipv4(i, 1));
+    if (i % 2)
+    {
+      ASSERT_NE(state, nullptr);
+      EXPECT_EQ(*state, static_cast<int>(i));
+    }
+    else
+    {
+      EXPECT_EQ(state, nullptr);
+    }
+  }
+}
+
+TEST_F(SessionTableTest, ExpireTest)
+{
+  auto sessions = table_type(seconds(1));
+  for (auto i = 0U; i < 100; ++i)
+    sessions.get(ipv4(i, 1), now) = static_cast<int>(i);
+
+  // Only the peers that are active later are kept.
+  for (auto i = 0U; i < 100; i += 3)
+    sessions.get(ipv4(i, 1), now + milliseconds(800));
+
+  EXPECT_EQ(sessions.expire(now + milliseconds(900)), 0);
+  EXPECT_EQ(sessions.expire(now + milliseconds(1500)), 66);
+  EXPECT_EQ(sessions.size(), 34);
+  for (auto i = 0U; i < 100; ++i)
+  {
+    auto *state = sessions.find(ipv4(i, 1));
+    EXPECT_EQ(state != nullptr, i % 3 == 0);
+    if (state)
+    {
+      EXPECT_EQ(*state, static_cast<int>(i));
+    }
+  }
+}
+// NOLINTEND
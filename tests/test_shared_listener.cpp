@@ -0,0 +1,170 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// NOLINTBEGIN
+#include "net/service/shared_listener.hpp"
+#include "test_tcp_fixture.hpp"
+
+struct tcp_shared_service : public async_tcp_service<tcp_shared_service> {
+  using Base = async_tcp_service<tcp_shared_service>;
+
+  explicit tcp_shared_service(shared_listener &listener) : Base(listener) {}
+
+  std::size_t accepted = 0;
+
+  auto service(async_context &ctx, const socket_dialog &socket,
+               std::shared_ptr<read_context> rctx,
+               std::span<const std::byte> buf) -> void
+  {
+    if (!rctx)
+      return;
+
+    if (buf.empty())
+      ++accepted;
+    submit_recv(ctx, socket, std::move(rctx));
+  }
+};
+
+class SharedListenerTest : public AsyncTcpServiceTest {
+protected:
+  auto connect() -> io::socket::socket_handle
+  {
+    using namespace io::socket;
+    auto sock = socket_handle(AF_INET, SOCK_STREAM, 0);
+    EXPECT_EQ(io::connect(sock, addr_v4), 0);
+    return sock;
+  }
+
+  auto drain(async_context &ctx) -> void
+  {
+    auto n = 0UL;
+    while (ctx.poller.wait_for(50))
+    {
+      ASSERT_LE(n++, 4);
+    }
+  }
+};
+
+TEST_F(SharedListenerTest, RoundRobinTest)
+{
+  auto listener = shared_listener(addr_v4);
+  auto ctx2 = async_context();
+  auto first = tcp_shared_service(listener);
+  auto second = tcp_shared_service(listener);
+  ASSERT_FALSE(first.start(*ctx));
+  ASSERT_FALSE(second.start(ctx2));
+  EXPECT_EQ(listener.address()->sin6_port, addr_v4->sin_port);
+
+  {
+    // The first service to join holds the accept token.
+    auto sock1 = connect();
+    while (!first.accepted)
+      ASSERT_GT(ctx->poller.wait_for(2000), 0);
+
+    // Accepting passes the token to the second context.
+    ctx2.timers.resolve();
+    auto sock2 = connect();
+    while (!second.accepted)
+      ASSERT_GT(ctx2.poller.wait_for(2000), 0);
+
+    // The first context is not woken by the second connection.
+    while (ctx->poller.wait_for(0));
+    EXPECT_EQ(first.accepted, 1);
+
+    ctx->timers.resolve();
+    auto sock3 = connect();
+    while (first.accepted < 2)
+      ASSERT_GT(ctx->poller.wait_for(2000), 0);
+    EXPECT_EQ(second.accepted, 1);
+
+    first.signal_handler(ctx->terminate);
+    second.signal_handler(ctx2.terminate);
+  }
+
+  ctx2.timers.resolve();
+  drain(ctx2);
+  ctx->signal(ctx->terminate);
+  drain(*ctx);
+}
+
+TEST_F(SharedListenerTest, BusyHolderTest)
+{
+  using namespace std::chrono;
+  auto listener = shared_listener(addr_v4);
+  auto ctx2 = async_context();
+  auto first = tcp_shared_service(listener);
+  auto second = tcp_shared_service(listener);
+  ASSERT_FALSE(first.start(*ctx));
+  ASSERT_FALSE(second.start(ctx2));
+
+  {
+    auto sock1 = connect();
+    while (!first.accepted)
+      ASSERT_GT(ctx->poller.wait_for(2000), 0);
+
+    // The token goes to the second context, but its event loop is never
+    // driven, as if it were busy. The first context takes the token back
+    // once the handoff times out.
+    auto sock2 = connect();
+    const auto deadline = steady_clock::now() + seconds(2);
+    while (first.accepted < 2 && steady_clock::now() < deadline)
+    {
+      ctx->timers.resolve();
+      ctx->poller.wait_for(1);
+    }
+    EXPECT_EQ(first.accepted, 2);
+
+    // The busy context ignores the wakeup for the handoff it missed.
+    ctx2.timers.resolve();
+    while (ctx2.poller.wait_for(0));
+    EXPECT_EQ(second.accepted, 0);
+
+    first.signal_handler(ctx->terminate);
+    second.signal_handler(ctx2.terminate);
+  }
+
+  ctx2.timers.resolve();
+  drain(ctx2);
+  ctx->signal(ctx->terminate);
+  drain(*ctx);
+}
+
+TEST_F(SharedListenerTest, LeaveTest)
+{
+  auto listener = shared_listener(addr_v4);
+  auto ctx2 = async_context();
+  auto first = tcp_shared_service(listener);
+  auto second = tcp_shared_service(listener);
+  ASSERT_FALSE(first.start(*ctx));
+  ASSERT_FALSE(second.start(ctx2));
+
+  // Stopping the token holder fails its pending accept and passes the
+  // token on without closing the shared socket.
+  first.signal_handler(ctx->terminate);
+  ASSERT_GT(ctx->poller.wait_for(2000), 0);
+  ctx2.timers.resolve();
+
+  {
+    auto sock = connect();
+    while (!second.accepted)
+      ASSERT_GT(ctx2.poller.wait_for(2000), 0);
+    EXPECT_EQ(first.accepted, 0);
+    second.signal_handler(ctx2.terminate);
+  }
+
+  drain(ctx2);
+  ctx->signal(ctx->terminate);
+  drain(*ctx);
+}
+// NOLINTEND
@@ -0,0 +1,244 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// NOLINTBEGIN
+#include "net/service/tcp_multiplexer.hpp"
+#include "test_tcp_client_fixture.hpp"
+
+#include <atomic>
+#include <string>
+#include <string_view>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+struct tcp_sink_service : public async_tcp_service<tcp_sink_service> {
+  using Base = async_tcp_service<tcp_sink_service>;
+
+  template <typename T>
+  explicit tcp_sink_service(socket_address<T> address) : Base(address)
+  {}
+
+  auto service(async_context &ctx, const socket_dialog &socket,
+               std::shared_ptr<read_context> rctx,
+               std::span<const std::byte> buf) -> void
+  {
+    submit_recv(ctx, socket, std::move(rctx));
+  }
+};
+
+struct tcp_reset_service : public async_tcp_service<tcp_reset_service> {
+  using Base = async_tcp_service<tcp_reset_service>;
+
+  template <typename T>
+  explicit tcp_reset_service(socket_address<T> address) : Base(address)
+  {}
+
+  auto service(async_context &ctx, const socket_dialog &socket,
+               std::shared_ptr<read_context> rctx,
+               std::span<const std::byte> buf) -> void
+  {
+    if (!rctx)
+      return;
+
+    if (buf.empty())
+      return submit_recv(ctx, socket, std::move(rctx));
+
+    // Closing the socket with a zero linger time resets the connection.
+    const auto sockfd =
+        static_cast<io::socket::native_socket_type>(*socket.socket);
+    auto linger = ::linger{.l_onoff = 1, .l_linger = 0};
+    ::setsockopt(sockfd, SOL_SOCKET, SO_LINGER, &linger, sizeof(linger));
+    if (auto unbound = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        unbound >= 0)
+    {
+      ::dup2(unbound, sockfd);
+      ::close(unbound);
+    }
+  }
+};
+
+static auto as_bytes(std::string_view str) -> std::span<const std::byte>
+{
+  return std::as_bytes(std::span(str));
+}
+
+static auto as_string(std::span<const std::byte> buf) -> std::string_view
+{
+  return {reinterpret_cast<const char *>(buf.data()), buf.size()};
+}
+
+class TcpMultiplexerTest : public AsyncTcpEchoClientTests {
+protected:
+  auto stop(context_thread &ctx, tcp_multiplexer &client) -> void
+  {
+    client.close();
+    ctx.signal(ctx.terminate);
+    ctx.state.wait(ctx.STARTED);
+  }
+};
+
+TEST_F(TcpMultiplexerTest, EchoTest)
+{
+  using namespace stdexec;
+
+  auto ctx = context_thread();
+  ctx.start();
+  auto client = tcp_multiplexer(ctx, addr_v4);
+
+  auto res = sync_wait(client.request(as_bytes("Hello, world!")));
+  ASSERT_TRUE(res);
+  auto [response] = *res;
+  EXPECT_EQ(as_string(response), "Hello, world!");
+  EXPECT_EQ(client.in_flight(), 0);
+
+  stop(ctx, client);
+}
+
+TEST_F(TcpMultiplexerTest, PipelineTest)
+{
+  using namespace stdexec;
+
+  auto ctx = context_thread();
+  ctx.start();
+  auto client = tcp_multiplexer(ctx, addr_v4);
+
+  constexpr auto NUM_REQUESTS = 1000;
+  auto payloads = std::vector<std::string>();
+  for (int i = 0; i < NUM_REQUESTS; ++i)
+    payloads.push_back(std::to_string(i));
+
+  auto scope = exec::async_scope();
+  auto matched = std::atomic<int>{0};
+  for (const auto &payload : payloads)
+  {
+    scope.spawn(client.request(as_bytes(payload)) |
+                then([&, &expected = payload](auto response) {
+                  if (as_string(response) == expected)
+                    matched++;
+                }) |
+                upon_error([](auto &&error) {}));
+  }
+  sync_wait(scope.on_empty());
+
+  EXPECT_EQ(matched, NUM_REQUESTS);
+  EXPECT_EQ(client.in_flight(), 0);
+
+  stop(ctx, client);
+}
+
+TEST_F(TcpMultiplexerTest, LargeResponseTest)
+{
+  using namespace stdexec;
+
+  auto ctx = context_thread();
+  ctx.start();
+  auto client = tcp_multiplexer(ctx, addr_v4);
+
+  // The response is larger than the read buffer, which grows to fit it.
+  auto payload = std::string(256UL * 1024, '\0');
+  for (std::size_t i = 0; i < payload.size(); ++i)
+    payload[i] = static_cast<char>('a' + i % 26);
+
+  auto res = sync_wait(client.request(as_bytes(payload)));
+  ASSERT_TRUE(res);
+  auto [response] = *res;
+  EXPECT_TRUE(as_string(response) == payload);
+
+  res = sync_wait(client.request(as_bytes("Hello, world!")));
+  ASSERT_TRUE(res);
+  EXPECT_EQ(as_string(std::get<0>(*res)), "Hello, world!");
+
+  stop(ctx, client);
+}
+
+TEST_F(TcpMultiplexerTest, MaxResponseTest)
+{
+  using namespace stdexec;
+  using namespace std::chrono;
+
+  auto ctx = context_thread();
+  ctx.start();
+  auto client = tcp_multiplexer(ctx, addr_v4, seconds(1), 4);
+
+  // The echoed response is larger than the client accepts.
+  try
+  {
+    sync_wait(client.request(as_bytes("Hello, world!")));
+    ADD_FAILURE() << "The request should have failed.";
+  }
+  catch (const std::system_error &error)
+  {
+    EXPECT_EQ(error.code(), std::errc::message_size);
+  }
+  EXPECT_EQ(client.in_flight(), 0);
+
+  // The next request reconnects.
+  auto res = sync_wait(client.request(as_bytes("abcd")));
+  ASSERT_TRUE(res);
+  auto [response] = *res;
+  EXPECT_EQ(as_string(response), "abcd");
+
+  stop(ctx, client);
+}
+
+TEST_F(TcpMultiplexerTest, TimeoutTest)
+{
+  using namespace stdexec;
+  using namespace std::chrono;
+
+  auto addr = addr_v4;
+  addr->sin_port = htons(ntohs(addr_v4->sin_port) + 1);
+  auto server = basic_context_thread<tcp_sink_service>();
+  server.start(addr);
+
+  auto ctx = context_thread();
+  ctx.start();
+  auto client = tcp_multiplexer(ctx, addr);
+
+  EXPECT_THROW(sync_wait(client.request(as_bytes("a"), milliseconds(10))),
+               std::system_error);
+  EXPECT_EQ(client.in_flight(), 0);
+
+  stop(ctx, client);
+}
+
+TEST_F(TcpMultiplexerTest, ResetTest)
+{
+  using namespace stdexec;
+
+  auto addr = addr_v4;
+  addr->sin_port = htons(ntohs(addr_v4->sin_port) + 1);
+  auto server = basic_context_thread<tcp_reset_service>();
+  server.start(addr);
+
+  auto ctx = context_thread();
+  ctx.start();
+  auto client = tcp_multiplexer(ctx, addr);
+
+  // The errno of the failed read reaches the request.
+  try
+  {
+    sync_wait(client.request(as_bytes("a")));
+    ADD_FAILURE() << "The request should have failed.";
+  }
+  catch (const std::system_error &error)
+  {
+    EXPECT_EQ(error.code(), std::errc::connection_reset);
+  }
+  EXPECT_EQ(client.in_flight(), 0);
+
+  stop(ctx, client);
+}
+// NOLINTEND
@@ -0,0 +1,155 @@
+// Copyright 2025 Kevin Exton
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// NOLINTBEGIN
+#include "net/service/tcp_proxy_service.hpp"
+#include "test_tcp_client_fixture.hpp"
+
+#include <string_view>
+#include <thread>
+
+class TcpProxyServiceTest : public AsyncTcpEchoClientTests {
+protected:
+  auto SetUp() -> void override
+  {
+    AsyncTcpEchoClientTests::SetUp();
+
+    proxy_addr = addr_v4;
+    proxy_addr->sin_port = htons(ntohs(addr_v4->sin_port) + 1);
+    proxy = std::make_unique<basic_context_thread<tcp_proxy_service>>();
+    proxy->start(proxy_addr, addr_v4);
+  }
+
+  socket_address<sockaddr_in> proxy_addr;
+  std::unique_ptr<basic_context_thread<tcp_proxy_service>> proxy;
+};
+
+TEST_F(TcpProxyServiceTest, EchoTest)
+{
+  using namespace io;
+  using namespace io::socket;
+
+  auto sock = socket_handle(AF_INET, SOCK_STREAM, 0);
+  ASSERT_EQ(io::connect(sock, proxy_addr), 0);
+
+  const char *hello = "Hello, world!";
+  auto msg_ = socket_message<sockaddr_in>{.buffers = std::span(hello, 13)};
+  ASSERT_EQ(sendmsg(sock, msg_, 0), 13);
+
+  auto buf = std::array<char, 13>{};
+  for (auto received = 0L; received < 13;)
+  {
+    auto msg = socket_message{.buffers = std::span(buf).subspan(received)};
+    auto len = recvmsg(sock, msg, 0);
+    ASSERT_GT(len, 0);
+    received += len;
+  }
+  EXPECT_EQ(std::string_view(buf.data(), buf.size()), hello);
+
+  // The half-close is forwarded upstream, and the upstream close is
+  // forwarded back.
+  ASSERT_EQ(::shutdown(static_cast<native_socket_type>(sock), SHUT_WR), 0);
+  auto msg = socket_message{.buffers = buf};
+  EXPECT_EQ(recvmsg(sock, msg, 0), 0);
+}
+
+TEST_F(TcpProxyServiceTest, BackpressureTest)
+{
+  using namespace io;
+  using namespace io::socket;
+  using namespace std::chrono;
+  constexpr auto TOTAL = 4UL * 1024 * 1024;
+
+  auto upstream_addr = addr_v4;
+  upstream_addr->sin_port = htons(ntohs(addr_v4->sin_port) + 2);
+  auto listener = socket_handle(AF_INET, SOCK_STREAM, 0);
+  ASSERT_EQ(bind(listener, upstream_addr), 0);
+  ASSERT_EQ(listen(listener, 1), 0);
+
+  auto addr = addr_v4;
+  addr->sin_port = htons(ntohs(addr_v4->sin_port) + 3);
+  auto slow_proxy = basic_context_thread<tcp_proxy_service>();
+  slow_proxy.start(addr, upstream_addr);
+
+  // The upstream starts reading late, so the proxy fills the upstream
+  // socket buffer and has to wait for it to drain.
+  auto received = 0UL;
+  auto in_order = true;
+  auto upstream = std::jthread([&] {
+    auto sockfd =
+        ::accept(static_cast<native_socket_type>(listener), nullptr, nullptr);
+    std::this_thread::sleep_for(milliseconds(100));
+
+    auto buf = std::array<char, 4096>{};
+    auto len = ssize_t{0};
+    while ((len = ::recv(sockfd, buf.data(), buf.size(), 0)) > 0)
+    {
+      for (auto i = 0L; i < len; ++i)
+      {
+        auto expected = static_cast<char>((received + i) % 251);
+        in_order = in_order && buf[i] == expected;
+      }
+      received += len;
+    }
+    ::close(sockfd);
+  });
+
+  auto sock = socket_handle(AF_INET, SOCK_STREAM, 0);
+  ASSERT_EQ(io::connect(sock, addr), 0);
+
+  auto chunk = std::array<char, 4096>{};
+  for (auto sent = 0UL; sent < TOTAL; sent += chunk.size())
+  {
+    for (auto i = 0UL; i < chunk.size(); ++i)
+      chunk[i] = static_cast<char>((sent + i) % 251);
+
+    auto msg_ = socket_message<sockaddr_in>{.buffers = chunk};
+    ASSERT_EQ(sendmsg(sock, msg_, 0), static_cast<ssize_t>(chunk.size()));
+  }
+  ASSERT_EQ(::shutdown(static_cast<native_socket_type>(sock), SHUT_WR), 0);
+
+  // The upstream closes once it has read everything.
+  auto buf = std::array<char, 1>{};
+  auto msg = socket_message{.buffers = buf};
+  EXPECT_EQ(recvmsg(sock, msg, 0), 0);
+
+  upstream.join();
+  EXPECT_EQ(received, TOTAL);
+  EXPECT_TRUE(in_order);
+}
+
+TEST_F(TcpProxyServiceTest, ConnectFailureTest)
+{
+  using namespace io;
+  using namespace io::socket;
+
+  // Nothing listens on the upstream address.
+  auto upstream_addr = addr_v4;
+  upstream_addr->sin_port = htons(ntohs(addr_v4->sin_port) + 4);
+
+  auto addr = addr_v4;
+  addr->sin_port = htons(ntohs(addr_v4->sin_port) + 5);
+  auto dead_proxy = basic_context_thread<tcp_proxy_service>();
+  dead_proxy.start(addr, upstream_addr);
+
+  auto sock = socket_handle(AF_INET, SOCK_STREAM, 0);
+  ASSERT_EQ(io::connect(sock, addr), 0);
+
+  // The accepted connection is shut down once the upstream connect fails.
+  auto buf = std::array<char, 1>{};
+  auto msg = socket_message{.buffers = buf};
+  EXPECT_LE(recvmsg(sock, msg, 0), 0);
+  EXPECT_EQ(dead_proxy.service().connect_failures(), 1);
+}
+// NOLINTEND